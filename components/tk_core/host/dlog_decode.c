@@ -0,0 +1,33 @@
+// dlog_decode: turns the "#dlog" lines of a console capture (CONFIG_TK_DLOG_HOST_DECODE)
+// back into the text the dlog task would have printed; every other line passes through.
+//   idf.py monitor | build-host/dlog_decode
+//   dlog_decode < capture.log
+#include <stdio.h>
+#include <string.h>
+#include "dlog_fmt.h"
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        fprintf(stderr, "usage: %s < capture\n", argv[0]);
+        return 2;
+    }
+    char line[512];
+    dlog_line_t d;
+    unsigned long bad = 0;
+    while (fgets(line, sizeof(line), stdin)) {
+        // the monitor may have put other output (a status line's \r) before the record
+        char *rec = strstr(line, "#dlog ");
+        if (!rec) { fputs(line, stdout); fflush(stdout); continue; }
+        fwrite(line, 1, (size_t)(rec - line), stdout);
+        if (dlog_decode(rec, &d)) {
+            dlog_print(stdout, d.id, d.ts_ms, d.arg, d.nargs);
+        } else {
+            fputs(rec, stdout);
+            bad++;
+        }
+        fflush(stdout);
+    }
+    if (bad) fprintf(stderr, "dlog_decode: %lu malformed records passed through\n", bad);
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "tk_fake.h"
+#include <string.h>
+#include "tk_civil.h"
+
+void tk_fake_rtc_init(tk_fake_rtc_t *r, const int64_t *clock, uint32_t resync_sec)
+{
+    memset(r, 0, sizeof(*r));
+    r->clock      = clock;
+    r->resync_sec = resync_sec;
+}
+
+static int64_t local_day(int64_t epoch)
+{
+    return (epoch + TK_CIVIL_IST_OFFSET) / TK_CIVIL_SEC_PER_DAY;
+}
+
+static bool read_registers(tk_fake_rtc_t *r, int64_t *epoch)
+{
+    r->i2c_xfers++;
+    if (r->fail_reads) {
+        r->fail_reads--;
+        r->failures++;
+        return false;
+    }
+    r->synced     = true;
+    r->sync_clock = *r->clock;
+    r->sync_epoch = *r->clock + r->offset;
+    *epoch = r->sync_epoch;
+    return true;
+}
+
+static bool rtc_read(void *ctx, int64_t *epoch)
+{
+    tk_fake_rtc_t *r = ctx;
+    if (r->resync_sec == 0 || !r->synced) return read_registers(r, epoch);
+
+    // SQW: the edge count since the last read, registers only when due
+    int64_t since = *r->clock - r->sync_clock;
+    int64_t edge  = r->sync_epoch + since;
+    if (since >= r->resync_sec || local_day(edge) != local_day(r->sync_epoch)) {
+        return read_registers(r, epoch);
+    }
+    *epoch = edge;
+    return true;
+}
+
+int64_t tk_fake_rtc_quiet(const tk_fake_rtc_t *r, int64_t last)
+{
+    if (r->resync_sec == 0) return (r->fail_reads || *r->clock + r->offset != last) ? 0 : INT64_MAX;
+    if (!r->synced) return 0;
+    // edges up to the read before the next register read (resync or the day change): that
+    // one may fail or jump, and the tick before it must not be one that was skipped
+    int64_t edge = r->sync_epoch + (*r->clock - r->sync_clock);
+    if (edge != last) return 0;
+    int64_t q    = r->sync_clock + r->resync_sec - 2 - *r->clock;
+    int64_t day  = (local_day(r->sync_epoch) + 1) * TK_CIVIL_SEC_PER_DAY - TK_CIVIL_IST_OFFSET - 2 - edge;
+    if (day < q) q = day;
+    return q > 0 ? q : 0;
+}
+
+void tk_fake_rtc_skip(tk_fake_rtc_t *r, int64_t n)
+{
+    if (r->resync_sec != 0 || n <= 0) return;           // SQW: just edges
+    r->i2c_xfers += (uint32_t)n;
+    r->synced     = true;
+    r->sync_clock = *r->clock;
+    r->sync_epoch = *r->clock + r->offset;
+}
+
+tk_rtc_ops_t tk_fake_rtc_ops(tk_fake_rtc_t *r)
+{
+    return (tk_rtc_ops_t){ .read = rtc_read, .ctx = r };
+}
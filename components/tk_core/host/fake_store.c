@@ -0,0 +1,57 @@
+#include "tk_fake.h"
+#include <string.h>
+
+void tk_fake_store_init(tk_fake_store_t *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+static void save_state(void *ctx, uint32_t user, const tk_state_t *st)
+{
+    tk_fake_store_t *s = ctx;
+    if (user >= TK_USERS_MAX) return;
+    tk_state_t *d = &s->st[user];
+    d->day_key   = st->day_key;
+    d->remaining = st->remaining;
+    d->started   = st->started;
+    d->paused    = st->paused;
+    s->state_writes++;
+}
+
+static void save_mac(void *ctx, uint32_t user, uint32_t n_users, const tk_state_t *st)
+{
+    tk_fake_store_t *s = ctx;
+    if (user >= TK_USERS_MAX) return;
+    s->st[user].have_mac = st->have_mac;
+    memcpy(s->st[user].mac, st->mac, 6);
+    s->st[user].last_in = st->last_in;
+    s->n = n_users;
+    s->mac_writes++;
+}
+
+static uint32_t count(void *ctx)
+{
+    return ((tk_fake_store_t *)ctx)->n;
+}
+
+static bool load(void *ctx, uint32_t user, tk_state_t *st)
+{
+    tk_fake_store_t *s = ctx;
+    if (user >= s->n) return false;
+    const tk_state_t *d = &s->st[user];
+    st->day_key   = d->day_key;
+    st->remaining = d->remaining;
+    st->started   = d->started;
+    st->paused    = d->paused;
+    st->have_mac  = d->have_mac;
+    memcpy(st->mac, d->mac, 6);
+    st->last_in   = d->last_in;
+    return true;
+}
+
+tk_store_ops_t tk_fake_store_ops(tk_fake_store_t *s)
+{
+    return (tk_store_ops_t){
+        .save_state = save_state, .save_mac = save_mac, .count = count, .load = load, .ctx = s,
+    };
+}
@@ -0,0 +1,60 @@
+#include "tk_fake.h"
+#include <string.h>
+
+static const uint8_t DIGIT[10] = {
+    0x3F,0x06,0x5B,0x4F,0x66,0x6D,0x7D,0x07,0x7F,0x6F
+};
+
+void tk_fake_display_init(tk_fake_display_t *d)
+{
+    memset(d, 0, sizeof(*d));
+}
+
+static void show(void *ctx, uint8_t hh, uint8_t mm, bool colon)
+{
+    tk_fake_display_t *d = ctx;
+    d->frames++;
+    d->hh = hh; d->mm = mm; d->colon = colon;
+
+    // tm1637_frame_hhmm()
+    uint8_t next[4] = {
+        (hh >= 10) ? DIGIT[hh / 10] : 0x00, DIGIT[hh % 10], DIGIT[mm / 10], DIGIT[mm % 10]
+    };
+    if (colon) next[1] |= 0x80;
+
+    // show4(): bus traffic for the dirty digits only
+    uint8_t dirty = 0;
+    for (int i = 0; i < 4; i++) {
+        if (!d->shadow_valid || next[i] != d->shadow[i]) dirty |= (uint8_t)(1u << i);
+    }
+    if (!dirty) {
+        d->frames_skipped++;
+        return;
+    }
+    if ((dirty & (dirty - 1)) == 0) {
+        d->bytes += 1 + 2;                               // data cmd, address + digit
+    } else {
+        int first = __builtin_ctz(dirty);
+        int last  = 31 - __builtin_clz(dirty);
+        d->bytes += 1 + 1 + (uint32_t)(last - first + 1);
+    }
+    memcpy(d->shadow, next, sizeof(d->shadow));
+    d->shadow_valid = true;
+    d->frames_sent++;
+}
+
+void tk_fake_display_blink(tk_fake_display_t *d, uint32_t n)
+{
+    d->frames      += n;
+    d->frames_sent += n;
+    d->bytes       += 3 * n;                             // data cmd, address + digit 1
+    if (n & 1) {
+        d->colon = !d->colon;
+        d->shadow[1] ^= 0x80;
+    }
+}
+
+tk_display_ops_t tk_fake_display_ops(tk_fake_display_t *d)
+{
+    return (tk_display_ops_t){ .show = show, .ctx = d };
+}
@@ -0,0 +1,49 @@
+#include "tk_fake.h"
+#include <string.h>
+
+void tk_fake_wifi_init(tk_fake_wifi_t *w, const int64_t *clock)
+{
+    memset(w, 0, sizeof(*w));
+    w->clock = clock;
+}
+
+bool tk_fake_wifi_push(tk_fake_wifi_t *w, int64_t at, tk_radio_ev_type_t type, const uint8_t mac[6])
+{
+    if (w->tail - w->head >= TK_FAKE_WIFI_DEPTH) return false;
+    tk_fake_wifi_item_t *it = &w->q[w->tail++ % TK_FAKE_WIFI_DEPTH];
+    it->at      = at;
+    it->ev.type = type;
+    memcpy(it->ev.mac, mac, 6);
+    return true;
+}
+
+bool tk_fake_wifi_next(const tk_fake_wifi_t *w, int64_t *at)
+{
+    if (w->head == w->tail) return false;
+    *at = w->q[w->head % TK_FAKE_WIFI_DEPTH].at;
+    return true;
+}
+
+static bool poll(void *ctx, int64_t now, tk_radio_ev_t *ev)
+{
+    tk_fake_wifi_t *w = ctx;
+    if (w->head == w->tail) return false;
+    const tk_fake_wifi_item_t *it = &w->q[w->head % TK_FAKE_WIFI_DEPTH];
+    if (it->at > (w->clock ? *w->clock : now)) return false;
+    *ev = it->ev;
+    w->head++;
+    w->delivered++;
+    return true;
+}
+
+static void deauth(void *ctx, const uint8_t mac[6])
+{
+    tk_fake_wifi_t *w = ctx;
+    w->deauths++;
+    memcpy(w->last_deauth, mac, 6);
+}
+
+tk_radio_ops_t tk_fake_wifi_ops(tk_fake_wifi_t *w)
+{
+    return (tk_radio_ops_t){ .poll = poll, .deauth = deauth, .ctx = w };
+}
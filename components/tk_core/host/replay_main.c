@@ -0,0 +1,59 @@
+// tk_replay: accelerated replay of the unit's decision path on the host fakes
+//   tk_replay [-d days] [-s seed] [-r rtc_resync_sec] [-u users] [-e] [-v]
+// -r 0 polls the RTC every tick (no SQW wired), -r 3600 is SQW mode with hourly resyncs;
+// -u sets the number of phones; -e passes through every simulated second instead of
+// skipping quiet ones (same output, for checking that); -v prints one line per day.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tk_replay.h"
+
+static tk_sim_t s_sim;
+
+static void print_day(const tk_replay_day_t *d, void *ctx)
+{
+    (void)ctx;
+    printf("%08u nvs %3u frames %5u (bus %5u) i2c %5u checkin %2u done %2u%s%s%s\n", (unsigned)d->day_key,
+           (unsigned)d->nvs_writes, (unsigned)d->frames, (unsigned)d->frames_sent, (unsigned)d->i2c_xfers,
+           (unsigned)d->checked_in, (unsigned)d->done, d->rebooted ? " reboot" : "",
+           d->rtc_fail ? " rtc-fail" : "", d->jumped ? " jump" : "");
+}
+
+int main(int argc, char **argv)
+{
+    tk_replay_config_t c;
+    tk_replay_default_config(&c);
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if      (!strcmp(a, "-d") && v) { c.days = (uint32_t)strtoul(v, NULL, 0); i++; }
+        else if (!strcmp(a, "-s") && v) { c.seed = (uint32_t)strtoul(v, NULL, 0); i++; }
+        else if (!strcmp(a, "-r") && v) { c.rtc_resync_sec = (uint32_t)strtoul(v, NULL, 0); i++; }
+        else if (!strcmp(a, "-u") && v) { c.users = (uint8_t)strtoul(v, NULL, 0); i++; }
+        else if (!strcmp(a, "-e"))      { c.every_second = true; }
+        else if (!strcmp(a, "-v"))      { verbose = true; }
+        else {
+            fprintf(stderr, "usage: %s [-d days] [-s seed] [-r rtc_resync_sec] [-u users] [-e] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    tk_replay_report_t r;
+    bool ok = tk_replay_run(&s_sim, &c, &r, verbose ? print_day : NULL, NULL);
+    if (!r.days) return ok ? 0 : 1;
+
+    printf("%u days in %.3f s: %.0f simulated days/s, %.1f ns per simulated second; %llu ticks, %llu quiet seconds skipped\n",
+           (unsigned)r.days, r.wall_sec, r.days_per_sec, r.wall_sec * 1e9 / ((double)r.days * 86400),
+           (unsigned long long)r.ticks, (unsigned long long)r.skipped);
+    printf("scenario: %u phones, %u check-ins (%u reached the target), %u reboots, %u RTC failure bursts, "
+           "%u clock jumps\n", (unsigned)r.users, (unsigned)r.checkins, (unsigned)r.done,
+           (unsigned)r.reboots, (unsigned)r.rtc_fail_days, (unsigned)r.jumps);
+    printf("per day (avg/max): nvs writes %.1f/%u, display frames %.0f/%u (bus %.0f/%u), i2c %.1f/%u\n",
+           (double)r.total.nvs_writes / r.days, (unsigned)r.max.nvs_writes,
+           (double)r.total.frames / r.days, (unsigned)r.max.frames,
+           (double)r.total.frames_sent / r.days, (unsigned)r.max.frames_sent,
+           (double)r.total.i2c_xfers / r.days, (unsigned)r.max.i2c_xfers);
+    printf("invariants: %s (%u violations)\n", ok ? "ok" : "FAILED", (unsigned)r.violations);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#pragma once
+// Host fakes behind tk_hal: a DS3231 on a simulated clock, a TM1637 that keeps the
+// driver's shadow registers, an in-memory state store and a scripted SoftAP. Each one
+// counts the traffic its real counterpart would cause (I2C transactions, display bus
+// frames/bytes, flash writes) so the simulator can report the cost per simulated day.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tk_hal.h"
+#include "tk_users.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ---- DS3231 ----
+// resync_sec 0: the registers are read on every tick (poll mode, one I2C transaction each).
+// Otherwise SQW mode: ticks advance from the 1 Hz edge and the registers are read only
+// when a resync is due or the day changes, so an RTC error shows up at the next resync.
+typedef struct {
+    const int64_t *clock;        // true time (UTC epoch), owned by the simulator
+    int64_t  offset;             // RTC error in seconds; change it to inject a clock jump
+    uint32_t fail_reads;         // that many upcoming register reads fail
+    uint32_t resync_sec;
+    bool     synced;
+    int64_t  sync_clock;         // *clock at the last good register read
+    int64_t  sync_epoch;         // what the registers said then
+    uint32_t i2c_xfers;          // register reads attempted (one burst transaction each)
+    uint32_t failures;
+} tk_fake_rtc_t;
+
+void tk_fake_rtc_init(tk_fake_rtc_t *r, const int64_t *clock, uint32_t resync_sec);
+tk_rtc_ops_t tk_fake_rtc_ops(tk_fake_rtc_t *r);
+
+// Skipping quiet seconds (tk_sim): how many reads after *clock are sure to succeed and
+// report last + 1, last + 2, ... (0 when a failure or a jump is pending; SQW: until a
+// register read is due), and the traffic of n of them once *clock has moved past them
+int64_t tk_fake_rtc_quiet(const tk_fake_rtc_t *r, int64_t last);
+void tk_fake_rtc_skip(tk_fake_rtc_t *r, int64_t n);
+
+// ---- TM1637 ----
+// Same shadow as tm1637.c: unchanged frames are skipped, one changed digit is a
+// fixed-address write, several are one auto-increment write over the dirty span.
+typedef struct {
+    uint8_t  shadow[4];
+    bool     shadow_valid;
+    uint8_t  hh, mm;             // last frame shown
+    bool     colon;
+    uint32_t frames;             // show() calls
+    uint32_t frames_sent;        // bus frames written
+    uint32_t frames_skipped;
+    uint32_t bytes;              // bus bytes written
+} tk_fake_display_t;
+
+void tk_fake_display_init(tk_fake_display_t *d);
+tk_display_ops_t tk_fake_display_ops(tk_fake_display_t *d);
+
+// n more frames of the HH:MM shown, one a second: only the colon changes, so each is a
+// one-digit write. Needs a frame on the display.
+void tk_fake_display_blink(tk_fake_display_t *d, uint32_t n);
+
+// ---- State store ----
+// Survives tk_sim_reboot(); holds exactly the fields the journal/NVS records carry.
+typedef struct {
+    tk_state_t st[TK_USERS_MAX];
+    uint32_t   n;                // enrolled users (written with the MAC)
+    uint32_t   state_writes;     // journal appends (NVS commits without a journal)
+    uint32_t   mac_writes;       // NVS commits
+} tk_fake_store_t;
+
+void tk_fake_store_init(tk_fake_store_t *s);
+tk_store_ops_t tk_fake_store_ops(tk_fake_store_t *s);
+
+// ---- SoftAP ----
+// Events are queued in time order and delivered by the first poll at or after their
+// time: the simulator's true time when a clock is given (the phone walks in at 09:00
+// whatever the RTC says), else the loop's RTC time
+#define TK_FAKE_WIFI_DEPTH 4096
+
+typedef struct {
+    int64_t       at;
+    tk_radio_ev_t ev;
+} tk_fake_wifi_item_t;
+
+typedef struct {
+    const int64_t *clock;        // may be NULL
+    tk_fake_wifi_item_t q[TK_FAKE_WIFI_DEPTH];
+    uint32_t head, tail;
+    uint32_t delivered;
+    uint32_t deauths;
+    uint8_t  last_deauth[6];
+} tk_fake_wifi_t;
+
+void tk_fake_wifi_init(tk_fake_wifi_t *w, const int64_t *clock);
+tk_radio_ops_t tk_fake_wifi_ops(tk_fake_wifi_t *w);
+
+// Queue an event for time `at`; false when the queue is full
+bool tk_fake_wifi_push(tk_fake_wifi_t *w, int64_t at, tk_radio_ev_type_t type, const uint8_t mac[6]);
+
+// Time of the next queued event; false when the queue is empty
+bool tk_fake_wifi_next(const tk_fake_wifi_t *w, int64_t *at);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+// Hardware seams of the simulated unit (tk_sim): RTC, display, state store and Wi-Fi,
+// each a table of callbacks plus a context pointer. The fakes in this directory back
+// them and count their bus and flash traffic; on the unit, main/main.c does the same I/O
+// directly around the same tk_app calls.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tk_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tick source: local time as an epoch (IST wall clock, like the DS3231 registers).
+// false = read failed; the loop shows the RTC error frame and skips the tick.
+typedef struct {
+    bool (*read)(void *ctx, int64_t *epoch);
+    void *ctx;
+} tk_rtc_ops_t;
+
+// One HH:MM frame (the colon blinks once a second)
+typedef struct {
+    void (*show)(void *ctx, uint8_t hh, uint8_t mm, bool colon);
+    void *ctx;
+} tk_display_ops_t;
+
+// Per-user countdown state; enrollment writes (MAC, last check-in day) are separate
+// because they happen at most once a day. load() fills only what was persisted (day,
+// remaining, started, paused, MAC, last check-in).
+typedef struct {
+    void     (*save_state)(void *ctx, uint32_t user, const tk_state_t *st);
+    void     (*save_mac)(void *ctx, uint32_t user, uint32_t n_users, const tk_state_t *st);
+    uint32_t (*count)(void *ctx);                      // enrolled users persisted
+    bool     (*load)(void *ctx, uint32_t user, tk_state_t *st);
+    void *ctx;
+} tk_store_ops_t;
+
+typedef enum {
+    TK_RADIO_CONNECT = 1,        // station associated
+    TK_RADIO_DISCONNECT,         // station left
+    TK_RADIO_SEEN,               // frame sniffed from a station (no association)
+    TK_RADIO_NEAR,               // smoothed RSSI crossed the enter threshold
+    TK_RADIO_FAR,                // ... the leave threshold, or went stale
+} tk_radio_ev_type_t;
+
+typedef struct {
+    tk_radio_ev_type_t type;
+    uint8_t            mac[6];
+} tk_radio_ev_t;
+
+// Station events due at or before `now`, one per call (false: none left), and the
+// deauth of a station after its check-in connect
+typedef struct {
+    bool (*poll)(void *ctx, int64_t now, tk_radio_ev_t *ev);
+    void (*deauth)(void *ctx, const uint8_t mac[6]);
+    void *ctx;
+} tk_radio_ops_t;
+
+typedef struct {
+    tk_rtc_ops_t     rtc;
+    tk_display_ops_t display;
+    tk_store_ops_t   store;
+    tk_radio_ops_t   radio;
+} tk_hal_t;
+
+#ifdef __cplusplus
+}
+#endif
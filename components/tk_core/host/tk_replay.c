@@ -0,0 +1,289 @@
+#include "tk_replay.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tk_civil.h"
+
+#define REPLAY_TARGET   (9 * 3600 + 15 * 60)
+#define REPLAY_SAVE_SEC 900
+#define SEEN_EVERY      840          // sniffed sightings while on site, inside the grace window
+#define LUNCH_SEC       3600         // long enough to pause
+#define NEAR_SETTLE     3            // RSSI samples a fresh filter needs before it reports near
+
+static const tk_config_t REPLAY_CFG = {
+    .daily_target_sec   = REPLAY_TARGET,
+    .max_tick_delta_sec = 60,
+    .relearn_mac_daily  = true,
+    .deauth             = TK_DEAUTH_FIRST_CONNECT,
+    .away_grace_sec     = 900,
+};
+
+// Phone p: locally administered MAC ending in p
+static void phone_mac(uint32_t p, uint8_t mac[6])
+{
+    const uint8_t base[6] = { 0x02, 0x11, 0x22, 0x33, 0x44, 0x00 };
+    memcpy(mac, base, 6);
+    mac[5] = (uint8_t)p;
+}
+
+void tk_replay_default_config(tk_replay_config_t *c)
+{
+    *c = (tk_replay_config_t){
+        .days         = 365,
+        .seed         = 1,
+        .start        = (int64_t)tk_days_from_civil(2024, 1, 1) * TK_CIVIL_SEC_PER_DAY - TK_CIVIL_IST_OFFSET,
+        .users        = 1,
+        .checkin_pct  = 85,
+        .near_pct     = 25,
+        .reboot_pct   = 10,
+        .rtc_fail_pct = 5,
+        .jump_pct     = 5,
+    };
+}
+
+// xorshift32: the same script for the same seed on every host
+static uint32_t rnd(uint32_t *s)
+{
+    uint32_t x = *s;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return *s = x;
+}
+
+static uint32_t pick(uint32_t *s, uint32_t lo, uint32_t hi)
+{
+    return lo + rnd(s) % (hi - lo + 1);
+}
+
+static bool chance(uint32_t *s, uint8_t pct)
+{
+    return rnd(s) % 100 < pct;
+}
+
+typedef enum { ACT_REBOOT, ACT_RTC_FAIL, ACT_JUMP, ACT_UNJUMP } act_kind_t;
+
+typedef struct {
+    int64_t    at;
+    act_kind_t kind;
+    int64_t    arg;
+} act_t;
+
+static void counters(const tk_sim_t *s, tk_replay_day_t *d)
+{
+    d->nvs_writes  = s->store.state_writes + s->store.mac_writes;
+    d->frames      = s->disp.frames;
+    d->frames_sent = s->disp.frames_sent;
+    d->i2c_xfers   = s->rtc.i2c_xfers;
+}
+
+static void add_day(tk_replay_report_t *r, const tk_replay_day_t *d)
+{
+#define ACC(f) do { r->total.f += d->f; if (d->f > r->max.f) r->max.f = d->f; } while (0)
+    ACC(nvs_writes); ACC(frames); ACC(frames_sent); ACC(i2c_xfers);
+#undef ACC
+    r->checkins      += d->checked_in;
+    r->done          += d->done;
+    r->reboots       += d->rebooted;
+    r->rtc_fail_days += d->rtc_fail;
+    r->jumps         += d->jumped;
+}
+
+// One day's station events of all phones, sorted by time before they are queued
+typedef struct {
+    int64_t            at;
+    uint32_t           seq;      // keeps each phone's own order on equal times
+    tk_radio_ev_type_t type;
+    uint8_t            phone;
+} plan_ev_t;
+
+typedef struct {
+    plan_ev_t ev[TK_FAKE_WIFI_DEPTH];
+    uint32_t  n;
+    uint64_t  enrolled;          // phones that associated on an earlier day (bit p)
+    uint64_t  today;             // phones checking in today
+} plan_t;
+
+static plan_t s_plan;            // too big for the stack
+
+static void plan_ev(plan_t *p, int64_t at, tk_radio_ev_type_t type, uint32_t phone, uint32_t *lost)
+{
+    if (p->n == TK_FAKE_WIFI_DEPTH) { (*lost)++; return; }
+    p->ev[p->n] = (plan_ev_t){ at, p->n, type, (uint8_t)phone };
+    p->n++;
+}
+
+static int plan_cmp(const void *a, const void *b)
+{
+    const plan_ev_t *x = a, *y = b;
+    if (x->at != y->at) return x->at < y->at ? -1 : 1;
+    return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+// A phone's day on site: in at arrive, out for lunch (long enough to pause), gone at leave.
+// Associating, it is deauthed at once and then only sniffed; by signal alone the filter
+// reports it near/far and it stays in range in between. A reboot (at `reboot`, 0 = none)
+// empties the filter: a phone in range is reported near again once it has its samples.
+static void plan_phone(plan_t *p, const tk_replay_config_t *c, uint32_t *rng, int64_t day0, uint32_t phone,
+                       int64_t reboot, uint32_t *lost)
+{
+    int64_t arrive = day0 + 8 * 3600 + 1800 + pick(rng, 0, 5400);
+    int64_t lunch  = day0 + 13 * 3600 + pick(rng, 0, 1800);
+    int64_t leave  = arrive + LUNCH_SEC + REPLAY_TARGET + 1800 + pick(rng, 0, 3600);
+    if ((p->enrolled >> phone & 1) && chance(rng, c->near_pct)) {
+        int64_t again = reboot + NEAR_SETTLE;
+        plan_ev(p, arrive, TK_RADIO_NEAR, phone, lost);
+        plan_ev(p, lunch, TK_RADIO_FAR, phone, lost);
+        plan_ev(p, lunch + LUNCH_SEC, TK_RADIO_NEAR, phone, lost);
+        plan_ev(p, leave, TK_RADIO_FAR, phone, lost);
+        if ((reboot >= arrive && again < lunch) || (reboot >= lunch + LUNCH_SEC && again < leave)) {
+            plan_ev(p, again, TK_RADIO_NEAR, phone, lost);
+        }
+        return;
+    }
+    plan_ev(p, arrive, TK_RADIO_CONNECT, phone, lost);
+    plan_ev(p, arrive + 4, TK_RADIO_DISCONNECT, phone, lost);         // the deauth
+    for (int64_t t = arrive + SEEN_EVERY; t < leave; t += SEEN_EVERY) {
+        if (t >= lunch && t < lunch + LUNCH_SEC) continue;
+        plan_ev(p, t, TK_RADIO_SEEN, phone, lost);
+    }
+    p->enrolled |= 1ull << phone;
+}
+
+// Script one day: phone events go to the fake SoftAP, faults into acts[] in time order
+static int plan_day(tk_sim_t *s, const tk_replay_config_t *c, uint32_t *rng, int64_t day0,
+                    act_t *acts, tk_replay_day_t *d, uint32_t *lost)
+{
+    int n = 0;
+    int64_t reboot = 0;
+    if (chance(rng, c->reboot_pct)) {
+        reboot = day0 + pick(rng, 6 * 3600, 22 * 3600);
+        acts[n++] = (act_t){ reboot, ACT_REBOOT, 0 };
+        d->rebooted = true;
+    }
+    if (chance(rng, c->rtc_fail_pct)) {
+        acts[n++] = (act_t){ day0 + pick(rng, 6 * 3600, 22 * 3600), ACT_RTC_FAIL, pick(rng, 1, 900) };
+        d->rtc_fail = true;
+    }
+    if (chance(rng, c->jump_pct)) {
+        int64_t at   = day0 + pick(rng, 7 * 3600, 20 * 3600);
+        int64_t by   = pick(rng, 61, 7200);
+        acts[n++] = (act_t){ at, ACT_JUMP, (rnd(rng) & 1) ? by : -by };
+        acts[n++] = (act_t){ at + pick(rng, 60, 1800), ACT_UNJUMP, 0 };
+        d->jumped = true;
+    }
+
+    plan_t *p = &s_plan;
+    p->n     = 0;
+    p->today = 0;
+    for (uint32_t ph = 0; ph < c->users; ph++) {
+        if (!chance(rng, c->checkin_pct)) continue;
+        plan_phone(p, c, rng, day0, ph, reboot, lost);
+        p->today |= 1ull << ph;
+        d->checked_in++;
+    }
+    qsort(p->ev, p->n, sizeof(p->ev[0]), plan_cmp);
+    for (uint32_t i = 0; i < p->n; i++) {
+        uint8_t mac[6];
+        phone_mac(p->ev[i].phone, mac);
+        if (!tk_fake_wifi_push(&s->wifi, p->ev[i].at, p->ev[i].type, mac)) (*lost)++;
+    }
+
+    // insertion sort, at most four entries
+    for (int i = 1; i < n; i++) {
+        for (int j = i; j > 0 && acts[j].at < acts[j - 1].at; j--) {
+            act_t t = acts[j]; acts[j] = acts[j - 1]; acts[j - 1] = t;
+        }
+    }
+    return n;
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+bool tk_replay_run(tk_sim_t *sim, const tk_replay_config_t *c, tk_replay_report_t *r,
+                   tk_replay_day_cb_t cb, void *ctx)
+{
+    memset(r, 0, sizeof(*r));
+    uint32_t rng = c->seed ? c->seed : 1;
+    uint32_t users = c->users < 1 ? 1 : c->users > TK_USERS_MAX ? TK_USERS_MAX : c->users;
+    tk_sim_init(sim, &REPLAY_CFG, users, REPLAY_SAVE_SEC, c->start, c->rtc_resync_sec);
+    sim->every_second = c->every_second;
+    s_plan.enrolled   = 0;
+    double t0 = now_sec();
+
+#define VIOLATION(cond) do { if (!(cond)) r->violations++; } while (0)
+
+    tk_replay_day_t base = {0};
+    counters(sim, &base);
+    for (uint32_t day = 0; day < c->days; day++) {
+        int64_t day0 = c->start + (int64_t)day * TK_CIVIL_SEC_PER_DAY;
+        struct tm lt;
+        tk_civil_from_epoch(day0, TK_CIVIL_IST_OFFSET, &lt);
+        tk_replay_day_t d = { .day_key = tk_day_key_from_tm(&lt) };
+        act_t acts[4];
+        uint32_t lost = 0;                         // events that did not fit the queue
+        int n = plan_day(sim, c, &rng, day0, acts, &d, &lost);
+        VIOLATION(lost == 0);
+
+        for (int i = 0; i < n; i++) {
+            tk_sim_run_until(sim, acts[i].at);
+            switch (acts[i].kind) {
+            case ACT_REBOOT:   r->ticks += sim->app.stats.ticks; tk_sim_reboot(sim); break;
+            case ACT_RTC_FAIL: sim->rtc.fail_reads = (uint32_t)acts[i].arg; break;
+            case ACT_JUMP:     sim->rtc.offset = acts[i].arg;               break;
+            case ACT_UNJUMP:   sim->rtc.offset = 0;                         break;
+            }
+        }
+
+        // Last second of the day: every phone's state belongs to today and is self-consistent
+        tk_sim_run_until(sim, day0 + TK_CIVIL_SEC_PER_DAY - 1);
+        for (uint32_t ph = 0; ph < users; ph++) {
+            uint8_t mac[6];
+            phone_mac(ph, mac);
+            bool in = (s_plan.today >> ph) & 1;
+            int u = tk_users_find(&sim->app.users, mac);
+            VIOLATION(u >= 0 || !(s_plan.enrolled >> ph & 1));
+            if (u < 0) continue;
+            const tk_state_t *st = &sim->app.users.user[u];
+            int32_t want = st->worked >= REPLAY_TARGET ? 0 : REPLAY_TARGET - st->worked;
+            VIOLATION(st->day_key == d.day_key);
+            VIOLATION(st->remaining == want);
+            VIOLATION(st->worked >= 0 && st->worked <= TK_CIVIL_SEC_PER_DAY);
+            VIOLATION(st->started == in);
+            bool done = (tk_core_phase(st) == TK_DONE);
+            d.done += done;
+            // a plain day (no reboot/fault) with enough time on site always reaches the target
+            if (in && !d.rebooted && !d.rtc_fail && !d.jumped) VIOLATION(done);
+        }
+
+        tk_replay_day_t now;
+        counters(sim, &now);
+        tk_replay_day_t cost = d;
+        cost.nvs_writes  = now.nvs_writes  - base.nvs_writes;
+        cost.frames      = now.frames      - base.frames;
+        cost.frames_sent = now.frames_sent - base.frames_sent;
+        cost.i2c_xfers   = now.i2c_xfers   - base.i2c_xfers;
+        base = now;
+        add_day(r, &cost);
+        if (cb) cb(&cost, ctx);
+
+        // first second of the next day: reset for the new day
+        tk_sim_run(sim, 1);
+        for (uint32_t u = 0; u < sim->app.users.n && !sim->rtc.fail_reads; u++) {
+            const tk_state_t *st = &sim->app.users.user[u];
+            VIOLATION(!st->started && st->remaining == REPLAY_TARGET && st->worked == 0);
+        }
+    }
+#undef VIOLATION
+
+    r->days         = c->days;
+    r->users        = users;
+    r->wall_sec     = now_sec() - t0;
+    r->days_per_sec = r->wall_sec > 0 ? r->days / r->wall_sec : 0;
+    r->ticks       += sim->app.stats.ticks;
+    r->skipped      = sim->skipped;
+    return r->violations == 0;
+}
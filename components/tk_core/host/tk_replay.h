@@ -0,0 +1,70 @@
+#pragma once
+// Accelerated replay: a tk_sim unit lives through `days` scripted days on the decision
+// path the firmware runs (tk_app), a loop pass per simulated second with quiet stretches
+// skipped. Each day every phone may check in, either by associating (deauth, sniffed
+// sightings) or, once enrolled, by signal alone (RSSI near/far), and takes a lunch break
+// long enough to pause; the unit may reboot mid-day, the RTC may fail a burst of reads
+// or jump past the tick clamp, and every day ends at midnight IST. Reports the cost of
+// each day (flash writes, display frames, I2C transactions), the state machine
+// invariants checked for every phone at each rollover, and throughput in days per second.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tk_sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t days;
+    uint32_t seed;
+    int64_t  start;              // epoch of the first local midnight
+    uint32_t rtc_resync_sec;     // 0 = poll the RTC every tick, else SQW mode
+    uint8_t  users;              // phones, 1..TK_USERS_MAX (the table holds all of them)
+    uint8_t  checkin_pct;        // chance per day that a phone shows up
+    uint8_t  near_pct;           // ... that an enrolled phone comes by signal, not associating
+    uint8_t  reboot_pct;         // ... of a reboot during the day
+    uint8_t  rtc_fail_pct;       // ... of a burst of failed RTC reads
+    uint8_t  jump_pct;           // ... of an RTC jump beyond the tick clamp (undone later)
+    bool     every_second;       // no skipping of quiet seconds (tk_sim); same results, slower
+} tk_replay_config_t;
+
+// What one simulated day cost
+typedef struct {
+    uint32_t day_key;
+    uint8_t  checked_in, done;   // phones that checked in / reached the target
+    uint32_t nvs_writes;         // state saves + MAC saves
+    uint32_t frames;             // frames handed to the display
+    uint32_t frames_sent;        // of which reached the bus
+    uint32_t i2c_xfers;
+    bool     rebooted, rtc_fail, jumped;
+} tk_replay_day_t;
+
+typedef struct {
+    uint32_t        days;
+    uint32_t        users;
+    double          wall_sec;
+    double          days_per_sec;
+    uint64_t        ticks;       // loop passes that ticked
+    uint64_t        skipped;     // quiet seconds skipped
+    tk_replay_day_t total;       // sums (flags unused)
+    tk_replay_day_t max;         // per-day maxima
+    uint32_t        checkins, done;            // phone-days
+    uint32_t        reboots, rtc_fail_days, jumps;
+    uint32_t        violations;  // invariant checks that failed
+} tk_replay_report_t;
+
+// Called after each simulated day (may be NULL)
+typedef void (*tk_replay_day_cb_t)(const tk_replay_day_t *day, void *ctx);
+
+// Defaults: 09:15 target, 60 s clamp, 15 min save interval, relearn + first-connect deauth
+void tk_replay_default_config(tk_replay_config_t *c);
+
+// Replays c->days days on `sim` (caller storage, it is large); false on any violation
+bool tk_replay_run(tk_sim_t *sim, const tk_replay_config_t *c, tk_replay_report_t *r,
+                   tk_replay_day_cb_t cb, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,192 @@
+#include "tk_sim.h"
+#include <string.h>
+#include "tk_civil.h"
+
+// Day key for epoch; the civil conversion runs only when epoch leaves the cached day
+static uint32_t day_of(tk_sim_t *s, int64_t epoch)
+{
+    if (epoch >= s->day_start && epoch < s->day_end) return s->app.today;
+    struct tm t;
+    tk_civil_from_epoch(epoch, TK_CIVIL_IST_OFFSET, &t);
+    s->day_start = epoch - tk_civil_sod(epoch, TK_CIVIL_IST_OFFSET);
+    s->day_end   = s->day_start + TK_CIVIL_SEC_PER_DAY;
+    return tk_day_key_from_tm(&t);
+}
+
+static void save_states(tk_sim_t *s, uint64_t mask)
+{
+    const tk_store_ops_t *st = &s->hal.store;
+    for (; mask; mask &= mask - 1) {
+        uint32_t u = (uint32_t)__builtin_ctzll(mask);
+        st->save_state(st->ctx, u, &s->app.users.user[u]);
+    }
+}
+
+static void save_macs(tk_sim_t *s, uint64_t mask)
+{
+    const tk_store_ops_t *st = &s->hal.store;
+    for (; mask; mask &= mask - 1) {
+        uint32_t u = (uint32_t)__builtin_ctzll(mask);
+        st->save_mac(st->ctx, u, s->app.users.n, &s->app.users.user[u]);
+    }
+}
+
+static void render(tk_sim_t *s, int64_t epoch)
+{
+    tk_state_t idle;
+    const tk_state_t *shown = tk_app_shown(s->app.users.user, s->app.users.n, s->app.focus, &s->cfg, &idle);
+    uint8_t hh, mm;
+    tk_core_hhmm(shown, &hh, &mm);
+    s->hal.display.show(s->hal.display.ctx, hh, mm, (epoch % 2) == 0);
+}
+
+// What the event asked for: enrollment record first, as the owner task does
+static void act(tk_sim_t *s, const tk_app_out_t *o, const uint8_t mac[6])
+{
+    if (o->user < 0) return;
+    if (o->save_mac)   save_macs(s, 1ull << o->user);
+    if (o->save_state) save_states(s, 1ull << o->user);
+    if (o->deauth)     s->hal.radio.deauth(s->hal.radio.ctx, mac);
+}
+
+// app_main's boot: restore, align to the RTC day, first frame
+static void boot(tk_sim_t *s)
+{
+    const tk_store_ops_t *st = &s->hal.store;
+    tk_app_init(&s->app, &s->cfg, s->users_max, s->save_sec);
+    uint32_t n = st->count(st->ctx);
+    if (n > s->app.users.max) n = s->app.users.max;
+    for (uint32_t u = 0; u < n; u++) {
+        tk_core_init(&s->app.users.user[u], &s->cfg);
+        (void)st->load(st->ctx, u, &s->app.users.user[u]);
+    }
+    s->app.users.n = n;
+
+    int64_t epoch = 0;
+    uint32_t today = 0;
+    s->day_start = s->day_end = 0;
+    s->ticked = false;
+    if (s->hal.rtc.read(s->hal.rtc.ctx, &epoch)) today = day_of(s, epoch);
+    else s->rtc_fail++;
+    uint64_t save_state, save_mac;
+    tk_app_start(&s->app, today, epoch, &save_state, &save_mac);
+    save_states(s, save_state);
+    save_macs(s, save_mac);
+    render(s, epoch);
+}
+
+// One pass of the owner task and main loop: RTC, station events, tick, persist, render
+static void step(tk_sim_t *s)
+{
+    const tk_hal_t *hal = &s->hal;
+    int64_t epoch;
+    s->ticked = false;
+    if (!hal->rtc.read(hal->rtc.ctx, &epoch)) {
+        s->rtc_fail++;
+        hal->display.show(hal->display.ctx, 0, 0, false);
+        return;
+    }
+
+    // Station events first, as the owner task drains its ring before the tick
+    tk_radio_ev_t ev;
+    tk_app_out_t out;
+    while (hal->radio.poll(hal->radio.ctx, epoch, &ev)) {
+        switch (ev.type) {
+        case TK_RADIO_CONNECT:    tk_app_connect(&s->app, ev.mac, epoch, &out);       break;
+        case TK_RADIO_SEEN:       tk_app_seen(&s->app, ev.mac, epoch, &out);          break;
+        case TK_RADIO_NEAR:
+        case TK_RADIO_FAR:        tk_app_link(&s->app, ev.mac, ev.type == TK_RADIO_NEAR, epoch, &out); break;
+        case TK_RADIO_DISCONNECT: (void)tk_app_disconnect(&s->app, ev.mac, epoch); continue;
+        default: continue;
+        }
+        act(s, &out, ev.mac);
+    }
+
+    tk_app_tick_t t;
+    tk_app_tick(&s->app, epoch, day_of(s, epoch), &t);
+    save_states(s, t.save_now | t.save_due);
+    render(s, epoch);
+    s->ticked = true;
+    s->epoch  = epoch;
+}
+
+// Seconds after now, at most `most`, the loop would pass through without a decision:
+// the last pass ticked, no station event falls due, the RTC just counts on, the day
+// holds and tk_app has nothing due. Anything else (event, register read, rollover) gets
+// a real pass the second before it, so its tick never covers skipped time.
+static int64_t quiet(const tk_sim_t *s, int64_t most)
+{
+    if (s->every_second || !s->ticked || most <= 0) return 0;
+    int64_t q = tk_app_quiet(&s->app, s->epoch);
+    if (most < q) q = most;
+    int64_t r = tk_fake_rtc_quiet(&s->rtc, s->epoch);
+    if (r < q) q = r;
+    if (s->day_end - 2 - s->epoch < q) q = s->day_end - 2 - s->epoch;
+    // the pass before an event ticks too: a check-in or resume counts from the tick before
+    int64_t at;
+    if (tk_fake_wifi_next(&s->wifi, &at)) {
+        int64_t w = at - 2 - (s->wifi.clock ? s->now : s->epoch);
+        if (w < q) q = w;
+    }
+    return q > 0 ? q : 0;
+}
+
+// Pass through n quiet seconds at once: the RTC and the display see their traffic, and
+// the next tick counts the time (tk_app_quiet keeps it under the tick clamp)
+static void skip(tk_sim_t *s, int64_t n)
+{
+    s->now   += n;
+    s->epoch += n;
+    tk_fake_rtc_skip(&s->rtc, n);
+    tk_fake_display_blink(&s->disp, (uint32_t)n);
+    s->skipped += (uint64_t)n;
+}
+
+void tk_sim_init(tk_sim_t *s, const tk_config_t *cfg, uint32_t users_max, int32_t save_sec,
+                 int64_t start, uint32_t rtc_resync_sec)
+{
+    memset(s, 0, sizeof(*s));
+    s->now       = start;
+    s->cfg       = *cfg;
+    s->users_max = users_max;
+    s->save_sec  = save_sec;
+    tk_config_resolve(&s->cfg);
+
+    tk_fake_rtc_init(&s->rtc, &s->now, rtc_resync_sec);
+    tk_fake_display_init(&s->disp);
+    tk_fake_store_init(&s->store);
+    tk_fake_wifi_init(&s->wifi, &s->now);
+    s->hal = (tk_hal_t){
+        .rtc     = tk_fake_rtc_ops(&s->rtc),
+        .display = tk_fake_display_ops(&s->disp),
+        .store   = tk_fake_store_ops(&s->store),
+        .radio   = tk_fake_wifi_ops(&s->wifi),
+    };
+    boot(s);
+}
+
+void tk_sim_reboot(tk_sim_t *s)
+{
+    // the display controller loses its registers with the power; the RTC keeps time
+    s->disp.shadow_valid = false;
+    s->rtc.synced        = false;
+    s->reboots++;
+    boot(s);
+}
+
+void tk_sim_run(tk_sim_t *s, int64_t seconds)
+{
+    int64_t end = s->now + seconds;
+    while (s->now < end) {
+        // the last second is always a pass, so the state at `end` is the loop's own
+        int64_t n = quiet(s, end - s->now - 1);
+        if (n) skip(s, n);
+        s->now++;
+        step(s);
+    }
+}
+
+void tk_sim_run_until(tk_sim_t *s, int64_t t)
+{
+    if (t > s->now) tk_sim_run(s, t - s->now);
+}
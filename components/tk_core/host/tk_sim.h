@@ -0,0 +1,50 @@
+#pragma once
+// Simulated unit: the firmware's boot, owner task and main loop reduced to their I/O on
+// the fakes, around the same tk_app calls, on a virtual clock that advances one second
+// per loop pass; reboots keep only what the store persisted. Quiet stretches (no station
+// event, RTC read, transition or new HH:MM due) are skipped in one go by default, with
+// the same outcome and fake traffic as passing through them second by second.
+
+#include "tk_app.h"
+#include "tk_fake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int64_t           now;       // true time (UTC epoch)
+    tk_config_t       cfg;
+    uint32_t          users_max;
+    int32_t           save_sec;
+    tk_fake_rtc_t     rtc;
+    tk_fake_display_t disp;
+    tk_fake_store_t   store;
+    tk_fake_wifi_t    wifi;
+    tk_hal_t          hal;
+    tk_app_t          app;
+    int64_t           day_start, day_end;     // epochs bounding app.today: the calendar runs at rollover only
+    uint32_t          rtc_fail;               // failed RTC reads (error frame shown, tick skipped)
+    uint32_t          reboots;
+    bool              every_second;           // no skipping: one loop pass per simulated second
+    bool              ticked;                 // the last pass read the RTC and ticked...
+    int64_t           epoch;                  // ... at this RTC time
+    uint64_t          skipped;                // quiet seconds skipped
+} tk_sim_t;
+
+// Power on at `start` with an empty store (rtc_resync_sec as for tk_fake_rtc_init)
+void tk_sim_init(tk_sim_t *s, const tk_config_t *cfg, uint32_t users_max, int32_t save_sec,
+                 int64_t start, uint32_t rtc_resync_sec);
+
+// Restart the loop from the store; the fakes and their counters carry on
+void tk_sim_reboot(tk_sim_t *s);
+
+// `seconds` simulated seconds, a loop pass each (quiet ones skipped, see above)
+void tk_sim_run(tk_sim_t *s, int64_t seconds);
+
+// Run until true time reaches `t` (no-op if it already has)
+void tk_sim_run_until(tk_sim_t *s, int64_t t);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,95 @@
+#pragma once
+// The owner task's decisions without the I/O: boot alignment, station events (connect,
+// disconnect, sniffed sighting, RSSI near/far), the 1 Hz tick, the focus user and the
+// save cadence. Each call updates the user table and says what to persist or send; the
+// caller does the writes, the deauth, the display and the logs. The firmware's owner
+// task (main/main.c) and the host simulator (host/tk_sim.c) both run on this, so a
+// replay on the host takes the same decision path as the unit.
+
+#include "tk_users.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t ticks;
+    uint32_t rollovers;      // day changes after the first tick
+    uint32_t checkins;
+    uint32_t resumes;
+    uint32_t deauths;        // deauths asked for
+    uint32_t state_saves;    // state writes asked for (immediate and periodic)
+    uint32_t mac_saves;      // enrollment writes asked for
+} tk_app_stats_t;
+
+typedef struct {
+    const tk_config_t *cfg;
+    int32_t            save_sec;                  // periodic save interval while counting
+    tk_users_t         users;
+    uint32_t           today;                     // yyyymmdd of the last tick (0 = none yet)
+    int                focus;                     // user on the display (last to check in), -1 = none
+    int64_t            last_save[TK_USERS_MAX];   // epoch of the last periodic save (0 = due)
+    tk_app_stats_t     stats;
+} tk_app_t;
+
+// What a station event asks of the caller
+typedef struct {
+    int          user;       // user it applied to, -1 = not an enrolled/acceptable station
+    tk_connect_t c;          // tk_users_on_connect() outcome (zero where it was not consulted)
+    bool         resumed;    // a paused session reopened
+    bool         save_mac;   // write the enrollment record (MAC, check-in day, user count)
+    bool         save_state; // write the user's state now
+    bool         deauth;     // send the station off (connect path only)
+} tk_app_out_t;
+
+// What a tick asks of the caller (bit u = user u)
+typedef struct {
+    tk_users_ev_t ev;        // transitions: history, logs
+    uint64_t      save_now;  // new day, target reached, paused
+    uint64_t      save_due;  // periodic saves that came due (once per save_sec per user)
+} tk_app_tick_t;
+
+// Empty table; the caller restores users[0..n) from its store, then calls tk_app_start()
+void tk_app_init(tk_app_t *app, const tk_config_t *cfg, uint32_t users_max, int32_t save_sec);
+
+// Boot on `today` (0 = no clock: the persisted days stand until the first tick) at `epoch`.
+// Reindexes the table, rolls stale days over, reopens running sessions (the grace window
+// restarts at boot) and focuses the first user checked in today. Out: users whose state
+// (*save_state) or enrollment record (*save_mac) must be written.
+void tk_app_start(tk_app_t *app, uint32_t today, int64_t epoch, uint64_t *save_state, uint64_t *save_mac);
+
+// Association accepted as a check-in candidate
+void tk_app_connect(tk_app_t *app, const uint8_t mac[6], int64_t now, tk_app_out_t *out);
+
+// Station left: only the last sighting, the tick pauses once the grace runs out. User or -1.
+int tk_app_disconnect(tk_app_t *app, const uint8_t mac[6], int64_t now);
+
+// Frame sniffed from an enrolled phone: a sighting, or a check-in without the deauth
+void tk_app_seen(tk_app_t *app, const uint8_t mac[6], int64_t now, tk_app_out_t *out);
+
+// Smoothed RSSI of an enrolled phone crossed a threshold (no association waiting on it):
+// in/out of range; near before today's check-in checks in, without the deauth
+void tk_app_link(tk_app_t *app, const uint8_t mac[6], bool near, int64_t now, tk_app_out_t *out);
+
+// A tick on `today` after an earlier one on another day. Call before tk_app_tick(): the
+// users still hold the day that is ending until it runs.
+static inline bool tk_app_new_day(const tk_app_t *app, uint32_t today) {
+    return app->today && today != app->today;
+}
+
+// One tick for every user at `epoch` on `today`
+void tk_app_tick(tk_app_t *app, int64_t epoch, uint32_t today, tk_app_tick_t *out);
+
+// Seconds after `epoch` whose ticks, with no station event and no day change, only move
+// the counters: no transition, no minute mark, no new HH:MM on the display. A tick after
+// them covers them exactly (never more than the tick clamp). The host simulator skips
+// these stretches; the unit ticks through them.
+int32_t tk_app_quiet(const tk_app_t *app, int64_t epoch);
+
+// State on the display: user[focus], or a fresh one (the full target) built in *idle
+const tk_state_t *tk_app_shown(const tk_state_t *user, uint32_t n, int focus, const tk_config_t *cfg,
+                               tk_state_t *idle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+// Civil calendar without libc time zones: proleptic Gregorian date <-> day number,
+// and struct tm <-> epoch at a fixed UTC offset (India has no DST). Integer-only,
+// no TZ parsing, no locks; replaces mktime()/localtime_r() on the 1 Hz path.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TK_CIVIL_IST_OFFSET   19800          // UTC+5:30, seconds east of UTC
+#define TK_CIVIL_SEC_PER_DAY  86400
+
+// Days since 1970-01-01 (negative before); y >= 1, m 1..12, d 1..31
+int32_t tk_days_from_civil(int32_t y, uint32_t m, uint32_t d);
+
+// Inverse of tk_days_from_civil()
+void tk_civil_from_days(int32_t days, int32_t *y, uint32_t *m, uint32_t *d);
+
+// Normalised local struct tm -> epoch (what mktime() gives with the zone at offset)
+int64_t tk_civil_to_epoch(const struct tm *t, int32_t offset);
+
+// Epoch -> local struct tm, including tm_wday/tm_yday; tm_isdst = 0
+void tk_civil_from_epoch(int64_t epoch, int32_t offset, struct tm *t);
+
+// Advance a normalised struct tm by one second; true when the date changed
+bool tk_civil_tick(struct tm *t);
+
+// Seconds since local midnight
+static inline int32_t tk_civil_sod(int64_t epoch, int32_t offset) {
+    int64_t s = (epoch + offset) % TK_CIVIL_SEC_PER_DAY;
+    return (int32_t)(s < 0 ? s + TK_CIVIL_SEC_PER_DAY : s);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,129 @@
+#pragma once
+// Timekeeper state machine (WAIT -> RUN <-> PAUSE -> DONE), free of ESP-IDF dependencies.
+// Time is always passed in, never read, so a host build can drive it from a
+// simulated clock at any speed. The firmware owns I/O: it acts on the flags
+// and results returned here (persist, deauth, display).
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    TK_DEAUTH_NONE = 0,
+    TK_DEAUTH_FIRST_CONNECT,     // deauth only on the check-in connect
+    TK_DEAUTH_ALWAYS,            // deauth on every accepted connect
+} tk_deauth_policy_t;
+
+typedef struct tk_state tk_state_t;
+
+// Connect policy as straight-line decisions on the user's state before the connect;
+// one table entry per combination, picked once by tk_config_resolve()
+typedef struct {
+    bool (*deauth)(const tk_state_t *st);    // schedule the delayed deauth
+    bool (*relearn)(const tk_state_t *st);   // a different MAC may replace the stored one
+} tk_policy_t;
+
+typedef struct {
+    int32_t            daily_target_sec;
+    int32_t            max_tick_delta_sec;   // clamp for a single tick (clock jumps)
+    bool               relearn_mac_daily;    // accept a new MAC before the day's check-in
+    tk_deauth_policy_t deauth;
+    int32_t            away_grace_sec;       // unseen this long after check-in: pause (0 = never)
+    const tk_policy_t *policy;               // from deauth + relearn_mac_daily (NULL: looked up per connect)
+    uint16_t           evict_idle_days;      // tk_users: a full table gives a new phone the slot of a
+                                             // user not checked in for this many days (0 = never)
+} tk_config_t;
+
+struct tk_state {
+    uint32_t day_key;        // yyyymmdd
+    int32_t  remaining;      // seconds left today
+    bool     started;        // checked in today
+    bool     have_mac;
+    uint8_t  mac[6];
+    int64_t  last_epoch;     // epoch of the previous tick (0 = none yet)
+    int32_t  worked;         // seconds on site today over all sessions (keeps counting past the target)
+    bool     paused;         // checked in but away: the countdown waits for the next sighting
+    bool     connected;      // in range: associated (and near, when RSSI-gated); seen every tick
+    int64_t  last_seen;      // epoch of the last sighting (0 = none yet)
+    int64_t  session_start;  // epoch the open session began (0 = none open)
+    int32_t  session_worked; // seconds counted in the open session
+    uint32_t last_in;        // yyyymmdd of the latest check-in (0 = unknown); persisted with the MAC
+};
+
+typedef enum { TK_WAIT, TK_RUN, TK_DONE, TK_PAUSE } tk_phase_t;
+
+// One day's on-site intervals. Closing a session appends in O(1); once the list is
+// full further sessions are folded into the last slot (its end moves, merged counts).
+#define TK_SESSIONS_MAX 8
+
+typedef struct {
+    uint32_t start, end;     // epochs
+} tk_session_t;
+
+typedef struct {
+    uint32_t     day_key;    // yyyymmdd the list belongs to (reset lazily on the first close of a day)
+    uint32_t     n;
+    uint32_t     merged;     // sessions folded into s[TK_SESSIONS_MAX - 1]
+    tk_session_t s[TK_SESSIONS_MAX];
+} tk_sessions_t;
+
+// tk_core_tick() / tk_core_set_day() result flags
+#define TK_EV_NEW_DAY   0x01     // reset for a new day: persist now
+#define TK_EV_DONE      0x02     // countdown reached zero: persist now
+#define TK_EV_MINUTE    0x04     // crossed a whole minute while running: periodic save point
+#define TK_EV_PAUSE     0x08     // away past the grace window: session closed, countdown stopped
+#define TK_EV_RESUME    0x10     // seen again while paused: new session, countdown running
+
+typedef struct {
+    bool accepted;           // treated as the enrolled phone
+    bool mac_updated;        // MAC learned/relearned: persist it
+    bool checked_in;         // this connect started today's countdown: persist now
+    bool deauth;             // schedule the delayed deauth
+    bool resumed;            // this connect ended a pause: persist now
+    bool evicted;            // tk_users_on_connect(): the slot was taken from an idle user
+} tk_connect_t;
+
+static inline uint32_t tk_day_key_from_tm(const struct tm *t) {
+    return (uint32_t)((t->tm_year + 1900) * 10000 + (t->tm_mon + 1) * 100 + t->tm_mday);
+}
+
+// Dispatch entry for a policy combination (an out-of-range deauth value acts as NONE)
+const tk_policy_t *tk_policy_get(tk_deauth_policy_t deauth, bool relearn_mac_daily);
+
+// Pick cfg->policy from cfg->deauth / cfg->relearn_mac_daily; call after changing either
+void tk_config_resolve(tk_config_t *cfg);
+
+// Fresh state: no MAC, waiting, full target
+void tk_core_init(tk_state_t *st, const tk_config_t *cfg);
+
+// Align to `today`; resets the countdown if the day changed (TK_EV_NEW_DAY)
+uint32_t tk_core_set_day(tk_state_t *st, const tk_config_t *cfg, uint32_t today);
+
+// One tick at `epoch` (seconds) on day `today`: rollover, then either count the elapsed
+// time as on-site or, once unseen past away_grace_sec, pause. A pause ends the session at
+// the last sighting and takes back what was counted after it. Closed sessions (including
+// the one open at rollover) go to ss, which may be NULL.
+uint32_t tk_core_tick(tk_state_t *st, const tk_config_t *cfg, int64_t epoch, uint32_t today,
+                      tk_sessions_t *ss);
+
+// A station associated with the SoftAP at `epoch`; also a sighting (may resume)
+tk_connect_t tk_core_on_connect(tk_state_t *st, const tk_config_t *cfg, const uint8_t mac[6], int64_t epoch);
+
+// The user was seen at `epoch` (sniffed frame, connect); TK_EV_RESUME if that ended a pause
+uint32_t tk_core_seen(tk_state_t *st, int64_t epoch);
+
+// In-range state changed at `epoch` (also a sighting; leaving does not pause by itself)
+uint32_t tk_core_set_link(tk_state_t *st, bool connected, int64_t epoch);
+
+tk_phase_t tk_core_phase(const tk_state_t *st);
+
+// Remaining time as HH:MM for the display (HH capped at 99)
+void tk_core_hhmm(const tk_state_t *st, uint8_t *hh, uint8_t *mm);
+
+#ifdef __cplusplus
+}
+#endif
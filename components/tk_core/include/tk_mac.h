@@ -0,0 +1,29 @@
+#pragma once
+// MAC addresses as table keys: the 48 bits packed into an integer (0 = empty slot) and
+// a 64-bit finalizer (murmur3 fmix64, one round) that spreads vendor-prefixed keys over
+// a table. Shared by every MAC-keyed table: users, connect limiter, sniffer, RSSI.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline uint64_t tk_mac_key(const uint8_t m[6])
+{
+    return ((uint64_t)m[0] << 40) | ((uint64_t)m[1] << 32) | ((uint64_t)m[2] << 24) |
+           ((uint64_t)m[3] << 16) | ((uint64_t)m[4] << 8)  |  (uint64_t)m[5];
+}
+
+// Reduce with a mask (power-of-two tables) or a modulo
+static inline uint32_t tk_mac_hash(uint64_t k)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    return (uint32_t)k;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+// Reconnect-storm limiter: a token bucket per MAC (burst, then one event per refill
+// period), exponential back-off for a MAC that keeps running its bucket dry (one
+// attempt passes as each back-off ends; the next dry hit doubles it), and a
+// global bucket that caps the total when many (spoofed) MACs each stay under their
+// own limit. Enrolled MACs answer only to their own bucket, so a flood cannot lock
+// the users out; spoofing an enrolled MAC buys no more than that one bucket.
+// Fixed table with a bounded probe window: every check is O(1). An entry is only
+// recycled once it has nothing left to remember (back-off over, bucket full); with
+// no such entry in the window a stranger goes untracked (global bucket only) and an
+// enrolled MAC displaces the stalest stranger. Single-threaded: call from one task only.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TK_RL_SLOTS   32             // power of two
+#define TK_RL_PROBE   4              // slots looked at per lookup; the stalest is recycled
+
+typedef struct {
+    uint16_t burst;                  // events a MAC may send back to back
+    uint32_t refill_ms;              // one token back per period
+    uint32_t backoff_ms;             // first back-off once the bucket is dry; doubles per strike
+    uint32_t backoff_max_ms;
+    uint16_t global_burst;           // all MACs together
+    uint32_t global_refill_ms;
+} tk_rl_config_t;
+
+typedef enum {
+    TK_RL_PASS,
+    TK_RL_DROP_RATE,                 // this MAC's bucket is empty (starts a back-off)
+    TK_RL_DROP_BACKOFF,              // this MAC is backing off
+    TK_RL_DROP_GLOBAL,               // the global bucket is empty
+    TK_RL_VERDICTS
+} tk_rl_verdict_t;
+
+typedef struct {
+    uint64_t key;                    // MAC as integer; 0 = free
+    uint32_t last_ms;                // time the tokens were last brought up to date
+    uint32_t until_ms;               // back-off end (valid while strikes > 0)
+    uint16_t tokens;
+    uint8_t  strikes;                // consecutive dry-bucket hits; reset once the bucket is full
+    bool     held_back;              // the newest connect was dropped (drop its disconnect too)
+    bool     enrolled;               // never displaced by a stranger
+} tk_rl_entry_t;
+
+typedef struct {
+    tk_rl_entry_t e[TK_RL_SLOTS];
+    uint16_t      g_tokens;
+    uint32_t      g_last_ms;
+    uint32_t      passed;
+    uint32_t      dropped[TK_RL_VERDICTS];   // connects by verdict ([TK_RL_PASS] unused)
+    uint32_t      dropped_disconnects;       // paired with a dropped connect
+    uint32_t      recycled;          // expired entries reused for a new MAC
+    uint32_t      displaced;         // live stranger entries taken by an enrolled MAC
+    uint32_t      untracked;         // strangers checked against the global bucket only
+} tk_rl_t;
+
+void tk_rl_init(tk_rl_t *rl, const tk_rl_config_t *cfg, uint32_t now_ms);
+
+// A connect from mac at now_ms (wrapping ms clock): spend a token or say why not.
+// enrolled: mac belongs to a user (skips the global bucket)
+tk_rl_verdict_t tk_rl_connect(tk_rl_t *rl, const tk_rl_config_t *cfg, const uint8_t mac[6], bool enrolled,
+                              uint32_t now_ms);
+
+// A disconnect from mac: true if it pairs with a dropped connect and should be dropped too
+bool tk_rl_disconnect(tk_rl_t *rl, const uint8_t mac[6]);
+
+// Total events dropped, connects and disconnects
+uint32_t tk_rl_dropped(const tk_rl_t *rl);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+// Presence from a noisy RSSI series: exponentially weighted mean in Q8 fixed point
+// (alpha = 2^-shift, one shift and one add per sample) with hysteresis between an
+// enter and a lower leave threshold, so a phone hovering at the edge of the office
+// does not flap between near and far. A series with no sample for a while goes stale:
+// a near one ends far, so near always ends in a transition.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int8_t  enter_dbm;       // smoothed >= enter: near
+    int8_t  leave_dbm;       // smoothed < leave: far (leave < enter)
+    uint8_t shift;           // EWMA weight of a new sample is 2^-shift (0..7)
+    uint8_t min_samples;     // samples before the first near decision
+} tk_rssi_config_t;
+
+typedef struct {
+    int32_t  avg_q8;         // smoothed RSSI, dBm * 256
+    uint32_t last_ms;        // time of the newest sample (wrapping ms clock)
+    uint16_t samples;        // saturates at UINT16_MAX
+    bool     near;
+} tk_rssi_t;
+
+// tk_rssi_update() results
+#define TK_RSSI_NEAR   1     // crossed enter_dbm upwards
+#define TK_RSSI_FAR    2     // crossed leave_dbm downwards, or went stale while near
+#define TK_RSSI_GONE   3     // went stale while far
+
+// Forget the series (far, no samples)
+void tk_rssi_reset(tk_rssi_t *r);
+
+// Add one sample taken at now_ms; the first one seeds the mean. Returns TK_RSSI_NEAR /
+// TK_RSSI_FAR on a transition, else 0.
+int tk_rssi_update(tk_rssi_t *r, const tk_rssi_config_t *cfg, int8_t dbm, uint32_t now_ms);
+
+// No sample for more than stale_ms: reset the series and return TK_RSSI_FAR if it was
+// near, TK_RSSI_GONE if not. 0 while it is live (or has no samples).
+int tk_rssi_expire(tk_rssi_t *r, uint32_t now_ms, uint32_t stale_ms);
+
+// Smoothed RSSI rounded to whole dBm
+static inline int tk_rssi_dbm(const tk_rssi_t *r) {
+    return (int)((r->avg_q8 + 128) >> 8);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+// Single-writer seqlock over a fixed-size payload. The payload is kept as atomic words
+// (relaxed loads/stores between acquire/release fences), so a reader overlapping the
+// writer is well-defined C11 rather than a data race; it just retries.
+// No blocking on either side: the writer never waits, a reader that keeps losing to the
+// writer gives up after a bounded number of tries (never spins on a preempted writer).
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TK_SEQLOCK_WORDS(bytes) (((bytes) + 3) / 4)
+
+typedef struct {
+    _Atomic uint32_t  seq;         // odd while a write is in progress
+    _Atomic uint32_t *words;
+    size_t            bytes;
+} tk_seqlock_t;
+
+// storage must hold TK_SEQLOCK_WORDS(bytes) words
+void tk_seqlock_init(tk_seqlock_t *s, _Atomic uint32_t *storage, size_t bytes);
+
+// Writer (one thread only)
+void tk_seqlock_write(tk_seqlock_t *s, const void *src);
+
+// Consistent copy into dst; false if every one of `tries` attempts overlapped a write.
+// The copy goes straight into dst (no bounce buffer for multi-KB payloads), so after a
+// false return dst holds a torn mix: read into a spare and keep the last good copy.
+bool tk_seqlock_read(tk_seqlock_t *s, void *dst, unsigned tries);
+
+// Completed writes so far
+static inline uint32_t tk_seqlock_version(tk_seqlock_t *s) {
+    return atomic_load_explicit(&s->seq, memory_order_acquire) >> 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+// Fixed-capacity user table on top of tk_core: one tk_state_t per enrolled phone in a
+// contiguous array (index = stable user id, used as the persistence key), plus an
+// open-addressing index on the 48-bit MAC for O(1) lookup from event handlers.
+// A user is exactly one MAC: a phone that presents another address (MAC randomisation
+// per network turned back on, a new phone) enrolls as a new user, and the old entry
+// goes once it has been idle for cfg->evict_idle_days or is removed.
+
+#include "tk_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef TK_USERS_MAX
+#define TK_USERS_MAX   48
+#endif
+#define TK_USERS_SLOTS 128           // power of two, >= 2 * TK_USERS_MAX
+
+typedef struct {
+    tk_state_t user[TK_USERS_MAX];   // [0, n) in use
+    tk_sessions_t sess[TK_USERS_MAX]; // today's closed sessions per user
+    uint32_t   n;
+    uint32_t   max;                  // runtime capacity <= TK_USERS_MAX; 1 = single-phone unit
+    uint64_t   key[TK_USERS_SLOTS];  // MAC as integer; 0 = empty
+    uint8_t    idx[TK_USERS_SLOTS];  // user index for key[]
+} tk_users_t;
+
+// Per-tick outcome: which users need persisting (bit i = user i)
+typedef struct {
+    uint32_t any;                    // OR of all TK_EV_* flags
+    uint64_t new_day;                // TK_EV_NEW_DAY
+    uint64_t done;                   // TK_EV_DONE
+    uint64_t minute;                 // TK_EV_MINUTE
+    uint64_t pause;                  // TK_EV_PAUSE
+} tk_users_ev_t;
+
+void tk_users_init(tk_users_t *t, uint32_t max);
+
+// User index for mac, or -1
+int tk_users_find(const tk_users_t *t, const uint8_t mac[6]);
+
+// Rebuild the MAC index after restoring user[0..n) directly (e.g. from flash)
+void tk_users_reindex(tk_users_t *t);
+
+// tk_core_set_day() for every user; returns OR of the flags
+uint32_t tk_users_set_day(tk_users_t *t, const tk_config_t *cfg, uint32_t today);
+
+// One tick for all users in a single pass over the array (closed sessions land in sess[])
+void tk_users_tick(tk_users_t *t, const tk_config_t *cfg, int64_t epoch, uint32_t today, tk_users_ev_t *ev);
+
+// A station connected / was seen at epoch. Known MAC: that user's check-in. Unknown MAC: a
+// new user while there is room; on a full table, the slot of the user whose last check-in
+// is oldest and at least cfg->evict_idle_days before today (evicted: the caller persists
+// the slot as new); on a full single-phone table (max == 1) the relearn policy of
+// tk_core_on_connect() applies. *user is the index it was applied to (-1 if none).
+tk_connect_t tk_users_on_connect(tk_users_t *t, const tk_config_t *cfg, const uint8_t mac[6],
+                                 uint32_t today, int64_t epoch, int *user);
+
+// Drop user u. The last user moves into slot u, so its persistence key changes: the caller
+// re-persists slot u and the new count. False if u is out of range.
+bool tk_users_remove(tk_users_t *t, uint32_t u);
+
+#ifdef __cplusplus
+}
+#endif
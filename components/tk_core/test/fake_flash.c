@@ -0,0 +1,104 @@
+#include "fake_flash.h"
+#include <pthread.h>
+#include <string.h>
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "freertos/semphr.h"
+
+typedef struct {
+    esp_partition_t part;
+    uint32_t        bad_writes;
+    uint8_t         mem[FAKE_FLASH_MAX_SECTORS * FAKE_FLASH_SECTOR];
+} fake_part_t;
+
+static fake_part_t s_parts[] = {
+    { .part = { .label = "history" } },
+    { .part = { .label = "journal" } },
+};
+
+static fake_part_t *by_label(const char *label)
+{
+    for (size_t i = 0; i < sizeof(s_parts) / sizeof(s_parts[0]); i++) {
+        if (strcmp(label, s_parts[i].part.label) == 0) return &s_parts[i];
+    }
+    return NULL;
+}
+
+uint8_t *fake_flash_reset(const char *label, uint32_t sectors)
+{
+    fake_part_t *f = by_label(label);
+    if (!f || sectors > FAKE_FLASH_MAX_SECTORS) return NULL;
+    f->part.size = sectors * FAKE_FLASH_SECTOR;
+    f->bad_writes = 0;
+    memset(f->mem, 0xFF, sizeof(f->mem));
+    return f->mem;
+}
+
+uint32_t fake_flash_bad_writes(const char *label)
+{
+    fake_part_t *f = by_label(label);
+    return f ? f->bad_writes : 0;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    (void)type; (void)subtype;
+    fake_part_t *f = by_label(label);
+    return (f && f->part.size) ? &f->part : NULL;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *p, size_t off, void *dst, size_t len)
+{
+    const fake_part_t *f = (const fake_part_t *)p;
+    if (off + len > p->size) return ESP_ERR_INVALID_SIZE;
+    memcpy(dst, f->mem + off, len);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *p, size_t off, const void *src, size_t len)
+{
+    fake_part_t *f = (fake_part_t *)p;
+    if (off + len > p->size) return ESP_ERR_INVALID_SIZE;
+    const uint8_t *b = src;
+    for (size_t i = 0; i < len; i++) {
+        if (b[i] & ~f->mem[off + i]) f->bad_writes++;
+        f->mem[off + i] &= b[i];
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *p, size_t off, size_t len)
+{
+    fake_part_t *f = (fake_part_t *)p;
+    if (off % FAKE_FLASH_SECTOR || len % FAKE_FLASH_SECTOR || off + len > p->size) return ESP_ERR_INVALID_ARG;
+    memset(f->mem + off, 0xFF, len);
+    return ESP_OK;
+}
+
+uint16_t esp_rom_crc16_le(uint16_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = (uint16_t)~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int k = 0; k < 8; k++) crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0x8408) : (uint16_t)(crc >> 1);
+    }
+    return (uint16_t)~crc;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    static pthread_mutex_t m = PTHREAD_MUTEX_INITIALIZER;
+    return &m;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait)
+{
+    (void)wait;
+    return pthread_mutex_lock(s) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+    return pthread_mutex_unlock(s) == 0 ? pdTRUE : pdFALSE;
+}
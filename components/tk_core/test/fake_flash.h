@@ -0,0 +1,17 @@
+#pragma once
+// RAM partitions with NOR semantics behind the esp_partition stub, for main/history.c and
+// main/journal.c: erase sets 0xFF, a write can only clear bits (a write that needs a
+// 0 -> 1 transition is counted, and still only clears). Also the ROM CRC-16 and the
+// FreeRTOS mutex calls those files use.
+
+#include <stdint.h>
+
+#define FAKE_FLASH_SECTOR       4096
+#define FAKE_FLASH_MAX_SECTORS  64
+
+// A blank (all 0xFF) partition of `sectors` sectors under `label` ("history" or
+// "journal"); 0 sectors removes it. Returns its bytes for tests that corrupt them.
+uint8_t *fake_flash_reset(const char *label, uint32_t sectors);
+
+// Writes to `label` since its reset that needed a 0 -> 1 transition
+uint32_t fake_flash_bad_writes(const char *label);
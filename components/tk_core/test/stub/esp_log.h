@@ -0,0 +1,8 @@
+#pragma once
+// Host stand-in: log calls compile (formats still checked) and print nothing
+#include <stdio.h>
+
+#define TK_STUB_LOG(tag, fmt, ...) do { (void)(tag); if (0) printf(fmt, ##__VA_ARGS__); } while (0)
+#define ESP_LOGE(tag, fmt, ...) TK_STUB_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) TK_STUB_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) TK_STUB_LOG(tag, fmt, ##__VA_ARGS__)
@@ -0,0 +1,5 @@
+#pragma once
+// Host stand-in for the ROM CRC (test/fake_flash.c)
+#include <stdint.h>
+
+uint16_t esp_rom_crc16_le(uint16_t crc, const uint8_t *buf, uint32_t len);
@@ -0,0 +1,5 @@
+#pragma once
+// Host stand-in for the one esp_timer call main/event_ring.c makes
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);      // µs, monotonic (test_seqlock.c)
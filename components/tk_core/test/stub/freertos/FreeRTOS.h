@@ -0,0 +1,10 @@
+#pragma once
+// Host stand-in: the FreeRTOS types main/history.c uses
+#include <stdint.h>
+
+typedef int      BaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE         1
+#define pdFALSE        0
+#define portMAX_DELAY  0xFFFFFFFFu
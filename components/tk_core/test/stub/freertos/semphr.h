@@ -0,0 +1,10 @@
+#pragma once
+// Host stand-in: a FreeRTOS mutex is a pthread mutex (test/fake_flash.c)
+#include <pthread.h>
+#include "freertos/FreeRTOS.h"
+
+typedef pthread_mutex_t *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s);
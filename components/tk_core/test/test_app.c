@@ -0,0 +1,257 @@
+// tk_app on the host fakes: check-in, deauth, done, reboot (the display keeps following a
+// checked-in user), RTC failure, clock jump, rollover; and its boot and near/far calls
+// directly, as the owner task makes them
+#include <string.h>
+#include "tk_sim.h"
+#include "tk_test.h"
+
+#define TARGET   (9 * 3600 + 15 * 60)
+#define SAVE_SEC 900
+
+static const uint8_t PHONE[6] = { 0x02, 0x11, 0x22, 0x33, 0x44, 0x55 };
+static const uint8_t OTHER[6] = { 0x02, 0x66, 0x77, 0x88, 0x99, 0xAA };
+static const uint8_t THIRD[6] = { 0x02, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E };
+
+static const tk_config_t CFG = {
+    .daily_target_sec   = TARGET,
+    .max_tick_delta_sec = 60,
+    .relearn_mac_daily  = true,
+    .deauth             = TK_DEAUTH_FIRST_CONNECT,
+};
+
+static tk_sim_t s_sim;                     // too big for the stack
+
+static void checkin_to_done(void)
+{
+    tk_sim_t *s = &s_sim;
+    int64_t day0 = tk_test_ist(2024, 3, 4, 0, 0, 0);
+    tk_sim_init(s, &CFG, 1, SAVE_SEC, day0 + 8 * 3600, 0);
+    CHECK_EQ(s->app.users.n, 0);
+    CHECK_EQ(s->disp.hh, 9);
+    CHECK_EQ(s->disp.mm, 15);
+
+    tk_fake_wifi_push(&s->wifi, day0 + 9 * 3600, TK_RADIO_CONNECT, PHONE);
+    tk_sim_run_until(s, day0 + 9 * 3600);
+    CHECK_EQ(s->app.users.n, 1);
+    CHECK_EQ(s->app.stats.checkins, 1);
+    CHECK_EQ(s->wifi.deauths, 1);
+    CHECK(memcmp(s->wifi.last_deauth, PHONE, 6) == 0);
+    CHECK_EQ(s->store.mac_writes, 1);
+    CHECK_EQ(s->store.n, 1);
+    CHECK(s->store.st[0].started);
+
+    // a second connect the same day is neither a check-in nor a deauth
+    tk_fake_wifi_push(&s->wifi, day0 + 10 * 3600, TK_RADIO_CONNECT, PHONE);
+    tk_sim_run_until(s, day0 + 10 * 3600);
+    CHECK_EQ(s->app.stats.checkins, 1);
+    CHECK_EQ(s->wifi.deauths, 1);
+    CHECK_EQ(s->app.users.user[0].remaining, TARGET - 3600);
+    CHECK_EQ(s->disp.hh, 8);
+    CHECK_EQ(s->disp.mm, 15);
+
+    tk_sim_run_until(s, day0 + 9 * 3600 + TARGET);
+    CHECK_EQ(tk_core_phase(&s->app.users.user[0]), TK_DONE);
+    CHECK_EQ(s->store.st[0].remaining, 0);
+    CHECK_EQ(s->disp.hh, 0);
+    CHECK_EQ(s->disp.mm, 0);
+
+    // one RTC transaction per second in poll mode; the colon blink is a 3-byte digit write
+    CHECK_EQ(s->rtc.i2c_xfers, 1 + 9 * 3600 + TARGET - 8 * 3600);
+    CHECK(s->disp.bytes < 4 * s->disp.frames_sent);
+}
+
+static void reboot_keeps_countdown(void)
+{
+    tk_sim_t *s = &s_sim;
+    int64_t day0 = tk_test_ist(2024, 3, 5, 0, 0, 0);
+    tk_sim_init(s, &CFG, 1, SAVE_SEC, day0 + 9 * 3600, 0);
+    tk_fake_wifi_push(&s->wifi, day0 + 9 * 3600 + 1, TK_RADIO_CONNECT, PHONE);
+    tk_sim_run(s, 2 * 3600 + 600);
+    int32_t before = s->app.users.user[0].remaining;
+
+    // at most one save interval is lost, and the countdown goes on from there
+    tk_sim_reboot(s);
+    const tk_state_t *st = &s->app.users.user[0];
+    CHECK_EQ(s->app.users.n, 1);
+    CHECK(st->started);
+    CHECK(st->have_mac);
+    CHECK(st->remaining >= before && st->remaining <= before + SAVE_SEC);
+    int32_t after_boot = st->remaining;
+    tk_sim_run(s, 120);
+    CHECK_EQ(st->remaining, after_boot - 120);
+    CHECK_EQ(s->wifi.deauths, 1);
+}
+
+// After a reboot mid-day the display shows the first user (lowest index) checked in
+// today, not the idle 9:15, and /status reports that focus
+static void reboot_keeps_focus(void)
+{
+    tk_sim_t *s = &s_sim;
+    int64_t day0 = tk_test_ist(2024, 3, 5, 0, 0, 0);
+    tk_sim_init(s, &CFG, 3, SAVE_SEC, day0 + 8 * 3600, 0);
+    // three phones enroll on day one; on day two only users 1 and 2 come in
+    tk_fake_wifi_push(&s->wifi, day0 + 8 * 3600 + 1, TK_RADIO_CONNECT, PHONE);
+    tk_fake_wifi_push(&s->wifi, day0 + 8 * 3600 + 2, TK_RADIO_CONNECT, OTHER);
+    tk_fake_wifi_push(&s->wifi, day0 + 8 * 3600 + 3, TK_RADIO_CONNECT, THIRD);
+    tk_fake_wifi_push(&s->wifi, day0 + 86400 + 9 * 3600, TK_RADIO_CONNECT, OTHER);
+    tk_fake_wifi_push(&s->wifi, day0 + 86400 + 10 * 3600, TK_RADIO_CONNECT, THIRD);
+    tk_sim_run_until(s, day0 + 86400 + 11 * 3600);
+    CHECK_EQ(s->app.users.n, 3);
+    CHECK(!s->app.users.user[0].started);
+    CHECK_EQ(s->app.focus, 2);                              // the last to check in
+
+    tk_sim_reboot(s);
+    CHECK_EQ(s->app.focus, 1);
+    uint8_t hh, mm;
+    tk_core_hhmm(&s->app.users.user[1], &hh, &mm);
+    CHECK(hh != 9 || mm != 15);
+    CHECK_EQ(s->disp.hh, hh);
+    CHECK_EQ(s->disp.mm, mm);
+    tk_sim_run(s, 60);
+    tk_core_hhmm(&s->app.users.user[1], &hh, &mm);
+    CHECK_EQ(s->disp.hh, hh);
+    CHECK_EQ(s->disp.mm, mm);
+
+    // nobody checked in yet today: no focus, the full target
+    tk_sim_run_until(s, day0 + 2 * 86400 + 8 * 3600);
+    tk_sim_reboot(s);
+    CHECK_EQ(s->app.focus, -1);
+    CHECK_EQ(s->disp.hh, 9);
+    CHECK_EQ(s->disp.mm, 15);
+}
+
+static void rtc_failures_and_jumps(void)
+{
+    tk_sim_t *s = &s_sim;
+    int64_t day0 = tk_test_ist(2024, 3, 6, 0, 0, 0);
+    tk_sim_init(s, &CFG, 1, SAVE_SEC, day0 + 9 * 3600, 0);
+    tk_fake_wifi_push(&s->wifi, day0 + 9 * 3600 + 1, TK_RADIO_CONNECT, PHONE);
+    tk_sim_run(s, 60);
+    int32_t rem = s->app.users.user[0].remaining;
+
+    // reads fail for 5 minutes: error frame, no ticks; the next good one counts at most 60 s
+    s->rtc.fail_reads = 300;
+    tk_sim_run(s, 300);
+    CHECK_EQ(s->rtc_fail, 300);
+    CHECK_EQ(s->disp.hh, 0);
+    CHECK(!s->disp.colon);
+    CHECK_EQ(s->app.users.user[0].remaining, rem);
+    tk_sim_run(s, 1);
+    CHECK_EQ(s->app.users.user[0].remaining, rem - 60);
+
+    // the RTC jumps 2 h ahead and back: each jump is clamped, a backwards one counts nothing
+    rem = s->app.users.user[0].remaining;
+    s->rtc.offset = 7200;
+    tk_sim_run(s, 1);
+    CHECK_EQ(s->app.users.user[0].remaining, rem - 60);
+    s->rtc.offset = 0;
+    tk_sim_run(s, 1);
+    CHECK_EQ(s->app.users.user[0].remaining, rem - 60);
+}
+
+static void rollover_at_ist_midnight(void)
+{
+    tk_sim_t *s = &s_sim;
+    int64_t day0 = tk_test_ist(2024, 12, 31, 0, 0, 0);
+    tk_sim_init(s, &CFG, 1, SAVE_SEC, day0 + 20 * 3600, 0);
+    tk_fake_wifi_push(&s->wifi, day0 + 20 * 3600 + 1, TK_RADIO_CONNECT, PHONE);
+    tk_sim_run_until(s, day0 + 86400 - 1);
+    CHECK_EQ(s->app.today, 20241231);
+    CHECK(s->app.users.user[0].started);
+    uint32_t writes = s->store.state_writes;
+
+    tk_sim_run(s, 1);                      // 00:00:00 IST = 18:30 UTC
+    const tk_state_t *st = &s->app.users.user[0];
+    CHECK_EQ(s->app.today, 20250101);
+    CHECK_EQ(st->day_key, 20250101);
+    CHECK(!st->started);
+    CHECK_EQ(st->remaining, TARGET);
+    CHECK_EQ(s->app.stats.rollovers, 1);
+    CHECK_EQ(s->store.state_writes, writes + 1);
+    CHECK_EQ(s->store.st[0].day_key, 20250101);
+    // the day's session closed at the last tick before midnight
+    CHECK_EQ(s->app.users.sess[0].n, 1);
+    CHECK_EQ(s->app.users.sess[0].s[0].end, day0 + 86400 - 1);
+
+    // relearn before the check-in: a new phone takes over the single slot
+    tk_fake_wifi_push(&s->wifi, s->now + 3600, TK_RADIO_CONNECT, OTHER);
+    tk_sim_run(s, 3600);
+    CHECK(memcmp(s->app.users.user[0].mac, OTHER, 6) == 0);
+    CHECK_EQ(s->store.mac_writes, 2);
+    CHECK(s->app.users.user[0].started);
+}
+
+static void sqw_mode_reads_rarely(void)
+{
+    tk_sim_t *s = &s_sim;
+    int64_t day0 = tk_test_ist(2024, 3, 7, 0, 0, 0);
+    tk_sim_init(s, &CFG, 1, SAVE_SEC, day0, 3600);
+    tk_sim_run(s, 86400);
+    // hourly resyncs, plus the read at boot and the one at the day boundary
+    CHECK(s->rtc.i2c_xfers >= 24 && s->rtc.i2c_xfers <= 26);
+    CHECK_EQ(s->app.stats.ticks + s->skipped, 86400);      // a tick a second, or skipped as quiet
+    CHECK(s->skipped > 86400 * 9 / 10);
+    CHECK_EQ(s->disp.frames, 86400 + 1);
+    CHECK_EQ(s->app.stats.rollovers, 1);
+}
+
+// tk_app_start on a restored table: stale day rolled over, legacy record migrated,
+// running session reopened at boot; then a near signal checks in without the deauth
+static void start_and_link(void)
+{
+    static tk_app_t app;
+    int64_t t = tk_test_ist(2024, 3, 6, 10, 0, 0);
+    tk_app_init(&app, &CFG, 2, SAVE_SEC);
+    tk_core_init(&app.users.user[0], &CFG);
+    tk_core_init(&app.users.user[1], &CFG);
+    memcpy(app.users.user[0].mac, PHONE, 6);
+    memcpy(app.users.user[1].mac, OTHER, 6);
+    app.users.user[0].have_mac = app.users.user[1].have_mac = true;
+    app.users.user[0].day_key   = 20240305;                 // yesterday
+    app.users.user[0].started   = true;
+    app.users.user[0].last_in   = 20240305;
+    app.users.user[1].day_key   = 20240306;                 // today, running, no last_in yet
+    app.users.user[1].started   = true;
+    app.users.user[1].remaining = 3600;
+    app.users.n = 2;
+
+    uint64_t save_state, save_mac;
+    tk_app_start(&app, 20240306, t, &save_state, &save_mac);
+    CHECK_EQ(save_state, 1u);
+    CHECK_EQ(save_mac, 2u);
+    CHECK_EQ(app.users.user[1].last_in, 20240306u);
+    CHECK(!app.users.user[0].started);
+    CHECK_EQ(app.users.user[1].session_start, t);
+    CHECK_EQ(app.focus, 1);
+    CHECK_EQ(tk_users_find(&app.users, PHONE), 0);
+
+    tk_app_out_t o;
+    tk_app_link(&app, PHONE, false, t + 5, &o);                // far before check-in: nothing
+    CHECK(!o.save_state && !o.save_mac);
+    tk_app_link(&app, PHONE, true, t + 10, &o);
+    CHECK_EQ(o.user, 0);
+    CHECK(o.c.checked_in);
+    CHECK(!o.deauth);
+    CHECK(o.save_mac && o.save_state);
+    CHECK_EQ(app.focus, 0);
+    CHECK_EQ(app.stats.checkins, 1);
+
+    // the tick on another day is announced before it resets anyone
+    CHECK(!tk_app_new_day(&app, 20240306));
+    CHECK(tk_app_new_day(&app, 20240307));
+    tk_app_tick_t tick;
+    tk_app_tick(&app, tk_test_ist(2024, 3, 7, 0, 0, 1), 20240307, &tick);
+    CHECK_EQ(tick.save_now & tick.ev.new_day, 3u);
+    CHECK_EQ(app.stats.rollovers, 1);
+}
+
+void test_app(void)
+{
+    checkin_to_done();
+    reboot_keeps_countdown();
+    reboot_keeps_focus();
+    rtc_failures_and_jumps();
+    rollover_at_ist_midnight();
+    sqw_mode_reads_rarely();
+    start_and_link();
+}
@@ -0,0 +1,137 @@
+// tk_civil against libc: every day of 1900..2199 through mktime()/localtime_r() with
+// TZ=IST-5:30, the day-number round trip over the whole 0001..9999 range, a year of
+// one-second ticks, and ns/op next to the libc calls it replaces.
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tk_civil.h"
+#include "tk_test.h"
+
+static bool same_tm(const struct tm *a, const struct tm *b)
+{
+    return a->tm_year == b->tm_year && a->tm_mon == b->tm_mon && a->tm_mday == b->tm_mday &&
+           a->tm_hour == b->tm_hour && a->tm_min == b->tm_min && a->tm_sec == b->tm_sec &&
+           a->tm_wday == b->tm_wday && a->tm_yday == b->tm_yday;
+}
+
+static const uint8_t MDAYS[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+static bool leap(int32_t y) { return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0; }
+
+// Every date 0001-01-01..9999-12-31: consecutive day numbers, exact inverse
+static void days_round_trip(void)
+{
+    int32_t expect = tk_days_from_civil(1, 1, 1);
+    long bad = 0;
+    for (int32_t y = 1; y <= 9999; y++) {
+        for (uint32_t m = 1; m <= 12; m++) {
+            uint32_t dim = MDAYS[m - 1] + (m == 2 && leap(y));
+            for (uint32_t d = 1; d <= dim; d++, expect++) {
+                int32_t n = tk_days_from_civil(y, m, d);
+                int32_t yy; uint32_t mm, dd;
+                tk_civil_from_days(n, &yy, &mm, &dd);
+                bad += (n != expect) || yy != y || mm != m || dd != d;
+            }
+        }
+    }
+    CHECK_EQ(bad, 0);
+    CHECK_EQ(tk_days_from_civil(1970, 1, 1), 0);
+    CHECK_EQ(tk_days_from_civil(2000, 3, 1), 11017);
+}
+
+// Every day of 1900..2199 at instants around both midnights (IST and UTC) and midday
+static void against_libc(void)
+{
+    static const int HMS[][3] = { { 0, 0, 0 }, { 0, 0, 1 }, { 5, 29, 59 }, { 5, 30, 0 }, { 12, 34, 56 }, { 23, 59, 59 } };
+    long checked = 0, bad = 0;
+    for (int y = 1900; y < 2200; y++) {
+        for (int m = 0; m < 12; m++) {
+            int dim = MDAYS[m] + (m == 1 && leap(y));
+            for (int d = 1; d <= dim; d++) {
+                for (size_t k = 0; k < sizeof(HMS) / sizeof(HMS[0]); k++) {
+                    struct tm x = { .tm_year = y - 1900, .tm_mon = m, .tm_mday = d,
+                                    .tm_hour = HMS[k][0], .tm_min = HMS[k][1], .tm_sec = HMS[k][2], .tm_isdst = -1 };
+                    struct tm xm = x;
+                    time_t e = mktime(&xm);
+                    struct tm lc, lm;
+                    tk_civil_from_epoch(e, TK_CIVIL_IST_OFFSET, &lc);
+                    localtime_r(&e, &lm);
+                    bad += tk_civil_to_epoch(&x, TK_CIVIL_IST_OFFSET) != (int64_t)e;
+                    bad += !same_tm(&lc, &lm);
+                    bad += tk_civil_sod(e, TK_CIVIL_IST_OFFSET) != HMS[k][0] * 3600 + HMS[k][1] * 60 + HMS[k][2];
+                    checked++;
+                }
+            }
+        }
+    }
+    CHECK_EQ(bad, 0);
+    CHECK_EQ(checked, 109573 * 6);
+}
+
+// 2024 (a leap year) one second at a time: tick == from_epoch, date changes only at midnight
+static void tick_year(void)
+{
+    int64_t e   = tk_test_ist(2024, 1, 1, 0, 0, 0);
+    int64_t end = tk_test_ist(2025, 1, 1, 0, 0, 1);
+    struct tm t, r;
+    tk_civil_from_epoch(e, TK_CIVIL_IST_OFFSET, &t);
+    long bad = 0, days = 0;
+    while (++e < end) {
+        bool changed = tk_civil_tick(&t);
+        days += changed;
+        bad  += changed != (t.tm_hour == 0 && t.tm_min == 0 && t.tm_sec == 0);
+        if (changed || t.tm_sec == 0) {
+            tk_civil_from_epoch(e, TK_CIVIL_IST_OFFSET, &r);
+            bad += !same_tm(&t, &r);
+        }
+    }
+    tk_civil_from_epoch(end - 1, TK_CIVIL_IST_OFFSET, &r);
+    CHECK(same_tm(&t, &r));
+    CHECK_EQ(bad, 0);
+    CHECK_EQ(days, 366);
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(void)
+{
+    enum { N = 2000000 };
+    volatile int64_t sink = 0;
+    struct tm b;
+    double t0, lt, mk, cf, ct, tk;
+
+    t0 = now_sec();
+    for (int i = 0; i < N; i++) { time_t e = 1760000000 + i; localtime_r(&e, &b); sink += b.tm_sec; }
+    lt = now_sec() - t0;
+    t0 = now_sec();
+    for (int i = 0; i < N; i++) { b.tm_sec = i % 60; b.tm_isdst = -1; sink += mktime(&b); }
+    mk = now_sec() - t0;
+    t0 = now_sec();
+    for (int i = 0; i < N; i++) { tk_civil_from_epoch(1760000000 + i, TK_CIVIL_IST_OFFSET, &b); sink += b.tm_sec; }
+    cf = now_sec() - t0;
+    t0 = now_sec();
+    for (int i = 0; i < N; i++) { b.tm_sec = i % 60; sink += tk_civil_to_epoch(&b, TK_CIVIL_IST_OFFSET); }
+    ct = now_sec() - t0;
+    tk_civil_from_epoch(1760000000, TK_CIVIL_IST_OFFSET, &b);
+    t0 = now_sec();
+    for (int i = 0; i < N; i++) { tk_civil_tick(&b); sink += b.tm_sec; }
+    tk = now_sec() - t0;
+    (void)sink;
+    printf("civil ns/op: from_epoch %.1f (localtime_r %.1f), to_epoch %.1f (mktime %.1f), tick %.1f\n",
+           cf / N * 1e9, lt / N * 1e9, ct / N * 1e9, mk / N * 1e9, tk / N * 1e9);
+}
+
+void test_civil(void)
+{
+    setenv("TZ", "IST-5:30", 1);
+    tzset();
+    days_round_trip();
+    against_libc();
+    tick_year();
+    bench();
+}
@@ -0,0 +1,114 @@
+// main/dlog_fmt.c: records print as printf would, and every format survives the "#dlog"
+// line the firmware emits for the host decoder (words, negative %d, %s text, the clock
+// record's epoch), with malformed lines refused.
+#include <stdlib.h>
+#include <string.h>
+#include "dlog_fmt.h"
+#include "tk_test.h"
+
+static char s_out[512];
+
+static const char *print(uint32_t id, uint32_t ts_ms, const uintptr_t *arg, uint32_t nargs)
+{
+    FILE *f = fmemopen(s_out, sizeof(s_out), "w");
+    dlog_print(f, id, ts_ms, arg, nargs);
+    fclose(f);
+    return s_out;
+}
+
+static void expect(uint32_t id, uint32_t ts_ms, const uintptr_t *arg, uint32_t nargs, const char *want)
+{
+    const char *got = print(id, ts_ms, arg, nargs);
+    if (strcmp(got, want) != 0) {
+        tk_test_failures++;
+        fprintf(stderr, "dlog id %u: got \"%s\", want \"%s\"\n", (unsigned)id, got, want);
+    }
+}
+
+static void known_text(void)
+{
+    const uintptr_t mac[7] = { 0x02, 0xAB, 0xCD, 0xEF, 0x01, 0x23, 3 };
+    expect(DLOG_STA_CONNECTED, 1234, mac, 7, "I (1234) tk: STA connected: 02:AB:CD:EF:01:23 AID=3\n");
+    const uintptr_t near[7] = { 0x02, 0xAB, 0xCD, 0xEF, 0x01, 0x23, (uintptr_t)-60 };
+    expect(DLOG_RSSI_NEAR, 7, near, 7, "I (7) tk: STA 02:AB:CD:EF:01:23 near (-60 dBm smoothed)\n");
+    const uintptr_t fail[2] = { 4, (uintptr_t)"ESP_FAIL" };
+    expect(DLOG_DEAUTH_FAIL, 9, fail, 2, "W (9) tk: deauth (AID=4) failed: ESP_FAIL\n");
+    expect(DLOG_RTC_FAIL, 9, NULL, 0, "\r\x1b[KRTC read failed...");
+    const uintptr_t st[6] = { (uintptr_t)(uint32_t)tk_test_ist(2024, 3, 5, 14, 7, 9), 1, 5, (uintptr_t)"RUN ", 2, 3 };
+    expect(DLOG_STATUS, 0, st, 6, "\r\x1b[K02:07:09 PM 05-03-2024 IST | Rem 01:05 | RUN  | 2/3 running");
+}
+
+// Args for id's conversions: text for %s, otherwise words, negative ones included
+static uint32_t sample_args(uint32_t id, uintptr_t *arg)
+{
+    static const char *const TEXT[] = { "AWAY", "ESP_ERR_TIMEOUT", "a b%c" };
+    const dlog_fmt_t *f = &dlog_fmt[id];
+    uint32_t n = 0;
+    for (const char *p = strchr(f->fmt, '%'); p; p = strchr(p + 1, '%')) {
+        size_t k = 1 + strspn(p + 1, "-+ #0123456789.");
+        if (p[k] == '%') { p += k; continue; }
+        if (f->kind == DLOG_CLOCK && n == 0) arg[n] = (uintptr_t)(uint32_t)tk_test_ist(2031, 12, 31, 23, 59, 59);
+        else if (p[k] == 's') arg[n] = (uintptr_t)TEXT[(id + n) % 3];
+        else if (p[k] == 'd') arg[n] = (uintptr_t)(intptr_t)(n % 2 ? -(int)(id * 7 + n) : (int)(id * 1000 + n));
+        else arg[n] = (uintptr_t)(id * 37 + n * 11);
+        n++;
+    }
+    CHECK(n <= DLOG_MAX_ARGS);
+    return n;
+}
+
+static void round_trip(void)
+{
+    for (uint32_t id = 0; id < DLOG_COUNT; id++) {
+        uintptr_t arg[DLOG_MAX_ARGS] = {0};
+        uint32_t n = sample_args(id, arg);
+        char direct[sizeof(s_out)];
+        strcpy(direct, print(id, 0xFFFFFF00u + id, arg, n));
+
+        char line[192];
+        size_t len = dlog_encode(line, sizeof(line), id, 0xFFFFFF00u + id, arg, n);
+        CHECK(len > 0 && line[len - 1] == '\n' && strlen(line) == len);
+        dlog_line_t d;
+        CHECK(dlog_decode(line, &d));
+        CHECK_EQ(d.id, id);
+        CHECK_EQ(d.nargs, n);
+        CHECK(strcmp(print(d.id, d.ts_ms, d.arg, d.nargs), direct) == 0);
+
+        // cut anywhere: refused, never misread
+        for (size_t cut = 0; cut < len; cut++) {
+            char part[192];
+            memcpy(part, line, cut);
+            part[cut] = '\0';
+            CHECK(!dlog_decode(part, &d));
+        }
+        char tight[192];
+        CHECK_EQ(dlog_encode(tight, len + 1, id, 0xFFFFFF00u + id, arg, n), len);
+        CHECK_EQ(dlog_encode(tight, len, id, 0xFFFFFF00u + id, arg, n), 0);   // no room for the NUL
+    }
+}
+
+static void text_limits(void)
+{
+    static const char LONG[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    const uintptr_t a[2] = { 1, (uintptr_t)LONG };
+    char line[192];
+    CHECK(dlog_encode(line, sizeof(line), DLOG_DEAUTH_FAIL, 5, a, 2) > 0);
+    dlog_line_t d;
+    CHECK(dlog_decode(line, &d));
+    CHECK_EQ(strlen(d.str[1]), DLOG_STR_MAX);
+    CHECK(strncmp(d.str[1], LONG, DLOG_STR_MAX) == 0);
+
+    CHECK(!dlog_decode("#dlog 999 0\n", &d));                        // unknown id
+    CHECK(!dlog_decode("#dlog 1 0 1 2 3 4 5 6 7 8 9\n", &d));        // too many args
+    CHECK(!dlog_decode("#dlog 1 0 zz\n", &d));
+    CHECK(!dlog_decode("#dlog 1 0 1 s6\n", &d));                     // half a byte of text
+    CHECK(!dlog_decode("I (5) tk: STA connected\n", &d));
+    CHECK(dlog_decode("#dlog 0 10\r\n", &d) && d.nargs == 0 && d.ts_ms == 16);
+}
+
+void test_dlog(void)
+{
+    known_text();
+    round_trip();
+    text_limits();
+}
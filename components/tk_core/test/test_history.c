@@ -0,0 +1,219 @@
+// main/history.c on a RAM partition with NOR semantics: queries across months and a
+// reboot, a clock set back across a month boundary (the index stays monotonic and costs
+// one marker, the late days are still found), a ring that wrapped many times, the index
+// starting over when full, and queries from one thread while another appends.
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "fake_flash.h"
+#include "history.h"
+#include "tk_test.h"
+
+// A blank partition of `sectors` sectors, then boot
+static void fresh(uint32_t sectors)
+{
+    fake_flash_reset("history", sectors);
+    CHECK_EQ(history_init(), ESP_OK);
+}
+
+static esp_err_t put(uint32_t day_key, uint8_t user, int32_t worked)
+{
+    history_day_t d = { .day_key = day_key, .user = user, .flags = HISTORY_F_CHECKED_IN, .checkin_sod = 9 * 3600,
+                        .done_sod = -1, .worked = worked };
+    return history_append(&d);
+}
+
+typedef struct {
+    uint32_t n;
+    uint32_t last_day;
+    uint32_t sum_worked;
+} collect_t;
+
+static bool collect(const history_day_t *d, void *ctx)
+{
+    collect_t *c = ctx;
+    c->n++;
+    c->sum_worked += (uint32_t)d->worked;
+    c->last_day = d->day_key;
+    return true;
+}
+
+static collect_t query(uint32_t from, uint32_t to)
+{
+    collect_t c = {0};
+    CHECK_EQ(history_query(from, to, collect, &c), ESP_OK);
+    return c;
+}
+
+static uint32_t months(void)
+{
+    history_stats_t st;
+    history_get_stats(&st);
+    return st.months;
+}
+
+static void months_and_reboot(void)
+{
+    fresh(16);
+    // Jan..Mar 2024, two users a day
+    static const uint32_t dim[3] = { 31, 29, 31 };
+    for (uint32_t m = 0; m < 3; m++) {
+        for (uint32_t d = 1; d <= dim[m]; d++) {
+            for (uint8_t u = 0; u < 2; u++) CHECK_EQ(put(20240000 + (m + 1) * 100 + d, u, 1), ESP_OK);
+        }
+    }
+    CHECK_EQ(months(), 3);
+    CHECK_EQ(query(20240101, 20240131).n, 62);
+    CHECK_EQ(query(20240215, 20240305).n, 2 * (15 + 5));
+    CHECK_EQ(query(20240401, 20241231).n, 0);
+    CHECK_EQ(query(0, 99991231).n, 2 * 91);
+
+    history_stats_t before;
+    history_get_stats(&before);
+    CHECK_EQ(history_init(), ESP_OK);                     // reboot
+    history_stats_t after;
+    history_get_stats(&after);
+    CHECK_EQ(after.pos, before.pos);
+    CHECK_EQ(after.months, 3);
+    CHECK_EQ(query(20240301, 20240331).n, 62);
+    CHECK_EQ(fake_flash_bad_writes("history"), 0);
+}
+
+static void clock_set_back(void)
+{
+    fresh(16);
+    CHECK_EQ(put(20240130, 0, 1), ESP_OK);
+    CHECK_EQ(put(20240201, 0, 2), ESP_OK);
+    CHECK_EQ(months(), 2);
+    // the RTC goes back to January: one marker entry, however often it flips
+    for (int i = 0; i < 100; i++) {
+        CHECK_EQ(put(20240131, 0, 10), ESP_OK);
+        CHECK_EQ(put(20240202, 0, 20), ESP_OK);
+    }
+    CHECK_EQ(months(), 3);
+    collect_t jan = query(20240101, 20240131);
+    CHECK_EQ(jan.n, 101);
+    CHECK_EQ(jan.sum_worked, 1 + 100 * 10);
+    collect_t feb = query(20240201, 20240229);
+    CHECK_EQ(feb.n, 101);
+    CHECK_EQ(feb.sum_worked, 2 + 100 * 20);
+
+    // the marker survives a reboot: no second one for the same month
+    CHECK_EQ(history_init(), ESP_OK);
+    CHECK_EQ(put(20240115, 0, 1), ESP_OK);
+    CHECK_EQ(months(), 3);
+    CHECK_EQ(query(20240115, 20240115).n, 1);
+    // March starts a plain month; a late February day there marks March once
+    CHECK_EQ(put(20240301, 0, 1), ESP_OK);
+    CHECK_EQ(put(20240229, 0, 1), ESP_OK);
+    CHECK_EQ(put(20240228, 0, 1), ESP_OK);
+    CHECK_EQ(months(), 5);
+    CHECK_EQ(query(20240228, 20240229).n, 2);
+    CHECK_EQ(query(20240301, 20240331).n, 1);
+    CHECK_EQ(fake_flash_bad_writes("history"), 0);
+}
+
+static void ring_wraps(void)
+{
+    fresh(4);                                            // index + 3 data sectors: 384 records
+    history_stats_t st;
+    history_get_stats(&st);
+    CHECK_EQ(st.capacity, 384);
+    // 2000 days, one record each: only the newest 256..384 are still there
+    uint32_t dk = 20200101;
+    int32_t days = tk_days_from_civil(2020, 1, 1);
+    for (uint32_t i = 0; i < 2000; i++, days++) {
+        int32_t y; uint32_t m, d;
+        tk_civil_from_days(days, &y, &m, &d);
+        dk = (uint32_t)y * 10000 + m * 100 + d;
+        CHECK_EQ(put(dk, 0, 1), ESP_OK);
+    }
+    collect_t all = query(0, 99991231);
+    CHECK(all.n >= 256 && all.n <= 384);
+    CHECK_EQ(all.last_day, dk);
+    CHECK_EQ(history_init(), ESP_OK);
+    CHECK_EQ(query(0, 99991231).n, all.n);
+    CHECK_EQ(fake_flash_bad_writes("history"), 0);
+}
+
+static void index_full(void)
+{
+    fresh(8);
+    // 600 months, one record each: the index (512 entries) starts over once
+    for (uint32_t i = 0; i < 600; i++) {
+        uint32_t y = 2000 + i / 12, m = i % 12 + 1;
+        CHECK_EQ(put(y * 10000 + m * 100 + 1, 0, 1), ESP_OK);
+    }
+    CHECK_EQ(months(), 600 - 512);
+    CHECK_EQ(query(20490101, 20491231).n, 12);           // months 588..599
+    CHECK_EQ(history_init(), ESP_OK);
+    CHECK_EQ(months(), 600 - 512);
+    CHECK_EQ(query(20490101, 20491231).n, 12);
+}
+
+// ---- concurrent appends (owner task) and queries (httpd) ----
+typedef struct {
+    uint32_t   base, n;
+    atomic_int done;
+} writer_t;
+
+static void *writer(void *arg)
+{
+    writer_t *w = arg;
+    for (uint32_t i = 0; i < w->n; i++) {
+        uint32_t k = w->base + i;
+        (void)put(20240101 + k % 28, (uint8_t)(k & 7), (int32_t)k);
+    }
+    atomic_store(&w->done, 1);
+    return NULL;
+}
+
+typedef struct {
+    uint32_t n;
+    uint32_t bad;
+} check_t;
+
+static bool check_rec(const history_day_t *d, void *ctx)
+{
+    check_t *c = ctx;
+    c->n++;
+    // every record delivered is one the writer wrote, intact
+    c->bad += d->day_key < 20240101 || d->day_key > 20240128 || d->user != ((uint32_t)d->worked & 7) ||
+              20240101 + (uint32_t)d->worked % 28 != d->day_key;
+    return true;
+}
+
+static void concurrent(void)
+{
+    fresh(6);
+    static writer_t w = { .base = 0, .n = 20000 };
+    pthread_t th;
+    CHECK_EQ(pthread_create(&th, NULL, writer, &w), 0);
+    uint32_t queries = 0, bad = 0;
+    while (!atomic_load(&w.done)) {
+        check_t c = {0};
+        esp_err_t err = history_query(20240101, 20240131, check_rec, &c);
+        CHECK(err == ESP_OK);
+        bad += c.bad;
+        queries++;
+    }
+    pthread_join(th, NULL);
+    history_stats_t st;
+    history_get_stats(&st);
+    CHECK_EQ(st.pos, 20000);
+    CHECK_EQ(bad, 0);
+    CHECK(queries > 0);
+    CHECK_EQ(fake_flash_bad_writes("history"), 0);
+}
+
+void test_history(void)
+{
+    fake_flash_reset("history", 0);
+    CHECK_EQ(history_init(), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(put(20240101, 0, 0), ESP_ERR_INVALID_STATE);
+    months_and_reboot();
+    clock_set_back();
+    ring_wraps();
+    index_full();
+    concurrent();
+}
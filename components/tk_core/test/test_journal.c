@@ -0,0 +1,107 @@
+// main/journal.c on a RAM partition with NOR semantics: users' newest records across
+// many wraps and reboots, and flash left in a bad state by a torn erase (a sector whose
+// first slot is blank but a later one is not, ahead of the write pointer or in the tail
+// it resumes in at boot) must be erased, never programmed over.
+#include <stdlib.h>
+#include <string.h>
+#include "fake_flash.h"
+#include "journal.h"
+#include "tk_test.h"
+
+#define USERS 8
+#define REC   16              // bytes per record
+
+static journal_state_t s_model[USERS];
+static bool            s_have[USERS];
+
+static void boot(void)
+{
+    CHECK_EQ(journal_init(), ESP_OK);
+}
+
+// Boot on a blank partition (journal_init formats it); returns its bytes
+static uint8_t *fresh(uint32_t sectors)
+{
+    uint8_t *mem = fake_flash_reset("journal", sectors);
+    memset(s_have, 0, sizeof(s_have));
+    boot();
+    return mem;
+}
+
+static void put(uint8_t user, uint32_t day_key, int32_t remaining, uint8_t flags)
+{
+    journal_state_t st = { .user = user, .flags = flags, .day_key = day_key, .remaining = remaining };
+    CHECK_EQ(journal_append(&st), ESP_OK);
+    s_model[user] = st;
+    s_have[user] = true;
+}
+
+// Every user loads exactly what was last appended for them
+static void check_model(void)
+{
+    for (uint8_t u = 0; u < USERS; u++) {
+        journal_state_t st;
+        esp_err_t err = journal_load(u, &st);
+        if (!s_have[u]) { CHECK_EQ(err, ESP_ERR_NOT_FOUND); continue; }
+        CHECK_EQ(err, ESP_OK);
+        CHECK_EQ(st.day_key, s_model[u].day_key);
+        CHECK_EQ(st.remaining, s_model[u].remaining);
+        CHECK_EQ(st.flags, s_model[u].flags);
+    }
+}
+
+static void wraps_and_reboots(void)
+{
+    fresh(3);
+    check_model();
+    srand(7);
+    // 20000 appends over 768 slots (26 wraps); user 7 writes once and must be carried
+    put(7, 20240101, 1234, JOURNAL_FLAG_HAVE_MAC);
+    for (int32_t i = 0; i < 20000; i++) {
+        put((uint8_t)(rand() % (USERS - 1)), 20240102 + (uint32_t)i / 500, 30000 - i % 500, JOURNAL_FLAG_STARTED);
+        if (rand() % 400 == 0) { boot(); check_model(); }
+    }
+    boot();
+    check_model();
+    journal_stats_t st;
+    journal_get_stats(&st);
+    CHECK(st.carried > 0);
+    CHECK_EQ(st.users, USERS);
+    CHECK_EQ(fake_flash_bad_writes("journal"), 0);
+}
+
+// A stray programmed byte in sector 2, slot 7, with slot 0 blank: entering sector 2
+// has to erase it
+static void torn_ahead(void)
+{
+    uint8_t *mem = fresh(3);
+    mem[2 * 4096 + 7 * REC + 5] = 0x12;
+    for (int32_t i = 0; i < 2 * 256 + 40; i++) put((uint8_t)(i % USERS), 20240301, i, JOURNAL_FLAG_STARTED);
+    CHECK_EQ(fake_flash_bad_writes("journal"), 0);
+    boot();
+    check_model();
+}
+
+// The newest record is in slot 9 and slot 100 of the same sector is not blank: the
+// next boot resumes in the following sector instead of programming over slot 100
+static void torn_tail(void)
+{
+    uint8_t *mem = fresh(3);
+    for (int32_t i = 0; i < 10; i++) put((uint8_t)(i % USERS), 20240401, i, 0);
+    mem[100 * REC + 14] = mem[100 * REC + 15] = 0x00;       // where that record's CRC goes
+    boot();
+    check_model();
+    for (int32_t i = 0; i < 300; i++) put((uint8_t)(i % USERS), 20240402, i, 0);
+    CHECK_EQ(fake_flash_bad_writes("journal"), 0);
+    boot();
+    check_model();
+}
+
+void test_journal(void)
+{
+    fake_flash_reset("journal", 0);
+    CHECK_EQ(journal_init(), ESP_ERR_NOT_FOUND);
+    wraps_and_reboots();
+    torn_ahead();
+    torn_tail();
+}
@@ -0,0 +1,46 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "tk_test.h"
+
+int tk_test_failures;
+
+static const struct {
+    const char *name;
+    void (*run)(void);
+} SUITES[] = {
+    { "app", test_app },
+    { "civil", test_civil },
+    { "dlog", test_dlog },
+    { "history", test_history },
+    { "journal", test_journal },
+    { "policy", test_policy },
+    { "ratelimit", test_ratelimit },
+    { "replay", test_replay },
+    { "rssi", test_rssi },
+    { "seqlock", test_seqlock },
+    { "tm1637_wave", test_tm1637_wave },
+    { "users", test_users },
+};
+
+#define N_SUITES (sizeof(SUITES) / sizeof(SUITES[0]))
+
+// tk_core_tests [suite...]; no arguments runs them all
+int main(int argc, char **argv)
+{
+    int ran = 0;
+    for (size_t i = 0; i < N_SUITES; i++) {
+        bool want = (argc < 2);
+        for (int a = 1; a < argc && !want; a++) want = (strcmp(argv[a], SUITES[i].name) == 0);
+        if (!want) continue;
+        int before = tk_test_failures;
+        SUITES[i].run();
+        printf("%-10s %s\n", SUITES[i].name, tk_test_failures == before ? "ok" : "FAILED");
+        ran++;
+    }
+    if (!ran) {
+        fprintf(stderr, "no such suite\n");
+        return 2;
+    }
+    return tk_test_failures ? 1 : 0;
+}
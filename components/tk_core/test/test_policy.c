@@ -0,0 +1,67 @@
+// Connect policy dispatch (tk_policy_get/tk_config_resolve) against the decision logic
+// tk_core_on_connect() had inline before the table: all 96 combinations of deauth policy,
+// relearn flag, resolved or not, stored MAC, checked in, same or other MAC.
+#include <string.h>
+#include "tk_core.h"
+#include "tk_test.h"
+
+static tk_connect_t reference(tk_state_t *st, const tk_config_t *cfg, const uint8_t mac[6])
+{
+    tk_connect_t r = {0};
+    bool mac_matches = st->have_mac && memcmp(st->mac, mac, 6) == 0;
+    bool can_relearn = cfg->relearn_mac_daily && !st->started;
+    r.accepted = !st->have_mac || mac_matches || can_relearn;
+    if (!r.accepted) return r;
+    if (!st->have_mac || (!mac_matches && can_relearn)) {
+        memcpy(st->mac, mac, 6);
+        st->have_mac  = true;
+        r.mac_updated = true;
+    }
+    r.deauth = (cfg->deauth == TK_DEAUTH_ALWAYS) || (cfg->deauth == TK_DEAUTH_FIRST_CONNECT && !st->started);
+    if (!st->started) {
+        st->started  = true;
+        r.checked_in = true;
+    }
+    return r;
+}
+
+void test_policy(void)
+{
+    static const uint8_t A[6] = { 2, 0, 0, 0, 0, 1 }, B[6] = { 2, 0, 0, 0, 0, 2 };
+    int cases = 0;
+    for (int d = TK_DEAUTH_NONE; d <= TK_DEAUTH_ALWAYS; d++)
+    for (int relearn = 0; relearn < 2; relearn++)
+    for (int resolved = 0; resolved < 2; resolved++)
+    for (int have = 0; have < 2; have++)
+    for (int started = 0; started < 2; started++)
+    for (int same = 0; same < 2; same++) {
+        tk_config_t cfg = { .daily_target_sec = 100, .max_tick_delta_sec = 60,
+                            .relearn_mac_daily = relearn, .deauth = (tk_deauth_policy_t)d };
+        if (resolved) tk_config_resolve(&cfg);
+        tk_state_t a;
+        tk_core_init(&a, &cfg);
+        a.have_mac = have;
+        a.started  = started;
+        if (have) memcpy(a.mac, A, 6);
+        tk_state_t b = a;
+
+        const uint8_t *m = same ? A : B;
+        tk_connect_t x = tk_core_on_connect(&a, &cfg, m, 1000), y = reference(&b, &cfg, m);
+        CHECK_EQ(x.accepted, y.accepted);
+        CHECK_EQ(x.mac_updated, y.mac_updated);
+        CHECK_EQ(x.checked_in, y.checked_in);
+        CHECK_EQ(x.deauth, y.deauth);
+        CHECK_EQ(a.have_mac, b.have_mac);
+        CHECK(memcmp(a.mac, b.mac, 6) == 0);
+        CHECK_EQ(a.started, b.started);
+        cases++;
+    }
+    CHECK_EQ(cases, 96);
+
+    // out-of-range policy values (e.g. a corrupt NVS override) act as NONE
+    CHECK(tk_policy_get((tk_deauth_policy_t)7, true)  == tk_policy_get(TK_DEAUTH_NONE, true));
+    CHECK(tk_policy_get((tk_deauth_policy_t)-1, false) == tk_policy_get(TK_DEAUTH_NONE, false));
+    tk_config_t cfg = { .deauth = TK_DEAUTH_ALWAYS, .relearn_mac_daily = true };
+    tk_config_resolve(&cfg);
+    CHECK(cfg.policy == tk_policy_get(TK_DEAUTH_ALWAYS, true));
+}
@@ -0,0 +1,115 @@
+// tk_ratelimit across the ms-clock wrap: a single MAC in a reconnect storm, a flood of
+// spoofed MACs (the enrolled phone still gets through; however much the flood churns the
+// table, a storming MAC keeps its back-off and a dry one its empty bucket), and an
+// enrolled MAC under its own bucket when it is the one being spoofed.
+#include <stdlib.h>
+#include <string.h>
+#include "tk_ratelimit.h"
+#include "tk_test.h"
+
+static const tk_rl_config_t CFG = {
+    .burst = 4, .refill_ms = 15000, .backoff_ms = 30000, .backoff_max_ms = 900000,
+    .global_burst = 16, .global_refill_ms = 1000,
+};
+
+static tk_rl_t s_rl;
+
+// Connect attempts every `every_ms` for `n` tries; returns how many passed
+static int storm(tk_rl_t *rl, const uint8_t mac[6], bool enrolled, uint32_t *t, uint32_t every_ms, int n)
+{
+    int pass = 0;
+    for (int i = 0; i < n; i++) {
+        *t += every_ms;
+        if (tk_rl_connect(rl, &CFG, mac, enrolled, *t) == TK_RL_PASS) {
+            pass++;
+        } else {
+            CHECK(tk_rl_disconnect(rl, mac));        // its disconnect is dropped with it
+        }
+    }
+    return pass;
+}
+
+static void one_mac(void)
+{
+    static const uint8_t M[6] = { 2, 1, 1, 1, 1, 1 };
+    uint32_t t = 0xFFFF0000u;                       // the clock wraps a minute in
+    tk_rl_init(&s_rl, &CFG, t);
+
+    // an hour of reconnecting every 2 s: the burst, then back-offs doubling up to 15 min
+    int pass = storm(&s_rl, M, false, &t, 2000, 1800);
+    CHECK(pass >= 4 && pass < 16);
+    CHECK(s_rl.dropped[TK_RL_DROP_BACKOFF] > s_rl.dropped[TK_RL_DROP_RATE]);
+    CHECK_EQ(s_rl.dropped[TK_RL_PASS], 0);
+    CHECK_EQ(s_rl.dropped_disconnects, 1800 - pass);
+    CHECK_EQ(tk_rl_dropped(&s_rl), 2 * (1800 - pass));
+
+    // quiet for an hour: forgiven, the full burst passes and nothing is held back
+    t += 3600000;
+    for (uint32_t i = 0; i < CFG.burst; i++) CHECK_EQ(tk_rl_connect(&s_rl, &CFG, M, false, t + i), TK_RL_PASS);
+    CHECK(!tk_rl_disconnect(&s_rl, M));
+}
+
+static void flood(void)
+{
+    static const uint8_t STORM[6] = { 2, 1, 1, 1, 1, 1 };
+    static const uint8_t PHONE[6] = { 2, 9, 9, 9, 9, 9 };
+    static const uint8_t DRY[6]   = { 2, 5, 5, 5, 5, 5 };
+    uint32_t t = 1000;
+    tk_rl_init(&s_rl, &CFG, t);
+
+    // STORM is deep into its back-off; DRY has just spent its burst (no strike yet)
+    storm(&s_rl, STORM, false, &t, 2000, 300);
+    const tk_rl_entry_t *se = NULL;
+    for (uint32_t i = 0; i < TK_RL_SLOTS; i++) if (s_rl.e[i].key == 0x020101010101ULL) se = &s_rl.e[i];
+    CHECK(se && se->strikes >= 4);
+    uint8_t strikes = se ? se->strikes : 0;
+    CHECK_EQ(storm(&s_rl, DRY, false, &t, 10, CFG.burst), CFG.burst);
+
+    // 10000 spoofed MACs in 10 s, PHONE connecting twice a second in the middle of it
+    srand(3);
+    int flood_pass = 0, phone_pass = 0, phone_tries = 0;
+    for (int i = 0; i < 10000; i++) {
+        uint8_t r[6];
+        for (int b = 0; b < 6; b++) r[b] = (uint8_t)rand();
+        r[0] &= 0xFE;
+        t += 1;
+        flood_pass += tk_rl_connect(&s_rl, &CFG, r, false, t) == TK_RL_PASS;
+        if (i % 500 == 250 && phone_tries < CFG.burst) {
+            phone_tries++;
+            phone_pass += tk_rl_connect(&s_rl, &CFG, PHONE, true, t) == TK_RL_PASS;
+        }
+    }
+    CHECK(flood_pass <= 16 + 10 + 1);                 // the global bucket held
+    CHECK_EQ(phone_pass, phone_tries);                // ...and did not lock the phone out
+    CHECK(s_rl.dropped[TK_RL_DROP_GLOBAL] > 9000);
+
+    // the flood could not recycle STORM's entry: still backing off, with its strikes
+    CHECK_EQ(tk_rl_connect(&s_rl, &CFG, STORM, false, t + 1), TK_RL_DROP_BACKOFF);
+    bool found = false;
+    for (uint32_t i = 0; i < TK_RL_SLOTS; i++) {
+        if (s_rl.e[i].key == 0x020101010101ULL) { found = true; CHECK_EQ(s_rl.e[i].strikes, strikes); }
+    }
+    CHECK(found);
+    // nor hand DRY a fresh bucket: its next connect is its first strike
+    CHECK_EQ(tk_rl_connect(&s_rl, &CFG, DRY, false, t + 1), TK_RL_DROP_RATE);
+    CHECK(s_rl.untracked > 0);
+}
+
+static void spoofed_enrolled(void)
+{
+    static const uint8_t PHONE[6] = { 2, 9, 9, 9, 9, 9 };
+    uint32_t t = 5000;
+    tk_rl_init(&s_rl, &CFG, t);
+    // someone replays the enrolled MAC in a loop: its own bucket and back-off still apply,
+    // and the global bucket is left for everyone else
+    int pass = storm(&s_rl, PHONE, true, &t, 100, 6000);
+    CHECK(pass < 16);
+    CHECK_EQ(s_rl.g_tokens, CFG.global_burst);
+}
+
+void test_ratelimit(void)
+{
+    one_mac();
+    flood();
+    spoofed_enrolled();
+}
@@ -0,0 +1,91 @@
+// Replay harness as a regression: 120 scripted days in poll and SQW mode, one phone and
+// several (by association and by signal); skipping quiet seconds changes nothing
+#include <string.h>
+#include "tk_replay.h"
+#include "tk_test.h"
+
+static tk_sim_t s_sim, s_ref;
+
+typedef struct {
+    uint32_t resync_sec;
+    uint32_t users;
+} bounds_t;
+
+// Per-day cost bounds
+static void check_day(const tk_replay_day_t *d, void *ctx)
+{
+    const bounds_t *b = ctx;
+    // the loop renders once per second, plus once at boot
+    CHECK(d->frames >= 86400 - 1 && d->frames <= 86400 + 1);
+    // a check-in day saves on check-in, each pause/resume, done and the rollover, plus at
+    // most one periodic save per 15 min while counting; MAC writes only on check-in days
+    CHECK(d->nvs_writes <= b->users * (1 + 4 + 2 * 2 + 86400 / 900));
+    // polling reads the RTC every second; SQW only on resync, the day change and boot.
+    // Failed reads are retried every second until one succeeds.
+    if (d->rtc_fail)          CHECK(d->i2c_xfers <= 86400 + 1);
+    else if (!b->resync_sec)  CHECK(d->i2c_xfers >= 86400 - 1 && d->i2c_xfers <= 86400 + 1);
+    else                      CHECK(d->i2c_xfers <= 86400 / b->resync_sec + 3);
+    CHECK(d->done <= d->checked_in);
+}
+
+static void replay(uint32_t resync_sec, uint32_t seed, uint32_t users)
+{
+    tk_replay_config_t c;
+    tk_replay_default_config(&c);
+    c.days           = 120;
+    c.seed           = seed;
+    c.rtc_resync_sec = resync_sec;
+    c.users          = (uint8_t)users;
+    // more faults than the defaults, so every kind shows up in 120 days
+    c.reboot_pct = c.rtc_fail_pct = c.jump_pct = 20;
+
+    bounds_t b = { resync_sec, users };
+    tk_replay_report_t r;
+    CHECK(tk_replay_run(&s_sim, &c, &r, check_day, &b));
+    CHECK_EQ(r.violations, 0);
+    CHECK(r.checkins > 80 * users && r.reboots > 0 && r.rtc_fail_days > 0 && r.jumps > 0);
+    // plain days reach the target; a reboot or fault costs at most minutes, not the day
+    CHECK(r.done >= r.checkins * 9 / 10);
+    CHECK_EQ(r.total.frames, (uint64_t)c.days * 86400 - 1 + r.reboots);   // day 1 starts after its boot frame
+    CHECK_EQ(s_sim.app.users.n, users);
+    printf("replay: %u phones, %u days, %.0f days/s, i2c/day %.1f, nvs/day %.1f\n", (unsigned)users,
+           (unsigned)r.days, r.days_per_sec, (double)r.total.i2c_xfers / r.days,
+           (double)r.total.nvs_writes / r.days);
+}
+
+// The same script second by second: identical users, store and traffic
+static void skip_is_exact(uint32_t resync_sec, uint32_t users)
+{
+    tk_replay_config_t c;
+    tk_replay_default_config(&c);
+    c.days           = 60;
+    c.seed           = 3;
+    c.rtc_resync_sec = resync_sec;
+    c.users          = (uint8_t)users;
+    c.reboot_pct = c.rtc_fail_pct = c.jump_pct = 20;
+
+    tk_replay_report_t fast, ref;
+    CHECK(tk_replay_run(&s_sim, &c, &fast, NULL, NULL));
+    c.every_second = true;
+    CHECK(tk_replay_run(&s_ref, &c, &ref, NULL, NULL));
+    CHECK(fast.skipped > (uint64_t)c.days * 86400 * 9 / 10);
+    CHECK_EQ(ref.skipped, 0);
+    CHECK_EQ(fast.ticks + fast.skipped, ref.ticks);
+    CHECK(memcmp(&fast.total, &ref.total, sizeof(fast.total)) == 0);
+    CHECK(memcmp(&fast.max, &ref.max, sizeof(fast.max)) == 0);
+    CHECK_EQ(fast.done, ref.done);
+    CHECK(memcmp(&s_sim.store, &s_ref.store, sizeof(s_sim.store)) == 0);
+    CHECK_EQ(s_sim.disp.bytes, s_ref.disp.bytes);
+    CHECK(memcmp(s_sim.disp.shadow, s_ref.disp.shadow, 4) == 0);
+    CHECK(memcmp(s_sim.app.users.user, s_ref.app.users.user, sizeof(s_sim.app.users.user)) == 0);
+    CHECK(memcmp(s_sim.app.users.sess, s_ref.app.users.sess, sizeof(s_sim.app.users.sess)) == 0);
+}
+
+void test_replay(void)
+{
+    replay(0, 1, 1);
+    replay(3600, 7, 1);
+    replay(3600, 5, 8);
+    skip_is_exact(0, 4);
+    skip_is_exact(3600, 4);
+}
@@ -0,0 +1,115 @@
+// tk_rssi: the Q8 EWMA, no near decision before min_samples, hysteresis exactly at the
+// enter and leave thresholds, and a stale series ending far (or just gone) on a
+// wrapping clock.
+#include "tk_rssi.h"
+#include "tk_test.h"
+
+static const tk_rssi_config_t CFG = { .enter_dbm = -60, .leave_dbm = -70, .shift = 2, .min_samples = 3 };
+
+// Feed dbm every second from *t until a transition or n samples; returns it and the count
+static int feed(tk_rssi_t *r, int8_t dbm, uint32_t *t, int n, int *used)
+{
+    for (int i = 1; i <= n; i++) {
+        *t += 1000;
+        int tr = tk_rssi_update(r, &CFG, dbm, *t);
+        if (tr) { *used = i; return tr; }
+    }
+    *used = n;
+    return 0;
+}
+
+static void ewma(void)
+{
+    tk_rssi_t r;
+    tk_rssi_reset(&r);
+    CHECK_EQ(tk_rssi_update(&r, &CFG, -50, 0), 0);       // seeds
+    CHECK_EQ(tk_rssi_dbm(&r), -50);
+    CHECK_EQ(tk_rssi_update(&r, &CFG, -90, 1000), 0);    // a quarter of the step
+    CHECK_EQ(r.avg_q8, -60 * 256);
+    CHECK_EQ(r.samples, 2);
+    CHECK_EQ(r.last_ms, 1000);
+}
+
+static void min_samples(void)
+{
+    tk_rssi_t r;
+    uint32_t t = 0;
+    int used;
+    tk_rssi_reset(&r);
+    // strong from the first sample, but near only on the third
+    CHECK_EQ(feed(&r, -30, &t, 10, &used), TK_RSSI_NEAR);
+    CHECK_EQ(used, CFG.min_samples);
+    CHECK(r.near);
+    CHECK_EQ(feed(&r, -30, &t, 100, &used), 0);           // no repeats while near
+}
+
+static void hysteresis(void)
+{
+    tk_rssi_t r;
+    uint32_t t = 0;
+    int used;
+
+    // enter: exactly at enter_dbm is near, one below never is
+    tk_rssi_reset(&r);
+    CHECK_EQ(feed(&r, -60, &t, 10, &used), TK_RSSI_NEAR);
+    CHECK_EQ(used, 3);
+    tk_rssi_reset(&r);
+    CHECK_EQ(feed(&r, -61, &t, 1000, &used), 0);
+    CHECK(!r.near);
+
+    // between the thresholds a near phone stays near, however long
+    tk_rssi_reset(&r);
+    CHECK_EQ(feed(&r, -50, &t, 10, &used), TK_RSSI_NEAR);
+    CHECK_EQ(feed(&r, -65, &t, 1000, &used), 0);
+    // exactly at leave_dbm is still near (the mean settles on it), one below goes far
+    CHECK_EQ(feed(&r, -70, &t, 1000, &used), 0);
+    CHECK_EQ(r.avg_q8, -70 * 256);
+    CHECK(r.near);
+    CHECK_EQ(feed(&r, -71, &t, 1000, &used), TK_RSSI_FAR);
+    CHECK_EQ(used, 1);                                    // any step below leave crosses at once
+    CHECK(!r.near);
+    // and back in the band: stays far until the mean reaches enter_dbm again. Rising, the
+    // shift rounds down and the mean stops just short of the sample, so -60 is not enough.
+    CHECK_EQ(feed(&r, -65, &t, 1000, &used), 0);
+    CHECK_EQ(feed(&r, -60, &t, 1000, &used), 0);
+    CHECK_EQ(r.avg_q8, -60 * 256 - 3);
+    CHECK_EQ(feed(&r, -59, &t, 1000, &used), TK_RSSI_NEAR);
+
+    // one strong frame in a weak series moves the mean a quarter of the way only
+    tk_rssi_reset(&r);
+    CHECK_EQ(feed(&r, -76, &t, 10, &used), 0);
+    CHECK_EQ(tk_rssi_update(&r, &CFG, -40, t += 1000), 0);
+    CHECK_EQ(r.avg_q8, -67 * 256);
+}
+
+static void stale(void)
+{
+    tk_rssi_t r;
+    uint32_t t = 0xFFFFFFFFu - 1500;                     // the clock wraps in the middle
+    int used;
+    tk_rssi_reset(&r);
+    CHECK_EQ(tk_rssi_expire(&r, t, 120000), 0);           // nothing to expire
+    CHECK_EQ(feed(&r, -50, &t, 10, &used), TK_RSSI_NEAR);
+    CHECK_EQ(tk_rssi_expire(&r, t + 120000, 120000), 0);  // not yet
+    CHECK(r.near);
+    CHECK_EQ(tk_rssi_expire(&r, t + 120001, 120000), TK_RSSI_FAR);
+    CHECK(!r.near);
+    CHECK_EQ(r.samples, 0);
+    CHECK_EQ(tk_rssi_expire(&r, t + 240002, 120000), 0);  // once only
+
+    // a far series just goes; the next sample starts a fresh one
+    CHECK_EQ(feed(&r, -80, &t, 5, &used), 0);
+    CHECK_EQ(tk_rssi_expire(&r, t + 120001, 120000), TK_RSSI_GONE);
+    t += 120001;
+    CHECK_EQ(tk_rssi_update(&r, &CFG, -50, t), 0);
+    CHECK_EQ(tk_rssi_dbm(&r), -50);
+    CHECK_EQ(r.samples, 1);
+}
+
+void test_rssi(void)
+{
+    ewma();
+    min_samples();
+    hysteresis();
+    stale();
+}
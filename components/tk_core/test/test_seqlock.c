@@ -0,0 +1,152 @@
+// Concurrency stress for tk_seqlock and main/event_ring.c on real threads. Build with
+// -DTK_TSAN=ON to run it under ThreadSanitizer (the payload words are C11 atomics, so a
+// reader overlapping the writer is not a data race).
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include "event_ring.h"
+#include "tk_seqlock.h"
+#include "tk_test.h"
+
+#define WRITES 200000
+#define EVENTS 500000
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// ---- seqlock: every field of a payload carries the write number ----
+typedef struct {
+    uint32_t a[300];
+    uint8_t  tail[3];                  // odd size: the last word is partial
+} payload_t;
+
+static _Atomic uint32_t s_words[TK_SEQLOCK_WORDS(sizeof(payload_t))];
+static tk_seqlock_t     s_sl;
+static atomic_bool      s_writer_done;
+
+static void *writer(void *arg)
+{
+    (void)arg;
+    static payload_t p;
+    for (uint32_t k = 1; k <= WRITES; k++) {
+        for (int i = 0; i < 300; i++) p.a[i] = k;
+        p.tail[0] = p.tail[1] = p.tail[2] = (uint8_t)k;
+        tk_seqlock_write(&s_sl, &p);
+        if (!(k & 63)) sched_yield();
+    }
+    atomic_store(&s_writer_done, true);
+    return NULL;
+}
+
+typedef struct {
+    uint32_t ok, gave_up, torn, backwards;
+} reader_stats_t;
+
+static void *reader(void *arg)
+{
+    reader_stats_t *rs = arg;
+    static _Thread_local payload_t p;
+    uint32_t last = 0;
+    while (!atomic_load(&s_writer_done)) {
+        if (!tk_seqlock_read(&s_sl, &p, 4)) { rs->gave_up++; continue; }
+        rs->ok++;
+        bool torn = false;
+        for (int i = 1; i < 300; i++) torn |= (p.a[i] != p.a[0]);
+        for (int i = 0; i < 3; i++) torn |= (p.tail[i] != (uint8_t)p.a[0]);
+        rs->torn += torn;
+        rs->backwards += (p.a[0] < last);
+        last = p.a[0];
+    }
+    return NULL;
+}
+
+static void seqlock_stress(void)
+{
+    tk_seqlock_init(&s_sl, s_words, sizeof(payload_t));
+    atomic_store(&s_writer_done, false);
+    static payload_t p;
+    CHECK(!tk_seqlock_version(&s_sl));
+    CHECK(tk_seqlock_read(&s_sl, &p, 1));            // all zero before the first write
+
+    pthread_t w, r[2];
+    reader_stats_t rs[2] = {{0}};
+    pthread_create(&r[0], NULL, reader, &rs[0]);
+    pthread_create(&r[1], NULL, reader, &rs[1]);
+    pthread_create(&w, NULL, writer, NULL);
+    pthread_join(w, NULL);
+    pthread_join(r[0], NULL);
+    pthread_join(r[1], NULL);
+
+    CHECK_EQ(tk_seqlock_version(&s_sl), WRITES);
+    for (int i = 0; i < 2; i++) {
+        CHECK_EQ(rs[i].torn, 0);
+        CHECK_EQ(rs[i].backwards, 0);
+        CHECK(rs[i].ok > 0);
+    }
+    CHECK(tk_seqlock_read(&s_sl, &p, 1));
+    CHECK_EQ(p.a[0], WRITES);
+    printf("seqlock: %u/%u consistent reads, %u/%u gave up\n", (unsigned)rs[0].ok, (unsigned)rs[1].ok,
+           (unsigned)rs[0].gave_up, (unsigned)rs[1].gave_up);
+}
+
+// ---- event ring: in order, nothing lost or duplicated, full ring refuses ----
+static void *producer(void *arg)
+{
+    (void)arg;
+    for (uint32_t k = 0; k < EVENTS; ) {
+        tk_evt_t ev = { .type = TK_EVT_PRESENCE, .ts_us = esp_timer_get_time() };
+        memcpy(ev.mac, &k, sizeof(k));
+        ev.aid = (uint16_t)k;
+        if (event_ring_push(&ev)) k++;
+        else sched_yield();
+    }
+    return NULL;
+}
+
+static void ring_stress(void)
+{
+    pthread_t p;
+    pthread_create(&p, NULL, producer, NULL);
+    uint32_t next = 0, bad = 0;
+    while (next < EVENTS) {
+        tk_evt_t ev;
+        if (!event_ring_pop(&ev)) { sched_yield(); continue; }
+        uint32_t k;
+        memcpy(&k, ev.mac, sizeof(k));
+        bad += (k != next) || (ev.aid != (uint16_t)k) || (ev.type != TK_EVT_PRESENCE);
+        next++;
+    }
+    pthread_join(p, NULL);
+    tk_evt_t ev;
+    CHECK(!event_ring_pop(&ev));
+    CHECK_EQ(bad, 0);
+
+    event_ring_stats_t st;
+    event_ring_get_stats(&st);
+    CHECK_EQ(st.pushed, EVENTS);
+    CHECK_EQ(st.popped, EVENTS);
+    CHECK_EQ(st.depth, 0);
+    CHECK(st.depth_hwm <= EVENT_RING_DEPTH);
+
+    // single-threaded: exactly EVENT_RING_DEPTH fit
+    tk_evt_t e = { .type = TK_EVT_STA_CONNECTED, .ts_us = esp_timer_get_time() };
+    int pushed = 0;
+    while (event_ring_push(&e)) pushed++;
+    CHECK_EQ(pushed, EVENT_RING_DEPTH);
+    while (event_ring_pop(&e)) pushed--;
+    CHECK_EQ(pushed, 0);
+    printf("ring: %u events in order, %u refused while full, depth hwm %u/%d\n", (unsigned)EVENTS,
+           (unsigned)st.dropped, (unsigned)st.depth_hwm, EVENT_RING_DEPTH);
+}
+
+void test_seqlock(void)
+{
+    seqlock_stress();
+    ring_stress();
+}
@@ -0,0 +1,165 @@
+// main/tm1637_wave.c against the bit-bang timing in main/tm1637.c: the encoded CLK/DIO
+// runs must match, microsecond for microsecond, what start()/write_byte()/stop() drive,
+// and the ACK sampling must recover every NACK pattern from a loopback capture.
+#include <string.h>
+#include "tm1637_wave.h"
+#include "tk_test.h"
+
+#define T_MAX 4096
+
+// ---- Reference: tm1637.c's bus primitives on a 1 µs timeline ----
+typedef struct {
+    uint8_t  clk[T_MAX], dio[T_MAX];
+    uint8_t  dev_low[T_MAX];         // the chip pulls DIO low (its ACK window)
+    uint32_t t;
+    uint8_t  clk_lvl, dio_lvl, dio_latch;
+    bool     dio_in;
+    uint16_t ack_at[TM1637_WAVE_MAX_ACKS];
+    int      n_acks;
+    bool     acking;
+} ref_t;
+
+static void wr_clk(ref_t *r, int v) { r->clk_lvl = (uint8_t)v; }
+static void wr_dio(ref_t *r, int v) { r->dio_latch = (uint8_t)v; if (!r->dio_in) r->dio_lvl = (uint8_t)v; }
+static void as_in(ref_t *r)  { r->dio_in = true; r->dio_lvl = 1; }                 // pulled up
+static void as_out(ref_t *r) { r->dio_in = false; r->dio_lvl = r->dio_latch; }
+
+static void dly_us(ref_t *r, int us)
+{
+    for (int i = 0; i < us && r->t < T_MAX; i++, r->t++) {
+        r->clk[r->t]     = r->clk_lvl;
+        r->dio[r->t]     = r->dio_lvl;
+        r->dev_low[r->t] = r->acking;
+    }
+}
+
+static void ref_start(ref_t *r)
+{
+    wr_dio(r, 1); wr_clk(r, 1); dly_us(r, TM1637_T_START_US);
+    wr_dio(r, 0); dly_us(r, TM1637_T_START_US);
+    wr_clk(r, 0); dly_us(r, TM1637_T_START_US);
+}
+
+static void ref_stop(ref_t *r)
+{
+    wr_clk(r, 0); dly_us(r, TM1637_T_START_US);
+    wr_dio(r, 0); dly_us(r, TM1637_T_START_US);
+    wr_clk(r, 1); dly_us(r, TM1637_T_START_US);
+    wr_dio(r, 1); dly_us(r, TM1637_T_START_US);
+}
+
+static void ref_byte(ref_t *r, uint8_t b)
+{
+    for (int i = 0; i < 8; i++) {
+        wr_clk(r, 0); dly_us(r, TM1637_T_BIT_US);
+        wr_dio(r, b & 0x01); dly_us(r, TM1637_T_BIT_US);
+        wr_clk(r, 1); dly_us(r, TM1637_T_BIT_US);
+        b >>= 1;
+    }
+    // the chip drives its ACK from the 8th falling edge to the 9th
+    wr_clk(r, 0); r->acking = true; dly_us(r, TM1637_T_ACK_US);
+    as_in(r); dly_us(r, TM1637_T_ACK_US);
+    wr_clk(r, 1); dly_us(r, TM1637_T_BIT_US);
+    r->ack_at[r->n_acks++] = (uint16_t)(r->t - 1);     // gpio_get_level() just before CLK falls
+    wr_clk(r, 0); r->acking = false; dly_us(r, TM1637_T_ACK_US);
+    as_out(r);
+}
+
+static void ref_frame(ref_t *r, const tm1637_bus_frame_t *f)
+{
+    memset(r, 0, sizeof(*r));
+    r->clk_lvl = r->dio_lvl = r->dio_latch = 1;        // idle bus
+    for (int x = 0; x < f->n_xfers; x++) {
+        ref_start(r);
+        for (int i = 0; i < f->len[x]; i++) ref_byte(r, f->data[x][i]);
+        ref_stop(r);
+    }
+}
+
+// Runs -> per-µs levels; returns the total length
+static uint32_t expand(const tm1637_wave_run_t *runs, int n, uint8_t *out)
+{
+    uint32_t t = 0;
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < runs[i].dur_us && t < T_MAX; k++) out[t++] = runs[i].level;
+    }
+    return t;
+}
+
+static ref_t         s_ref;
+static tm1637_wave_t s_wave;
+
+static void check_frame(const tm1637_bus_frame_t *f)
+{
+    static uint8_t clk[T_MAX], dio[T_MAX];
+    ref_frame(&s_ref, f);
+    CHECK(tm1637_wave_encode(f, &s_wave));
+    CHECK_EQ(s_wave.total_us, s_ref.t);
+    CHECK_EQ(expand(s_wave.clk, s_wave.n_clk, clk), s_ref.t);
+    CHECK_EQ(expand(s_wave.dio, s_wave.n_dio, dio), s_ref.t);
+    CHECK(memcmp(clk, s_ref.clk, s_ref.t) == 0);
+    CHECK(memcmp(dio, s_ref.dio, s_ref.t) == 0);
+    CHECK_EQ(s_wave.n_acks, s_ref.n_acks);
+    for (int a = 0; a < s_ref.n_acks; a++) CHECK_EQ(s_wave.ack_at_us[a], s_ref.ack_at[a]);
+
+    // Loopback capture: the chip ACKs every byte except those in `nack`; the RMT receiver
+    // starts at the first DIO edge (the start condition)
+    int nb = s_ref.n_acks;
+    for (uint32_t nack = 0; nack < (1u << nb); nack++) {
+        static uint8_t line[T_MAX];
+        int a = -1;
+        for (uint32_t t = 0; t < s_ref.t; t++) {
+            if (s_ref.dev_low[t] && (t == 0 || !s_ref.dev_low[t - 1])) a++;
+            bool pulled = s_ref.dev_low[t] && !(nack & (1u << a));
+            line[t] = pulled ? 0 : s_ref.dio[t];
+        }
+        uint32_t t0 = 0;
+        while (t0 < s_ref.t && line[t0]) t0++;
+        CHECK_EQ(t0, s_wave.dio[0].dur_us);
+        static tm1637_wave_run_t rx[T_MAX];
+        size_t n = 0;
+        for (uint32_t t = t0; t < s_ref.t; t++) {
+            if (n && rx[n - 1].level == line[t]) rx[n - 1].dur_us++;
+            else rx[n++] = (tm1637_wave_run_t){ line[t], 1 };
+        }
+        CHECK_EQ(tm1637_wave_nack_mask(&s_wave, rx, n, t0), nack);
+        // a capture cut short: the bytes after it read as idle-high (NACK)
+        uint32_t all = (1u << nb) - 1;
+        CHECK_EQ(tm1637_wave_nack_mask(&s_wave, rx, 0, t0), all);
+    }
+}
+
+void test_tm1637_wave(void)
+{
+    uint32_t seed = 12345;
+    // Every frame show4()/set_brightness() can produce, with varied segment bytes
+    for (int round = 0; round < 8; round++) {
+        uint8_t seg[4];
+        for (int i = 0; i < 4; i++) { seed = seed * 1103515245u + 12345u; seg[i] = (uint8_t)(seed >> 16); }
+
+        for (int i = 0; i < 4; i++) {                        // one digit: fixed address
+            tm1637_bus_frame_t f = { .n_xfers = 2, .len = { 1, 2 },
+                                     .data = { { 0x44 }, { (uint8_t)(0xC0 | i), seg[i] } } };
+            check_frame(&f);
+        }
+        for (int first = 0; first < 4; first++) {            // dirty span: auto-increment
+            for (int last = first + 1; last < 4; last++) {
+                tm1637_bus_frame_t f = { .n_xfers = 2, .len = { 1, 1 }, .data = { { 0x40 }, { (uint8_t)(0xC0 | first) } } };
+                for (int i = first; i <= last; i++) f.data[1][f.len[1]++] = seg[i];
+                check_frame(&f);
+            }
+        }
+        tm1637_bus_frame_t b = { .n_xfers = 1, .len = { 1 }, .data = { { (uint8_t)(0x88 | (round & 7)) } } };
+        check_frame(&b);
+    }
+
+    // Malformed frames are refused
+    tm1637_bus_frame_t bad = { .n_xfers = 0 };
+    CHECK(!tm1637_wave_encode(&bad, &s_wave));
+    bad.n_xfers = TM1637_WAVE_MAX_XFERS + 1;
+    CHECK(!tm1637_wave_encode(&bad, &s_wave));
+    bad = (tm1637_bus_frame_t){ .n_xfers = 1, .len = { 0 } };
+    CHECK(!tm1637_wave_encode(&bad, &s_wave));
+    bad.len[0] = TM1637_WAVE_MAX_BYTES + 1;
+    CHECK(!tm1637_wave_encode(&bad, &s_wave));
+}
@@ -0,0 +1,135 @@
+// tk_users: enrollment up to capacity, the MAC index after removal (the last user moves
+// into the hole), and idle eviction on a full table (oldest check-in first, never a user
+// checked in today or one with no known check-in).
+#include <string.h>
+#include "tk_users.h"
+#include "tk_test.h"
+
+static const tk_config_t CFG = {
+    .daily_target_sec   = 3600,
+    .max_tick_delta_sec = 60,
+    .deauth             = TK_DEAUTH_FIRST_CONNECT,
+    .evict_idle_days    = 30,
+};
+
+static tk_users_t s_t;
+
+static void mac_of(uint8_t m[6], uint32_t i)
+{
+    const uint8_t b[6] = { 0x02, 0x00, 0x00, 0x00, (uint8_t)(i >> 8), (uint8_t)i };
+    memcpy(m, b, 6);
+}
+
+static int connect(tk_users_t *t, const tk_config_t *cfg, uint32_t i, uint32_t today, tk_connect_t *c)
+{
+    uint8_t m[6];
+    mac_of(m, i);
+    int u = -2;
+    *c = tk_users_on_connect(t, cfg, m, today, 1000, &u);
+    return u;
+}
+
+// Every user's MAC finds its own slot, and the index holds nothing else
+static void index_ok(const tk_users_t *t)
+{
+    uint32_t keys = 0;
+    for (uint32_t k = 0; k < TK_USERS_SLOTS; k++) keys += t->key[k] != 0;
+    CHECK_EQ(keys, t->n);
+    for (uint32_t u = 0; u < t->n; u++) CHECK_EQ(tk_users_find(t, t->user[u].mac), u);
+}
+
+static void end_day(tk_users_t *t, uint32_t day)
+{
+    tk_users_set_day(t, &CFG, day);
+}
+
+static void enroll_and_remove(void)
+{
+    tk_users_t *t = &s_t;
+    tk_users_init(t, 4);
+    tk_connect_t c;
+    for (uint32_t i = 0; i < 4; i++) {
+        CHECK_EQ(connect(t, &CFG, i, 20240301, &c), i);
+        CHECK(c.accepted && c.mac_updated && c.checked_in && !c.evicted);
+        CHECK_EQ(t->user[i].last_in, 20240301);
+    }
+    CHECK_EQ(t->n, 4);
+    CHECK_EQ(connect(t, &CFG, 9, 20240301, &c), -1);      // full, nobody idle
+    CHECK(!c.accepted);
+
+    uint8_t m[6];
+    CHECK(tk_users_remove(t, 1));                          // user 3 moves into slot 1
+    CHECK_EQ(t->n, 3);
+    mac_of(m, 3);
+    CHECK_EQ(tk_users_find(t, m), 1);
+    mac_of(m, 1);
+    CHECK_EQ(tk_users_find(t, m), -1);
+    index_ok(t);
+    CHECK(tk_users_remove(t, 2));                          // the last one: nothing moves
+    CHECK_EQ(t->n, 2);
+    index_ok(t);
+    CHECK(!tk_users_remove(t, 2));
+    CHECK_EQ(connect(t, &CFG, 9, 20240301, &c), 2);        // room again
+    CHECK(c.accepted && !c.evicted);
+    index_ok(t);
+}
+
+static void evict_idle(void)
+{
+    tk_users_t *t = &s_t;
+    tk_users_init(t, 3);
+    tk_connect_t c;
+    connect(t, &CFG, 0, 20240101, &c);
+    connect(t, &CFG, 1, 20240110, &c);
+    connect(t, &CFG, 2, 20240115, &c);
+
+    // 20240130: user 0 is 29 days idle, not yet
+    end_day(t, 20240130);
+    CHECK_EQ(connect(t, &CFG, 7, 20240130, &c), -1);
+    // 20240131: user 0 is 30 days idle and goes; the newcomer is checked in at once
+    end_day(t, 20240131);
+    CHECK_EQ(connect(t, &CFG, 7, 20240131, &c), 0);
+    CHECK(c.accepted && c.evicted && c.mac_updated && c.checked_in);
+    CHECK_EQ(t->n, 3);
+    CHECK_EQ(t->user[0].last_in, 20240131);
+    CHECK_EQ(t->user[0].worked, 0);
+    uint8_t m[6];
+    mac_of(m, 0);
+    CHECK_EQ(tk_users_find(t, m), -1);
+    index_ok(t);
+
+    // the longest idle goes first: user 1 (20240110) before user 2 (20240115), across a
+    // month boundary; user 0 (20240131) is 29 days idle and stays
+    end_day(t, 20240229);
+    CHECK_EQ(connect(t, &CFG, 8, 20240229, &c), 1);
+    CHECK(c.evicted);
+    CHECK_EQ(connect(t, &CFG, 9, 20240229, &c), 2);
+    CHECK(c.evicted);
+    index_ok(t);
+    CHECK_EQ(connect(t, &CFG, 10, 20240229, &c), -1);
+
+    // no known check-in (enrolled before last_in was kept): never evicted
+    end_day(t, 20250101);
+    for (uint32_t u = 0; u < t->n; u++) t->user[u].last_in = 0;
+    CHECK_EQ(connect(t, &CFG, 10, 20250101, &c), -1);
+
+    // eviction off
+    tk_config_t off = CFG;
+    off.evict_idle_days = 0;
+    t->user[0].last_in = 20240101;
+    CHECK_EQ(connect(t, &off, 10, 20250101, &c), -1);
+    CHECK_EQ(connect(t, &CFG, 10, 20250101, &c), 0);
+
+    // a single-phone table relearns instead of evicting
+    tk_users_init(t, 1);
+    connect(t, &CFG, 0, 20240101, &c);
+    end_day(t, 20250101);
+    CHECK_EQ(connect(t, &CFG, 1, 20250101, &c), 0);
+    CHECK(!c.evicted && !c.accepted);                      // relearn_mac_daily is off
+}
+
+void test_users(void)
+{
+    enroll_and_remove();
+    evict_idle();
+}
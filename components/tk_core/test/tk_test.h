@@ -0,0 +1,41 @@
+#pragma once
+// Host test harness for tk_core: CHECK() reports a failure and carries on; each suite is
+// one function listed in test_main.c and run by name, one ctest entry per suite.
+
+#include <stdint.h>
+#include <stdio.h>
+#include "tk_civil.h"
+
+extern int tk_test_failures;
+
+#define CHECK(c) do { \
+    if (!(c)) { tk_test_failures++; fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #c); } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long a_ = (long long)(a), b_ = (long long)(b); \
+    if (a_ != b_) { \
+        tk_test_failures++; \
+        fprintf(stderr, "%s:%d: %s == %s failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, a_, b_); \
+    } \
+} while (0)
+
+// Epoch of a local (IST) wall-clock time
+static inline int64_t tk_test_ist(int32_t y, uint32_t mo, uint32_t d, int hh, int mm, int ss) {
+    return (int64_t)tk_days_from_civil(y, mo, d) * TK_CIVIL_SEC_PER_DAY + hh * 3600 + mm * 60 + ss
+           - TK_CIVIL_IST_OFFSET;
+}
+
+// Suites
+void test_app(void);
+void test_civil(void);
+void test_dlog(void);
+void test_history(void);
+void test_journal(void);
+void test_policy(void);
+void test_ratelimit(void);
+void test_replay(void);
+void test_rssi(void);
+void test_seqlock(void);
+void test_tm1637_wave(void);
+void test_users(void);
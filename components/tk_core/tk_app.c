@@ -0,0 +1,170 @@
+#include "tk_app.h"
+#include <string.h>
+
+// Bookkeeping for an event outcome: focus, save cadence, stats
+static void settle(tk_app_t *app, tk_app_out_t *out)
+{
+    if (out->user < 0) return;
+    if (out->c.checked_in) app->stats.checkins++;
+    if (out->resumed)      app->stats.resumes++;
+    if (out->c.checked_in || out->resumed) app->focus = out->user;
+    if (out->save_state) {
+        app->last_save[out->user] = 0;
+        app->stats.state_saves++;
+    }
+    if (out->save_mac) app->stats.mac_saves++;
+    if (out->deauth)   app->stats.deauths++;
+}
+
+// Check-in by a sighting (sniffed frame, signal near): the connect policy, minus the deauth
+static void checkin_no_deauth(tk_app_t *app, const uint8_t mac[6], int64_t now, tk_app_out_t *out)
+{
+    int u;
+    tk_connect_t c = tk_users_on_connect(&app->users, app->cfg, mac, app->today, now, &u);
+    if (!c.checked_in) return;
+    out->c          = c;
+    out->c.deauth   = false;
+    out->save_mac   = true;
+    out->save_state = true;
+}
+
+void tk_app_init(tk_app_t *app, const tk_config_t *cfg, uint32_t users_max, int32_t save_sec)
+{
+    memset(app, 0, sizeof(*app));
+    app->cfg      = cfg;
+    app->save_sec = save_sec;
+    app->focus    = -1;
+    tk_users_init(&app->users, users_max);
+}
+
+void tk_app_start(tk_app_t *app, uint32_t today, int64_t epoch, uint64_t *save_state, uint64_t *save_mac)
+{
+    *save_state = 0;
+    *save_mac   = 0;
+    if (app->users.n > app->users.max) app->users.n = app->users.max;
+    tk_users_reindex(&app->users);
+    app->today = today;
+    app->focus = -1;
+
+    for (uint32_t u = 0; u < app->users.n; u++) {
+        tk_state_t *st = &app->users.user[u];
+        if (today) {
+            if (tk_core_set_day(st, app->cfg, today) & TK_EV_NEW_DAY) *save_state |= 1ull << u;
+            // enrolled before check-in days were kept: the idle clock starts now
+            if (!st->last_in) {
+                st->last_in = today;
+                *save_mac |= 1ull << u;
+            }
+        }
+        st->last_epoch = epoch;
+        st->last_seen  = epoch;
+        if (st->started && !st->paused) st->session_start = epoch;
+        if (st->started && app->focus < 0) app->focus = (int)u;
+        app->last_save[u] = 0;
+    }
+    app->stats.state_saves += (uint32_t)__builtin_popcountll(*save_state);
+    app->stats.mac_saves   += (uint32_t)__builtin_popcountll(*save_mac);
+}
+
+void tk_app_connect(tk_app_t *app, const uint8_t mac[6], int64_t now, tk_app_out_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->c = tk_users_on_connect(&app->users, app->cfg, mac, app->today, now, &out->user);
+    if (!out->c.accepted) {
+        out->user = -1;
+        return;
+    }
+    (void)tk_core_set_link(&app->users.user[out->user], true, now);
+    out->resumed    = out->c.resumed;
+    out->save_mac   = out->c.mac_updated || out->c.checked_in;
+    out->save_state = out->c.mac_updated || out->c.checked_in || out->c.resumed;
+    out->deauth     = out->c.deauth;
+    settle(app, out);
+}
+
+int tk_app_disconnect(tk_app_t *app, const uint8_t mac[6], int64_t now)
+{
+    int u = tk_users_find(&app->users, mac);
+    if (u >= 0) (void)tk_core_set_link(&app->users.user[u], false, now);
+    return u;
+}
+
+void tk_app_seen(tk_app_t *app, const uint8_t mac[6], int64_t now, tk_app_out_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->user = tk_users_find(&app->users, mac);
+    if (out->user < 0) return;
+    tk_state_t *st = &app->users.user[out->user];
+    if (st->started) {
+        out->resumed = out->save_state = (tk_core_seen(st, now) & TK_EV_RESUME) != 0;
+    } else {
+        checkin_no_deauth(app, mac, now, out);
+    }
+    settle(app, out);
+}
+
+void tk_app_link(tk_app_t *app, const uint8_t mac[6], bool near, int64_t now, tk_app_out_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->user = tk_users_find(&app->users, mac);
+    if (out->user < 0) return;
+    tk_state_t *st = &app->users.user[out->user];
+    if (tk_core_set_link(st, near, now) & TK_EV_RESUME) {
+        out->resumed = out->save_state = true;
+    } else if (near && !st->started) {
+        checkin_no_deauth(app, mac, now, out);
+    }
+    settle(app, out);
+}
+
+void tk_app_tick(tk_app_t *app, int64_t epoch, uint32_t today, tk_app_tick_t *out)
+{
+    if (today != app->today) {
+        if (app->today) app->stats.rollovers++;
+        app->today = today;
+    }
+    app->stats.ticks++;
+
+    // Transitions persist now, minute marks on the slow interval
+    tk_users_tick(&app->users, app->cfg, epoch, today, &out->ev);
+    out->save_now = out->ev.new_day | out->ev.done | out->ev.pause;
+    out->save_due = 0;
+    for (uint64_t m = out->save_now; m; m &= m - 1) app->last_save[__builtin_ctzll(m)] = 0;
+    for (uint64_t m = out->ev.minute & ~out->save_now; m; m &= m - 1) {
+        uint32_t u = (uint32_t)__builtin_ctzll(m);
+        if (epoch - app->last_save[u] < app->save_sec) continue;
+        app->last_save[u] = epoch;
+        out->save_due |= 1ull << u;
+    }
+    app->stats.state_saves += (uint32_t)__builtin_popcountll(out->save_now | out->save_due);
+}
+
+int32_t tk_app_quiet(const tk_app_t *app, int64_t epoch)
+{
+    int32_t q = app->cfg->max_tick_delta_sec > 1 ? app->cfg->max_tick_delta_sec - 1 : 0;
+    for (uint32_t u = 0; u < app->users.n && q > 0; u++) {
+        const tk_state_t *st = &app->users.user[u];
+        if (!st->started || st->paused) continue;              // the tick leaves them alone
+        // counting down: the minute mark is an event; on the display the second after it
+        // is a new HH:MM
+        if (st->remaining > 0) {
+            int32_t m = st->remaining % 60;
+            int32_t next = m ? m : (int)u == app->focus ? 1 : 60;
+            if (next - 1 < q) q = next - 1;
+        }
+        // out of range: the tick past the grace window pauses
+        if (!st->connected && app->cfg->away_grace_sec > 0 && st->last_seen) {
+            int64_t g = st->last_seen + app->cfg->away_grace_sec - epoch;
+            if (g < q) q = g > 0 ? (int32_t)g : 0;
+        }
+    }
+    return q;
+}
+
+const tk_state_t *tk_app_shown(const tk_state_t *user, uint32_t n, int focus, const tk_config_t *cfg,
+                               tk_state_t *idle)
+{
+    if (focus >= 0 && (uint32_t)focus < n) return &user[focus];
+    tk_core_init(idle, cfg);
+    return idle;
+}
@@ -0,0 +1,100 @@
+#include "tk_civil.h"
+
+static inline bool is_leap(int32_t y)
+{
+    return (y % 4 == 0) && (y % 100 != 0 || y % 400 == 0);
+}
+
+// Days before the 1st of each month (index 1..12), common and leap year
+static const uint16_t s_days_before[2][13] = {
+    { 0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 },
+    { 0, 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335 },
+};
+
+static const uint8_t s_days_in[2][13] = {
+    { 0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 },
+    { 0, 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 },
+};
+
+// Leap days in years [1, y) (y >= 1)
+static inline int32_t leaps_before(int32_t y)
+{
+    int32_t p = y - 1;
+    return p / 4 - p / 100 + p / 400;
+}
+
+#define LEAPS_BEFORE_1970 477
+
+static inline int64_t floor_div(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+    return (a % b < 0) ? q - 1 : q;
+}
+
+int32_t tk_days_from_civil(int32_t y, uint32_t m, uint32_t d)
+{
+    return (y - 1970) * 365 + (leaps_before(y) - LEAPS_BEFORE_1970)
+         + s_days_before[is_leap(y)][m] + (int32_t)d - 1;
+}
+
+// H. Hinnant's days -> civil: March-based years put the leap day last, so no table
+void tk_civil_from_days(int32_t days, int32_t *y, uint32_t *m, uint32_t *d)
+{
+    int32_t  z   = days + 719468;                                  // days since 0000-03-01
+    int32_t  era = (z >= 0 ? z : z - 146096) / 146097;
+    uint32_t doe = (uint32_t)(z - era * 146097);                   // [0, 146096]
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);        // [0, 365], from March 1
+    uint32_t mp  = (5 * doy + 2) / 153;                            // [0, 11], March = 0
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp < 10 ? mp + 3 : mp - 9;
+    *y = (int32_t)yoe + era * 400 + (*m <= 2);
+}
+
+int64_t tk_civil_to_epoch(const struct tm *t, int32_t offset)
+{
+    int32_t days = tk_days_from_civil(t->tm_year + 1900, (uint32_t)t->tm_mon + 1, (uint32_t)t->tm_mday);
+    return (int64_t)days * TK_CIVIL_SEC_PER_DAY + t->tm_hour * 3600 + t->tm_min * 60 + t->tm_sec - offset;
+}
+
+void tk_civil_from_epoch(int64_t epoch, int32_t offset, struct tm *t)
+{
+    int64_t local = epoch + offset;
+    int32_t days  = (int32_t)floor_div(local, TK_CIVIL_SEC_PER_DAY);
+    int32_t sod   = (int32_t)(local - (int64_t)days * TK_CIVIL_SEC_PER_DAY);
+
+    int32_t y; uint32_t m, d;
+    tk_civil_from_days(days, &y, &m, &d);
+    t->tm_year  = y - 1900;
+    t->tm_mon   = (int)m - 1;
+    t->tm_mday  = (int)d;
+    t->tm_hour  = sod / 3600;
+    t->tm_min   = sod / 60 % 60;
+    t->tm_sec   = sod % 60;
+    t->tm_wday  = (int)((days % 7 + 11) % 7);                      // 1970-01-01 was a Thursday
+    t->tm_yday  = s_days_before[is_leap(y)][m] + (int)d - 1;
+    t->tm_isdst = 0;
+}
+
+bool tk_civil_tick(struct tm *t)
+{
+    if (++t->tm_sec < 60) return false;
+    t->tm_sec = 0;
+    if (++t->tm_min < 60) return false;
+    t->tm_min = 0;
+    if (++t->tm_hour < 24) return false;
+    t->tm_hour = 0;
+
+    t->tm_wday = (t->tm_wday + 1) % 7;
+    t->tm_yday++;
+    int32_t y = t->tm_year + 1900;
+    if (++t->tm_mday > s_days_in[is_leap(y)][t->tm_mon + 1]) {
+        t->tm_mday = 1;
+        if (++t->tm_mon == 12) {
+            t->tm_mon  = 0;
+            t->tm_yday = 0;
+            t->tm_year++;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,175 @@
+#include "tk_core.h"
+#include <string.h>
+
+// ---- Connect policy ----
+static bool deauth_never(const tk_state_t *st)  { (void)st; return false; }
+static bool deauth_first(const tk_state_t *st)  { return !st->started; }   // the check-in connect
+static bool deauth_always(const tk_state_t *st) { (void)st; return true; }
+static bool relearn_never(const tk_state_t *st) { (void)st; return false; }
+static bool relearn_daily(const tk_state_t *st) { return !st->started; }   // before the day's check-in
+
+static const tk_policy_t s_policy[][2] = {
+    [TK_DEAUTH_NONE]          = { { deauth_never,  relearn_never }, { deauth_never,  relearn_daily } },
+    [TK_DEAUTH_FIRST_CONNECT] = { { deauth_first,  relearn_never }, { deauth_first,  relearn_daily } },
+    [TK_DEAUTH_ALWAYS]        = { { deauth_always, relearn_never }, { deauth_always, relearn_daily } },
+};
+
+const tk_policy_t *tk_policy_get(tk_deauth_policy_t deauth, bool relearn_mac_daily)
+{
+    if ((unsigned)deauth >= sizeof(s_policy) / sizeof(s_policy[0])) deauth = TK_DEAUTH_NONE;
+    return &s_policy[deauth][relearn_mac_daily ? 1 : 0];
+}
+
+void tk_config_resolve(tk_config_t *cfg)
+{
+    cfg->policy = tk_policy_get(cfg->deauth, cfg->relearn_mac_daily);
+}
+
+void tk_core_init(tk_state_t *st, const tk_config_t *cfg)
+{
+    memset(st, 0, sizeof(*st));
+    st->remaining = cfg->daily_target_sec;
+}
+
+uint32_t tk_core_set_day(tk_state_t *st, const tk_config_t *cfg, uint32_t today)
+{
+    if (st->day_key == today) return 0;
+    st->day_key        = today;
+    st->started        = false;
+    st->remaining      = cfg->daily_target_sec;
+    st->worked         = 0;
+    st->paused         = false;
+    st->session_start  = 0;
+    st->session_worked = 0;
+    return TK_EV_NEW_DAY;
+}
+
+// Append [session_start, end] to the day's list in O(1) and close the session
+static void close_session(tk_state_t *st, tk_sessions_t *ss, int64_t end)
+{
+    if (!st->session_start) return;
+    if (ss) {
+        if (ss->day_key != st->day_key) {
+            ss->day_key = st->day_key;
+            ss->n       = 0;
+            ss->merged  = 0;
+        }
+        if (end < st->session_start) end = st->session_start;
+        if (ss->n < TK_SESSIONS_MAX) {
+            ss->s[ss->n++] = (tk_session_t){ (uint32_t)st->session_start, (uint32_t)end };
+        } else {
+            ss->s[TK_SESSIONS_MAX - 1].end = (uint32_t)end;
+            ss->merged++;
+        }
+    }
+    st->session_start = 0;
+}
+
+static inline void open_session(tk_state_t *st, int64_t epoch)
+{
+    st->session_start  = epoch;
+    st->session_worked = 0;
+}
+
+uint32_t tk_core_tick(tk_state_t *st, const tk_config_t *cfg, int64_t epoch, uint32_t today,
+                      tk_sessions_t *ss)
+{
+    if (st->day_key != today && st->started && !st->paused) close_session(st, ss, st->last_epoch);
+    uint32_t ev = tk_core_set_day(st, cfg, today);
+
+    // Elapsed seconds since the previous tick (robust to delays)
+    int64_t prev  = st->last_epoch;
+    int64_t delta = prev ? epoch - prev : 0;
+    if (delta < 0) delta = 0;
+    if (delta > cfg->max_tick_delta_sec) delta = cfg->max_tick_delta_sec;
+    st->last_epoch = epoch;
+
+    if (!st->started) return ev;
+    // state restored from a record without the on-site total: the countdown implies it
+    if (st->worked < cfg->daily_target_sec - st->remaining) st->worked = cfg->daily_target_sec - st->remaining;
+    if (st->paused) return ev;
+
+    if (st->connected) st->last_seen = epoch;
+    if (cfg->away_grace_sec > 0 && st->last_seen && epoch - st->last_seen > cfg->away_grace_sec) {
+        // Away: the session ended at the last sighting, so what was counted after it is not on-site time
+        int64_t after  = prev - st->last_seen;
+        int32_t refund = after <= 0 ? 0 : after > st->session_worked ? st->session_worked : (int32_t)after;
+        st->worked         -= refund;
+        st->session_worked -= refund;
+        close_session(st, ss, st->last_seen);
+        st->paused    = true;
+        st->remaining = st->worked >= cfg->daily_target_sec ? 0 : cfg->daily_target_sec - st->worked;
+        return ev | TK_EV_PAUSE;
+    }
+
+    if (delta > 0) {
+        int32_t was = st->remaining;
+        st->worked         += (int32_t)delta;
+        st->session_worked += (int32_t)delta;
+        st->remaining = st->worked >= cfg->daily_target_sec ? 0 : cfg->daily_target_sec - st->worked;
+        if (was > 0 && st->remaining == 0)                        ev |= TK_EV_DONE;
+        else if (st->remaining > 0 && st->remaining % 60 == 0)    ev |= TK_EV_MINUTE;
+    }
+    return ev;
+}
+
+uint32_t tk_core_seen(tk_state_t *st, int64_t epoch)
+{
+    if (epoch > st->last_seen) st->last_seen = epoch;
+    if (!st->started || !st->paused) return 0;
+    st->paused = false;
+    open_session(st, epoch);
+    return TK_EV_RESUME;
+}
+
+uint32_t tk_core_set_link(tk_state_t *st, bool connected, int64_t epoch)
+{
+    st->connected = connected;
+    return tk_core_seen(st, epoch);
+}
+
+tk_connect_t tk_core_on_connect(tk_state_t *st, const tk_config_t *cfg, const uint8_t mac[6], int64_t epoch)
+{
+    tk_connect_t r = {0};
+    const tk_policy_t *pol = cfg->policy ? cfg->policy : tk_policy_get(cfg->deauth, cfg->relearn_mac_daily);
+
+    bool mac_matches = st->have_mac && memcmp(st->mac, mac, 6) == 0;
+    bool can_relearn = !mac_matches && pol->relearn(st);
+
+    r.accepted = !st->have_mac || mac_matches || can_relearn;
+    if (!r.accepted) return r;
+
+    if (!st->have_mac || (!mac_matches && can_relearn)) {
+        memcpy(st->mac, mac, 6);
+        st->have_mac  = true;
+        r.mac_updated = true;
+    }
+
+    r.deauth = pol->deauth(st);
+
+    r.resumed = (tk_core_seen(st, epoch) & TK_EV_RESUME) != 0;
+    if (!st->started) {
+        st->started  = true;
+        st->paused   = false;
+        st->last_in  = st->day_key;
+        r.checked_in = true;
+        open_session(st, epoch);
+    }
+    return r;
+}
+
+tk_phase_t tk_core_phase(const tk_state_t *st)
+{
+    if (st->remaining <= 0) return TK_DONE;
+    if (!st->started) return TK_WAIT;
+    return st->paused ? TK_PAUSE : TK_RUN;
+}
+
+void tk_core_hhmm(const tk_state_t *st, uint8_t *hh, uint8_t *mm)
+{
+    int rem = st->remaining; if (rem < 0) rem = 0;
+    int rh = rem / 3600;
+    if (rh > 99) rh = 99;
+    *hh = (uint8_t)rh;
+    *mm = (uint8_t)((rem % 3600) / 60);
+}
@@ -0,0 +1,149 @@
+#include "tk_ratelimit.h"
+#include <string.h>
+#include "tk_mac.h"
+
+_Static_assert((TK_RL_SLOTS & (TK_RL_SLOTS - 1)) == 0 && TK_RL_PROBE <= TK_RL_SLOTS,
+               "slot count must be a power of two, probe window within it");
+
+static inline uint32_t home_slot(uint64_t k)
+{
+    return tk_mac_hash(k) & (TK_RL_SLOTS - 1);
+}
+
+// Whole refill periods since *last (wrapping clock) go into *tokens, capped at cap.
+// *last may lie ahead (end of a back-off): nothing refills before it.
+static void refill(uint16_t *tokens, uint32_t *last, uint16_t cap, uint32_t period_ms, uint32_t now_ms)
+{
+    if ((int32_t)(now_ms - *last) <= 0) return;
+    uint32_t n = (now_ms - *last) / period_ms;
+    if (n == 0) return;
+    if (n >= (uint32_t)(cap - *tokens)) {
+        *tokens = cap;
+        *last   = now_ms;
+    } else {
+        *tokens += (uint16_t)n;
+        *last   += n * period_ms;
+    }
+}
+
+// Nothing left to remember: no back-off running and the bucket would be full again, so
+// a fresh entry behaves the same
+static bool expired(const tk_rl_entry_t *e, const tk_rl_config_t *cfg, uint32_t now_ms)
+{
+    if (e->strikes && (int32_t)(e->until_ms - now_ms) > 0) return false;
+    if ((int32_t)(now_ms - e->last_ms) < 0) return false;
+    uint32_t missing = (uint32_t)(cfg->burst - e->tokens);
+    return (now_ms - e->last_ms) / cfg->refill_ms >= missing;
+}
+
+// Entry for k: the matching slot in the probe window, else a free one, else the expired
+// one brought up to date longest ago (recycled), else for an enrolled MAC the stalest
+// stranger (displaced). NULL: a stranger with every slot in its window live.
+static tk_rl_entry_t *lookup(tk_rl_t *rl, const tk_rl_config_t *cfg, uint64_t k, bool enrolled,
+                             uint32_t now_ms, bool insert)
+{
+    uint32_t h = home_slot(k);
+    tk_rl_entry_t *free_e = NULL, *old = NULL, *stranger = NULL;
+    for (uint32_t i = 0; i < TK_RL_PROBE; i++) {
+        tk_rl_entry_t *e = &rl->e[(h + i) & (TK_RL_SLOTS - 1)];
+        if (e->key == k) return e;
+        if (e->key == 0) { if (!free_e) free_e = e; continue; }
+        if (!insert) continue;
+        if (expired(e, cfg, now_ms) && (!old || (int32_t)(e->last_ms - old->last_ms) < 0)) old = e;
+        if (!e->enrolled && (!stranger || (int32_t)(e->last_ms - stranger->last_ms) < 0)) stranger = e;
+    }
+    if (!insert) return NULL;
+    tk_rl_entry_t *e = free_e;
+    if (!e && old) {
+        e = old;
+        rl->recycled++;
+    }
+    if (!e && enrolled && stranger) {
+        e = stranger;
+        rl->displaced++;
+    }
+    if (!e) return NULL;
+    memset(e, 0, sizeof(*e));
+    e->key      = k;
+    e->tokens   = cfg->burst;
+    e->last_ms  = now_ms;
+    e->enrolled = enrolled;
+    return e;
+}
+
+// The global bucket: every stranger's connect draws on it
+static bool global_take(tk_rl_t *rl, const tk_rl_config_t *cfg, uint32_t now_ms)
+{
+    refill(&rl->g_tokens, &rl->g_last_ms, cfg->global_burst, cfg->global_refill_ms, now_ms);
+    if (rl->g_tokens == 0) return false;
+    rl->g_tokens--;
+    return true;
+}
+
+void tk_rl_init(tk_rl_t *rl, const tk_rl_config_t *cfg, uint32_t now_ms)
+{
+    memset(rl, 0, sizeof(*rl));
+    rl->g_tokens  = cfg->global_burst;
+    rl->g_last_ms = now_ms;
+}
+
+tk_rl_verdict_t tk_rl_connect(tk_rl_t *rl, const tk_rl_config_t *cfg, const uint8_t mac[6], bool enrolled,
+                              uint32_t now_ms)
+{
+    tk_rl_entry_t *e = lookup(rl, cfg, tk_mac_key(mac), enrolled, now_ms, true);
+    tk_rl_verdict_t v = TK_RL_PASS;
+
+    if (!e) {                                      // nothing kept, so its disconnect is not paired
+        rl->untracked++;
+        if (!global_take(rl, cfg, now_ms)) {
+            rl->dropped[TK_RL_DROP_GLOBAL]++;
+            return TK_RL_DROP_GLOBAL;
+        }
+        rl->passed++;
+        return TK_RL_PASS;
+    }
+    e->enrolled |= enrolled;
+
+    refill(&e->tokens, &e->last_ms, cfg->burst, cfg->refill_ms, now_ms);
+    if (e->tokens == cfg->burst) e->strikes = 0;   // refilled since the back-off ended: forgiven
+
+    if (e->strikes && (int32_t)(e->until_ms - now_ms) > 0) {
+        v = TK_RL_DROP_BACKOFF;
+    } else if (e->tokens == 0) {
+        uint32_t shift = e->strikes < 16 ? e->strikes : 16;
+        uint64_t wait  = (uint64_t)cfg->backoff_ms << shift;
+        if (wait > cfg->backoff_max_ms) wait = cfg->backoff_max_ms;
+        if (e->strikes < UINT8_MAX) e->strikes++;
+        e->until_ms = now_ms + (uint32_t)wait;
+        e->tokens   = 1;                           // one attempt when the back-off ends,
+        e->last_ms  = e->until_ms;                 // then refilling from there
+        v = TK_RL_DROP_RATE;
+    } else if (!enrolled && !global_take(rl, cfg, now_ms)) {
+        v = TK_RL_DROP_GLOBAL;
+    }
+
+    e->held_back = (v != TK_RL_PASS);
+    if (v != TK_RL_PASS) {
+        rl->dropped[v]++;
+        return v;
+    }
+    e->tokens--;
+    rl->passed++;
+    return TK_RL_PASS;
+}
+
+bool tk_rl_disconnect(tk_rl_t *rl, const uint8_t mac[6])
+{
+    tk_rl_entry_t *e = lookup(rl, NULL, tk_mac_key(mac), false, 0, false);
+    if (!e || !e->held_back) return false;
+    e->held_back = false;
+    rl->dropped_disconnects++;
+    return true;
+}
+
+uint32_t tk_rl_dropped(const tk_rl_t *rl)
+{
+    uint32_t n = rl->dropped_disconnects;
+    for (int v = TK_RL_DROP_RATE; v < TK_RL_VERDICTS; v++) n += rl->dropped[v];
+    return n;
+}
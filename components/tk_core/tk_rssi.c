@@ -0,0 +1,37 @@
+#include "tk_rssi.h"
+
+void tk_rssi_reset(tk_rssi_t *r)
+{
+    r->avg_q8  = 0;
+    r->last_ms = 0;
+    r->samples = 0;
+    r->near    = false;
+}
+
+int tk_rssi_update(tk_rssi_t *r, const tk_rssi_config_t *cfg, int8_t dbm, uint32_t now_ms)
+{
+    int32_t x = (int32_t)dbm * 256;
+    if (r->samples == 0) r->avg_q8 = x;
+    else                 r->avg_q8 += (x - r->avg_q8) >> cfg->shift;   // arithmetic shift: rounds toward -inf
+    if (r->samples < UINT16_MAX) r->samples++;
+    r->last_ms = now_ms;
+
+    if (!r->near) {
+        if (r->samples >= cfg->min_samples && r->avg_q8 >= (int32_t)cfg->enter_dbm * 256) {
+            r->near = true;
+            return TK_RSSI_NEAR;
+        }
+    } else if (r->avg_q8 < (int32_t)cfg->leave_dbm * 256) {
+        r->near = false;
+        return TK_RSSI_FAR;
+    }
+    return 0;
+}
+
+int tk_rssi_expire(tk_rssi_t *r, uint32_t now_ms, uint32_t stale_ms)
+{
+    if (r->samples == 0 || now_ms - r->last_ms <= stale_ms) return 0;
+    int tr = r->near ? TK_RSSI_FAR : TK_RSSI_GONE;
+    tk_rssi_reset(r);
+    return tr;
+}
@@ -0,0 +1,41 @@
+#include "tk_seqlock.h"
+#include <string.h>
+
+void tk_seqlock_init(tk_seqlock_t *s, _Atomic uint32_t *storage, size_t bytes)
+{
+    s->words = storage;
+    s->bytes = bytes;
+    atomic_init(&s->seq, 0);
+    for (size_t i = 0; i < TK_SEQLOCK_WORDS(bytes); i++) atomic_init(&storage[i], 0);
+}
+
+void tk_seqlock_write(tk_seqlock_t *s, const void *src)
+{
+    const uint8_t *p = (const uint8_t *)src;
+    uint32_t seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);          // odd seq visible before any payload word
+
+    for (size_t off = 0, i = 0; off < s->bytes; off += 4, i++) {
+        uint32_t w = 0;
+        memcpy(&w, p + off, (s->bytes - off) < 4 ? (s->bytes - off) : 4);
+        atomic_store_explicit(&s->words[i], w, memory_order_relaxed);
+    }
+    atomic_store_explicit(&s->seq, seq + 2, memory_order_release);
+}
+
+bool tk_seqlock_read(tk_seqlock_t *s, void *dst, unsigned tries)
+{
+    uint8_t *p = (uint8_t *)dst;
+    while (tries--) {
+        uint32_t s1 = atomic_load_explicit(&s->seq, memory_order_acquire);
+        if (s1 & 1) continue;
+        for (size_t off = 0, i = 0; off < s->bytes; off += 4, i++) {
+            uint32_t w = atomic_load_explicit(&s->words[i], memory_order_relaxed);
+            memcpy(p + off, &w, (s->bytes - off) < 4 ? (s->bytes - off) : 4);
+        }
+        atomic_thread_fence(memory_order_acquire);      // payload loads complete before the re-check
+        if (atomic_load_explicit(&s->seq, memory_order_relaxed) == s1) return true;
+    }
+    return false;
+}
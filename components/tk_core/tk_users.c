@@ -0,0 +1,141 @@
+#include "tk_users.h"
+#include <string.h>
+#include "tk_civil.h"
+#include "tk_mac.h"
+
+_Static_assert(TK_USERS_MAX <= 64, "per-tick event masks are 64-bit");
+_Static_assert(TK_USERS_MAX <= 255, "index slots are uint8_t");
+_Static_assert((TK_USERS_SLOTS & (TK_USERS_SLOTS - 1)) == 0 && TK_USERS_SLOTS >= 2 * TK_USERS_MAX,
+               "slot count must be a power of two with load factor <= 0.5");
+
+static inline uint32_t home_slot(uint64_t k)
+{
+    return tk_mac_hash(k) & (TK_USERS_SLOTS - 1);
+}
+
+// Linear probe: slot holding k, or the empty slot where it belongs (load <= 0.5, never full)
+static uint32_t probe(const tk_users_t *t, uint64_t k)
+{
+    uint32_t i = home_slot(k);
+    while (t->key[i] != 0 && t->key[i] != k) i = (i + 1) & (TK_USERS_SLOTS - 1);
+    return i;
+}
+
+void tk_users_init(tk_users_t *t, uint32_t max)
+{
+    memset(t, 0, sizeof(*t));
+    t->max = (max == 0 || max > TK_USERS_MAX) ? TK_USERS_MAX : max;
+}
+
+int tk_users_find(const tk_users_t *t, const uint8_t mac[6])
+{
+    uint64_t k = tk_mac_key(mac);
+    if (k == 0) return -1;
+    uint32_t i = probe(t, k);
+    return t->key[i] == k ? (int)t->idx[i] : -1;
+}
+
+void tk_users_reindex(tk_users_t *t)
+{
+    memset(t->key, 0, sizeof(t->key));
+    for (uint32_t u = 0; u < t->n; u++) {
+        if (!t->user[u].have_mac) continue;
+        uint64_t k = tk_mac_key(t->user[u].mac);
+        if (k == 0) continue;
+        uint32_t i = probe(t, k);
+        t->key[i] = k;
+        t->idx[i] = (uint8_t)u;
+    }
+}
+
+uint32_t tk_users_set_day(tk_users_t *t, const tk_config_t *cfg, uint32_t today)
+{
+    uint32_t ev = 0;
+    for (uint32_t u = 0; u < t->n; u++) ev |= tk_core_set_day(&t->user[u], cfg, today);
+    return ev;
+}
+
+void tk_users_tick(tk_users_t *t, const tk_config_t *cfg, int64_t epoch, uint32_t today, tk_users_ev_t *ev)
+{
+    memset(ev, 0, sizeof(*ev));
+    for (uint32_t u = 0; u < t->n; u++) {
+        uint32_t e = tk_core_tick(&t->user[u], cfg, epoch, today, &t->sess[u]);
+        if (!e) continue;
+        uint64_t bit = 1ULL << u;
+        ev->any |= e;
+        if (e & TK_EV_NEW_DAY) ev->new_day |= bit;
+        if (e & TK_EV_DONE)    ev->done    |= bit;
+        if (e & TK_EV_MINUTE)  ev->minute  |= bit;
+        if (e & TK_EV_PAUSE)   ev->pause   |= bit;
+    }
+}
+
+static int32_t key_days(uint32_t k)
+{
+    return tk_days_from_civil((int32_t)(k / 10000), k / 100 % 100, k % 100);
+}
+
+// The user idle longest, if idle for at least evict_idle_days; users checked in today
+// and those with no known check-in are never picked
+static int idle_victim(const tk_users_t *t, const tk_config_t *cfg, uint32_t today)
+{
+    if (!cfg->evict_idle_days || !today) return -1;
+    int32_t now = key_days(today);
+    int32_t most = (int32_t)cfg->evict_idle_days - 1;
+    int v = -1;
+    for (uint32_t u = 0; u < t->n; u++) {
+        const tk_state_t *st = &t->user[u];
+        if (st->started || !st->last_in) continue;
+        int32_t idle = now - key_days(st->last_in);
+        if (idle > most) { most = idle; v = (int)u; }
+    }
+    return v;
+}
+
+static void fresh(tk_users_t *t, uint32_t u, const tk_config_t *cfg, uint32_t today)
+{
+    tk_core_init(&t->user[u], cfg);
+    memset(&t->sess[u], 0, sizeof(t->sess[u]));
+    (void)tk_core_set_day(&t->user[u], cfg, today);
+}
+
+tk_connect_t tk_users_on_connect(tk_users_t *t, const tk_config_t *cfg, const uint8_t mac[6],
+                                 uint32_t today, int64_t epoch, int *user)
+{
+    tk_connect_t r = {0};
+    int u = tk_users_find(t, mac);
+    bool evicted = false;
+
+    if (u < 0 && t->n < t->max) {
+        u = (int)t->n;
+        fresh(t, (uint32_t)u, cfg, today);
+        t->n++;                                  // publish only once the entry is valid
+    } else if (u < 0 && t->max == 1) {
+        u = 0;                                   // single phone: relearn policy decides
+    } else if (u < 0 && (u = idle_victim(t, cfg, today)) >= 0) {
+        fresh(t, (uint32_t)u, cfg, today);       // the old MAC leaves the index below
+        evicted = true;
+    }
+    if (user) *user = u;
+    if (u < 0) return r;
+
+    r = tk_core_on_connect(&t->user[u], cfg, mac, epoch);
+    r.evicted = evicted;
+    if (r.mac_updated) tk_users_reindex(t);
+    return r;
+}
+
+bool tk_users_remove(tk_users_t *t, uint32_t u)
+{
+    if (u >= t->n) return false;
+    uint32_t last = t->n - 1;
+    if (u != last) {
+        t->user[u] = t->user[last];
+        t->sess[u] = t->sess[last];
+    }
+    t->n = last;
+    memset(&t->user[last], 0, sizeof(t->user[last]));
+    memset(&t->sess[last], 0, sizeof(t->sess[last]));
+    tk_users_reindex(t);
+    return true;
+}
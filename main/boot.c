@@ -0,0 +1,86 @@
+#include "boot.h"
+#include <inttypes.h>
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+typedef struct {
+    const char *name;
+    int64_t     start_us;
+    int64_t     end_us;
+} boot_span_t;
+
+static const char *TAG = "boot";
+
+static EventGroupHandle_t s_events;
+static portMUX_TYPE       s_mux = portMUX_INITIALIZER_UNLOCKED;
+static boot_span_t        s_span[BOOT_MAX_MARKS];
+static uint32_t           s_n;
+static int64_t            s_last_us;       // end of the previous sequential stage
+
+static void add_span(const char *name, int64_t start_us, int64_t end_us)
+{
+    portENTER_CRITICAL(&s_mux);
+    if (s_n < BOOT_MAX_MARKS) s_span[s_n++] = (boot_span_t){ name, start_us, end_us };
+    portEXIT_CRITICAL(&s_mux);
+}
+
+esp_err_t boot_begin(void)
+{
+    s_events = xEventGroupCreate();
+    if (!s_events) return ESP_ERR_NO_MEM;
+    s_last_us = esp_timer_get_time();
+    add_span("app_main", 0, s_last_us);
+    return ESP_OK;
+}
+
+EventGroupHandle_t boot_events(void)
+{
+    return s_events;
+}
+
+// Sequential stages (app_main): a stage runs from the previous mark to this one
+void boot_mark(const char *stage)
+{
+    int64_t now = esp_timer_get_time();
+    add_span(stage, s_last_us, now);
+    s_last_us = now;
+}
+
+static void job_task(void *arg)
+{
+    const boot_job_t *job = arg;
+    int64_t t0 = esp_timer_get_time();
+    job->fn();
+    add_span(job->name, t0, esp_timer_get_time());
+    xEventGroupSetBits(s_events, job->done_bit);
+    vTaskDelete(NULL);
+}
+
+esp_err_t boot_spawn(const boot_job_t *job)
+{
+    // job must outlive the task: callers pass static descriptors
+    BaseType_t ok = xTaskCreatePinnedToCore(job_task, job->name, job->stack, (void *)job,
+                                            job->prio, NULL, job->core);
+    return (ok == pdPASS) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+bool boot_wait(EventBits_t bits, TickType_t timeout)
+{
+    return (xEventGroupWaitBits(s_events, bits, pdFALSE, pdTRUE, timeout) & bits) == bits;
+}
+
+void boot_report(void)
+{
+    boot_span_t span[BOOT_MAX_MARKS];
+    portENTER_CRITICAL(&s_mux);
+    uint32_t n = s_n;
+    for (uint32_t i = 0; i < n; i++) span[i] = s_span[i];
+    portEXIT_CRITICAL(&s_mux);
+
+    ESP_LOGI(TAG, "%-12s %8s %8s %8s", "stage", "start", "end", "ms");
+    for (uint32_t i = 0; i < n; i++) {
+        ESP_LOGI(TAG, "%-12s %8.1f %8.1f %8.1f", span[i].name, span[i].start_us / 1000.0,
+                 span[i].end_us / 1000.0, (span[i].end_us - span[i].start_us) / 1000.0);
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+// Staged boot: timestamped stages and bring-up jobs run as short-lived tasks pinned to
+// either core. Jobs signal completion through bits in one event group, so later stages
+// wait on exactly what they need; boot_report() prints the breakdown.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOOT_MAX_MARKS  16
+
+typedef struct {
+    const char  *name;
+    void       (*fn)(void);
+    EventBits_t  done_bit;     // set once fn returns
+    BaseType_t   core;         // 0, 1 or tskNO_AFFINITY
+    uint32_t     stack;
+    UBaseType_t  prio;
+} boot_job_t;
+
+// Create the event group and take the first timestamp
+esp_err_t boot_begin(void);
+
+EventGroupHandle_t boot_events(void);
+
+// Timestamp a stage (any task); stages beyond BOOT_MAX_MARKS are dropped
+void boot_mark(const char *stage);
+
+// Run job->fn in its own task (deleted when done); start/end are recorded as a span
+esp_err_t boot_spawn(const boot_job_t *job);
+
+// Wait for all of bits (ticks); true if they were all set in time
+bool boot_wait(EventBits_t bits, TickType_t timeout);
+
+// Log every stage: start and end in ms since esp_timer start, and duration
+void boot_report(void);
+
+#ifdef __cplusplus
+}
+#endif
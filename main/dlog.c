@@ -0,0 +1,129 @@
+#include "dlog.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+_Static_assert((DLOG_DEPTH & (DLOG_DEPTH - 1)) == 0, "dlog depth must be a power of two");
+
+typedef struct {
+    _Atomic uint32_t seq;             // Vyukov slot sequence
+    uint16_t  id;
+    uint8_t   nargs;
+    uint8_t   _pad;
+    uint32_t  ts_us;                  // low 32 bits of esp_timer time
+    uintptr_t arg[DLOG_MAX_ARGS];
+} dlog_rec_t;
+
+static dlog_rec_t        s_ring[DLOG_DEPTH];
+static _Atomic uint32_t  s_enq;       // producers claim slots here
+static uint32_t          s_deq;       // formatter only
+
+static _Atomic uint32_t  s_written, s_dropped, s_hwm;
+static _Atomic uint32_t  s_dropped_by_id[DLOG_COUNT];
+static uint32_t          s_printed;
+static uint32_t          s_period_ms;
+
+// IRAM: callable from ISRs while the flash cache is off (esp_timer_get_time() and the
+// ROM memcpy are too)
+bool IRAM_ATTR dlog_write(dlog_id_t id, const uintptr_t *args, uint32_t nargs)
+{
+    if ((unsigned)id >= DLOG_COUNT) return false;
+    if (nargs > DLOG_MAX_ARGS) nargs = DLOG_MAX_ARGS;
+
+    // Bounded MPMC (Vyukov) enqueue: claim a slot whose seq equals our position
+    uint32_t pos = atomic_load_explicit(&s_enq, memory_order_relaxed);
+    dlog_rec_t *r;
+    for (;;) {
+        r = &s_ring[pos & (DLOG_DEPTH - 1)];
+        uint32_t seq = atomic_load_explicit(&r->seq, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&s_enq, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&s_dropped_by_id[id], 1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = atomic_load_explicit(&s_enq, memory_order_relaxed);
+        }
+    }
+
+    r->id    = (uint16_t)id;
+    r->nargs = (uint8_t)nargs;
+    r->ts_us = (uint32_t)esp_timer_get_time();
+    memcpy(r->arg, args, nargs * sizeof(uintptr_t));
+    atomic_store_explicit(&r->seq, pos + 1, memory_order_release);
+
+    atomic_fetch_add_explicit(&s_written, 1, memory_order_relaxed);
+    uint32_t depth = pos + 1 - s_deq;         // racy read of the consumer index: a statistic only
+    uint32_t hwm = atomic_load_explicit(&s_hwm, memory_order_relaxed);
+    while (depth <= DLOG_DEPTH && depth > hwm &&
+           !atomic_compare_exchange_weak_explicit(&s_hwm, &hwm, depth,
+                                                  memory_order_relaxed, memory_order_relaxed)) {}
+    return true;
+}
+
+static void print_rec(const dlog_rec_t *r, int64_t now_us)
+{
+    // Full timestamp from the low word, assuming the record is < 71 min old
+    int64_t ts = now_us - (int64_t)(uint32_t)((uint32_t)now_us - r->ts_us);
+    uint32_t ts_ms = (uint32_t)(ts / 1000);
+#if CONFIG_TK_DLOG_HOST_DECODE
+    char line[192];
+    if (dlog_encode(line, sizeof(line), r->id, ts_ms, r->arg, r->nargs)) fputs(line, stdout);
+#else
+    dlog_print(stdout, r->id, ts_ms, r->arg, r->nargs);
+#endif
+}
+
+static void dlog_task(void *arg)
+{
+    uint32_t reported_drops = 0;
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(s_period_ms));
+        int64_t now = esp_timer_get_time();
+        bool any = false;
+        for (;;) {
+            dlog_rec_t *r = &s_ring[s_deq & (DLOG_DEPTH - 1)];
+            if (atomic_load_explicit(&r->seq, memory_order_acquire) != s_deq + 1) break;
+            print_rec(r, now);
+            atomic_store_explicit(&r->seq, s_deq + DLOG_DEPTH, memory_order_release);
+            s_deq++;
+            s_printed++;
+            any = true;
+        }
+        uint32_t drops = atomic_load_explicit(&s_dropped, memory_order_relaxed);
+        if (drops != reported_drops) {
+            printf("\nW (%lu) tk: dlog: %lu records dropped\n", (unsigned long)(now / 1000),
+                   (unsigned long)(drops - reported_drops));
+            reported_drops = drops;
+            any = true;
+        }
+        if (any) fflush(stdout);
+    }
+}
+
+esp_err_t dlog_start(uint32_t prio, uint32_t period_ms)
+{
+    for (uint32_t i = 0; i < DLOG_DEPTH; i++) atomic_init(&s_ring[i].seq, i);
+    s_period_ms = period_ms ? period_ms : 100;
+    BaseType_t ok = xTaskCreate(dlog_task, "dlog", 3072, NULL, prio, NULL);
+    return (ok == pdPASS) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void dlog_get_stats(dlog_stats_t *out)
+{
+    out->written   = atomic_load_explicit(&s_written, memory_order_relaxed);
+    out->dropped   = atomic_load_explicit(&s_dropped, memory_order_relaxed);
+    out->printed   = s_printed;
+    out->depth_hwm = atomic_load_explicit(&s_hwm, memory_order_relaxed);
+    for (uint32_t i = 0; i < DLOG_COUNT; i++) {
+        out->dropped_by_id[i] = atomic_load_explicit(&s_dropped_by_id[i], memory_order_relaxed);
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+// Deferred binary logging. Call sites store a fixed-size record (format id, timestamp,
+// up to DLOG_MAX_ARGS word args) into a lock-free multi-producer ring; a low-priority
+// task formats and prints them later, or with CONFIG_TK_DLOG_HOST_DECODE prints them
+// undecoded for the host's dlog_decode. dlog_write() is in IRAM and never blocks, so
+// DLOG() is safe from tasks and ISRs, with the flash cache off too.
+//
+// Formats live in dlog_formats.h (compile-time table, see dlog_fmt.h for what they may
+// use). DLOG() hands the format and the args to a printf-checked call that never runs,
+// so -Wformat checks the count and the kinds of the args at every call site. %s args
+// must point to static strings (the pointer is stored, not the text): pass them as
+// DLOG_STR(s); a DLOG_CLOCK record's epoch goes in as DLOG_EPOCH(e).
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "dlog_fmt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DLOG_DEPTH      64            // records, power of two
+
+typedef struct {
+    uint32_t written;
+    uint32_t dropped;                 // ring full
+    uint32_t printed;
+    uint32_t depth_hwm;
+    uint32_t dropped_by_id[DLOG_COUNT];
+} dlog_stats_t;
+
+// Start the formatter task
+esp_err_t dlog_start(uint32_t prio, uint32_t period_ms);
+
+// Record (use DLOG()); false when the ring is full
+bool dlog_write(dlog_id_t id, const uintptr_t *args, uint32_t nargs);
+
+void dlog_get_stats(dlog_stats_t *out);
+
+#define DLOG_STR(s)     ((const char *)(s))
+#define DLOG_EPOCH(e)   ((const char *)(uintptr_t)(uint32_t)(e))     // printed as the date in the first %s
+
+// Never called: gives -Wformat the literal format and the args. long and int are one
+// word on the target, as are their unsigned forms (uint32_t is unsigned long there).
+static inline __attribute__((format(printf, 1, 2), unused)) void dlog_check_(const char *fmt, ...) { (void)fmt; }
+#define DLOG_C_(x)      _Generic((x), long: 0, unsigned long: 0u, default: (x))
+#define DLOG_W_(x)      ((uintptr_t)(x))
+
+// DLOG_MAP_(f, a, b, ...) -> , f(a), f(b) ... for up to DLOG_MAX_ARGS args
+#define DLOG_CAT_(a, b)  a##b
+#define DLOG_XCAT_(a, b) DLOG_CAT_(a, b)
+#define DLOG_N_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define DLOG_NARGS_(...) DLOG_N_(_, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define DLOG_MAP_0(f)
+#define DLOG_MAP_1(f, a)      , f(a)
+#define DLOG_MAP_2(f, a, ...) , f(a) DLOG_MAP_1(f, __VA_ARGS__)
+#define DLOG_MAP_3(f, a, ...) , f(a) DLOG_MAP_2(f, __VA_ARGS__)
+#define DLOG_MAP_4(f, a, ...) , f(a) DLOG_MAP_3(f, __VA_ARGS__)
+#define DLOG_MAP_5(f, a, ...) , f(a) DLOG_MAP_4(f, __VA_ARGS__)
+#define DLOG_MAP_6(f, a, ...) , f(a) DLOG_MAP_5(f, __VA_ARGS__)
+#define DLOG_MAP_7(f, a, ...) , f(a) DLOG_MAP_6(f, __VA_ARGS__)
+#define DLOG_MAP_8(f, a, ...) , f(a) DLOG_MAP_7(f, __VA_ARGS__)
+#define DLOG_MAP_(f, ...) DLOG_XCAT_(DLOG_MAP_, DLOG_NARGS_(__VA_ARGS__))(f, ##__VA_ARGS__)
+
+// `id` must be a DLOG_* name (its format is id##_FMT); more than DLOG_MAX_ARGS args
+// does not expand
+#define DLOG(id, ...) do {                                                          \
+        if (0) dlog_check_(id##_FMT DLOG_MAP_(DLOG_C_, ##__VA_ARGS__));             \
+        const uintptr_t dlog_a_[] = { 0 DLOG_MAP_(DLOG_W_, ##__VA_ARGS__) };        \
+        (void)dlog_write((id), dlog_a_ + 1, sizeof(dlog_a_) / sizeof(dlog_a_[0]) - 1); \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,145 @@
+#include "dlog_fmt.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tk_civil.h"
+
+#define DLOG_ID(name, kind) [name] = { kind, name##_FMT },
+const dlog_fmt_t dlog_fmt[DLOG_COUNT] = {
+#include "dlog_formats.h"
+};
+#undef DLOG_ID
+
+// Conversion at *p ('%' ...): its length and conversion character ('%' for "%%")
+static size_t conv_len(const char *p, char *conv)
+{
+    size_t n = 1 + strspn(p + 1, "-+ #0123456789.");
+    *conv = p[n];
+    return p[n] ? n + 1 : n;
+}
+
+// Arg i is text on the wire: a %s conversion, except a clock record's epoch
+static bool arg_is_str(uint32_t id, uint32_t i)
+{
+    const dlog_fmt_t *f = &dlog_fmt[id];
+    if (f->kind == DLOG_CLOCK && i == 0) return false;
+    uint32_t k = 0;
+    for (const char *p = strchr(f->fmt, '%'); p; p = strchr(p, '%')) {
+        char conv;
+        p += conv_len(p, &conv);
+        if (conv == '%') continue;
+        if (k++ == i) return conv == 's';
+    }
+    return false;
+}
+
+void dlog_print(FILE *out, uint32_t id, uint32_t ts_ms, const uintptr_t *arg, uint32_t nargs)
+{
+    if (id >= DLOG_COUNT) return;
+    const dlog_fmt_t *f = &dlog_fmt[id];
+
+    char clock[40] = "";
+    if (f->kind == DLOG_CLOCK && nargs) {
+        struct tm t;
+        tk_civil_from_epoch((int64_t)(uint32_t)arg[0], TK_CIVIL_IST_OFFSET, &t);
+        strftime(clock, sizeof(clock), "%I:%M:%S %p %d-%m-%Y IST", &t);
+    }
+    if (f->kind == DLOG_INFO || f->kind == DLOG_WARN) {
+        fprintf(out, "%c (%lu) tk: ", f->kind == DLOG_WARN ? 'W' : 'I', (unsigned long)ts_ms);
+    }
+
+    // One conversion at a time, each with its own type
+    const char *p = f->fmt;
+    uint32_t i = 0;
+    for (const char *c; (c = strchr(p, '%')) != NULL;) {
+        fwrite(p, 1, (size_t)(c - p), out);
+        char conv, spec[16];
+        size_t n = conv_len(c, &conv);
+        p = c + n;
+        if (conv == '%') { putc('%', out); continue; }
+        if (n >= sizeof(spec)) n = sizeof(spec) - 1;
+        memcpy(spec, c, n);
+        spec[n] = '\0';
+        uintptr_t a = i < nargs ? arg[i] : 0;
+        if (conv == 's') {
+            const char *s = (f->kind == DLOG_CLOCK && i == 0) ? clock : (const char *)a;
+            fprintf(out, spec, s ? s : "(null)");
+        } else if (conv == 'd' || conv == 'i' || conv == 'c') {
+            fprintf(out, spec, (int)a);
+        } else {
+            fprintf(out, spec, (unsigned)a);
+        }
+        i++;
+    }
+    fputs(p, out);
+    if (f->kind == DLOG_INFO || f->kind == DLOG_WARN) putc('\n', out);
+}
+
+size_t dlog_encode(char *buf, size_t size, uint32_t id, uint32_t ts_ms, const uintptr_t *arg, uint32_t nargs)
+{
+    if (id >= DLOG_COUNT || nargs > DLOG_MAX_ARGS) return 0;
+    size_t n = 0;
+    int r = snprintf(buf, size, "#dlog %lu %lx", (unsigned long)id, (unsigned long)ts_ms);
+    if (r < 0 || (size_t)r >= size) return 0;
+    n = (size_t)r;
+    for (uint32_t i = 0; i < nargs; i++) {
+        if (arg_is_str(id, i)) {
+            const char *s = arg[i] ? (const char *)arg[i] : "(null)";
+            size_t len = strnlen(s, DLOG_STR_MAX);
+            if (n + 2 + 2 * len >= size) return 0;
+            buf[n++] = ' ';
+            buf[n++] = 's';
+            for (size_t k = 0; k < len; k++) n += (size_t)snprintf(buf + n, size - n, "%02x", (uint8_t)s[k]);
+        } else {
+            r = snprintf(buf + n, size - n, " %lx", (unsigned long)(uint32_t)arg[i]);
+            if (r < 0 || (size_t)r >= size - n) return 0;
+            n += (size_t)r;
+        }
+    }
+    if (n + 2 > size) return 0;
+    buf[n++] = '\n';
+    buf[n] = '\0';
+    return n;
+}
+
+static int hexval(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool dlog_decode(const char *line, dlog_line_t *out)
+{
+    if (strncmp(line, "#dlog ", 6) != 0) return false;
+    memset(out, 0, sizeof(*out));
+    char *end;
+    unsigned long id = strtoul(line + 6, &end, 10);
+    if (end == line + 6 || *end != ' ' || id >= DLOG_COUNT) return false;
+    const char *p = end + 1;
+    unsigned long ts = strtoul(p, &end, 16);
+    if (end == p) return false;
+    out->id    = (uint32_t)id;
+    out->ts_ms = (uint32_t)ts;
+    for (p = end; *p == ' ';) {
+        p++;
+        if (out->nargs == DLOG_MAX_ARGS) return false;
+        uint32_t i = out->nargs++;
+        if (*p == 's') {
+            size_t len = 0;
+            for (p++; hexval(p[0]) >= 0 && hexval(p[1]) >= 0; p += 2) {
+                if (len == DLOG_STR_MAX) return false;
+                out->str[i][len++] = (char)(hexval(p[0]) << 4 | hexval(p[1]));
+            }
+            out->arg[i] = (uintptr_t)out->str[i];
+        } else {
+            unsigned long w = strtoul(p, &end, 16);
+            if (end == p) return false;
+            out->arg[i] = (uintptr_t)(uint32_t)w;
+            p = end;
+        }
+    }
+    // a whole line only: a capture cut mid-record has no end of line
+    return *p == '\n' || (p[0] == '\r' && p[1] == '\n');
+}
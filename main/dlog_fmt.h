@@ -0,0 +1,64 @@
+#pragma once
+// Deferred log records: format table, record printing, and the "#dlog" text line the
+// firmware can emit instead of formatting (CONFIG_TK_DLOG_HOST_DECODE).
+// Plain C, no ESP-IDF dependencies: the dlog task uses it on target and the host
+// decoder (components/tk_core, dlog_decode) builds it unchanged.
+//
+// Formats take word-sized args only: %d/%i/%c print an int, %u/%x/%X an unsigned, %s a
+// string. Flags, width and precision are fine; length modifiers are not.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DLOG_MAX_ARGS   8
+#define DLOG_STR_MAX    32            // %s text carried by a "#dlog" line
+
+typedef enum {
+    DLOG_RAW,                         // printed as-is
+    DLOG_INFO,                        // "I (ms) tk: ...\n"
+    DLOG_WARN,                        // "W (ms) tk: ...\n"
+    DLOG_CLOCK,                       // raw; arg 0 is an epoch, printed as IST date/time in the first %s
+} dlog_kind_t;
+
+#define DLOG_ID(name, kind) name,
+typedef enum {
+#include "dlog_formats.h"
+    DLOG_COUNT
+} dlog_id_t;
+#undef DLOG_ID
+
+typedef struct {
+    uint8_t     kind;                 // dlog_kind_t
+    const char *fmt;
+} dlog_fmt_t;
+
+extern const dlog_fmt_t dlog_fmt[DLOG_COUNT];
+
+// Print one record (args as stored by dlog_write(); %s args are pointers)
+void dlog_print(FILE *out, uint32_t id, uint32_t ts_ms, const uintptr_t *arg, uint32_t nargs);
+
+// "#dlog <id> <ts_ms> <arg>...\n": words in hex, %s args as 's' + the text in hex (at
+// most DLOG_STR_MAX bytes). Returns the length, 0 if it does not fit.
+size_t dlog_encode(char *buf, size_t size, uint32_t id, uint32_t ts_ms, const uintptr_t *arg, uint32_t nargs);
+
+// A decoded line; arg[] points into str[] for %s args
+typedef struct {
+    uint32_t  id;
+    uint32_t  ts_ms;
+    uint32_t  nargs;
+    uintptr_t arg[DLOG_MAX_ARGS];
+    char      str[DLOG_MAX_ARGS][DLOG_STR_MAX + 1];
+} dlog_line_t;
+
+// false unless `line` is a whole, well-formed "#dlog" line (with its \n) for a known id
+bool dlog_decode(const char *line, dlog_line_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,48 @@
+// Deferred log formats. DLOG_ID(name, kind) is the table, included by dlog_fmt.h/dlog_fmt.c
+// with DLOG_ID redefined (no include guard on the table on purpose); each name's format
+// is the string macro name##_FMT, which DLOG() also hands to a printf-checked shadow call.
+
+#ifndef DLOG_FORMATS_FMT_
+#define DLOG_FORMATS_FMT_
+#define DLOG_STATUS_FMT        "\r\x1b[K%s | Rem %02u:%02u | %s | %u/%u running"
+#define DLOG_STA_CONNECTED_FMT "STA connected: %02X:%02X:%02X:%02X:%02X:%02X AID=%u"
+#define DLOG_STA_GONE_FMT      "STA disconnected: %02X:%02X:%02X:%02X:%02X:%02X AID=%u"
+#define DLOG_HELD_FMT          "STA %02X:%02X:%02X:%02X:%02X:%02X held until its signal is near (AID=%u)"
+#define DLOG_RSSI_NEAR_FMT     "STA %02X:%02X:%02X:%02X:%02X:%02X near (%d dBm smoothed)"
+#define DLOG_RSSI_FAR_FMT      "STA %02X:%02X:%02X:%02X:%02X:%02X far (%d dBm smoothed)"
+#define DLOG_UNKNOWN_STA_FMT   "Unknown device ignored (user table full, or stored MAC differs after check-in)"
+#define DLOG_ENROLLED_FMT      "User %d enrolled (%u total): %02X:%02X:%02X:%02X:%02X:%02X"
+#define DLOG_EVICTED_FMT       "User %d slot reused: previous phone not checked in for %u+ days"
+#define DLOG_CHECKED_IN_FMT    "User %d checked in: starting today's countdown"
+#define DLOG_ALREADY_FMT       "User %d already started today"
+#define DLOG_PAUSED_FMT        "User %d away since %02u:%02u: session %u min, %u min on site today"
+#define DLOG_RESUMED_FMT       "User %d back: countdown resumed"
+#define DLOG_SNIFFED_FMT       "User %d checked in (sniffed), rssi %d dBm, subtype 0x%X"
+#define DLOG_DEAUTH_SCHED_FMT  "Scheduling deauth in %u ms (AID=%u)"
+#define DLOG_DEAUTH_NONE_FMT   "Deauth not scheduled (policy/state)"
+#define DLOG_DEAUTH_SENT_FMT   "Deauth sent (delayed) to AID=%u %02X:%02X:%02X:%02X:%02X:%02X"
+#define DLOG_DEAUTH_FAIL_FMT   "deauth (AID=%u) failed: %s"
+#define DLOG_DEAUTH_FULL_FMT   "deauth queue full (AID=%u)"
+#define DLOG_RTC_FAIL_FMT      "\r\x1b[KRTC read failed..."
+#endif
+
+DLOG_ID(DLOG_STATUS,        DLOG_CLOCK)
+DLOG_ID(DLOG_STA_CONNECTED, DLOG_INFO)
+DLOG_ID(DLOG_STA_GONE,      DLOG_INFO)
+DLOG_ID(DLOG_HELD,          DLOG_INFO)
+DLOG_ID(DLOG_RSSI_NEAR,     DLOG_INFO)
+DLOG_ID(DLOG_RSSI_FAR,      DLOG_INFO)
+DLOG_ID(DLOG_UNKNOWN_STA,   DLOG_WARN)
+DLOG_ID(DLOG_ENROLLED,      DLOG_INFO)
+DLOG_ID(DLOG_EVICTED,       DLOG_INFO)
+DLOG_ID(DLOG_CHECKED_IN,    DLOG_INFO)
+DLOG_ID(DLOG_ALREADY,       DLOG_INFO)
+DLOG_ID(DLOG_PAUSED,        DLOG_INFO)
+DLOG_ID(DLOG_RESUMED,       DLOG_INFO)
+DLOG_ID(DLOG_SNIFFED,       DLOG_INFO)
+DLOG_ID(DLOG_DEAUTH_SCHED,  DLOG_INFO)
+DLOG_ID(DLOG_DEAUTH_NONE,   DLOG_INFO)
+DLOG_ID(DLOG_DEAUTH_SENT,   DLOG_INFO)
+DLOG_ID(DLOG_DEAUTH_FAIL,   DLOG_WARN)
+DLOG_ID(DLOG_DEAUTH_FULL,   DLOG_WARN)
+DLOG_ID(DLOG_RTC_FAIL,      DLOG_RAW)
@@ -1,7 +1,11 @@
 #include "ds3231.h"
 #include <string.h>
-#include "driver/i2c.h"
+#include "driver/i2c_master.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
 
 #define DS3231_ADDR         0x68
 #define REG_SECONDS         0x00
@@ -11,63 +15,65 @@
 #define REG_DATE            0x04
 #define REG_MONTH           0x05
 #define REG_YEAR            0x06
+#define REG_CONTROL         0x0E
+#define REG_STATUS          0x0F
+#define REG_AGING           0x10
 #define REG_TEMP_MSB        0x11
 #define REG_TEMP_LSB        0x12
 
+#define I2C_TIMEOUT_MS      50
+#define I2C_QUEUE_DEPTH     4                 // >0 puts the bus in async mode
+
 static const char *TAG = "ds3231";
-static i2c_port_t s_port = I2C_NUM_0;
 
-static inline uint8_t bcd2bin(uint8_t v) { return (v & 0x0F) + 10 * ((v >> 4) & 0x0F); }
-static inline uint8_t bin2bcd(uint8_t v) { return (uint8_t)(((v / 10) << 4) | (v % 10)); }
+static i2c_master_bus_handle_t s_bus;
+static i2c_master_dev_handle_t s_dev;
+static bool                    s_async;       // completion callbacks registered
 
-esp_err_t ds3231_init(const ds3231_config_t *cfg)
-{
-    if (!cfg) return ESP_ERR_INVALID_ARG;
-    s_port = cfg->port;
-
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
-        .sda_io_num = cfg->sda,
-        .scl_io_num = cfg->scl,
-        // Most DS3231 modules already have 3.3V pull-ups onboard:
-        .sda_pullup_en = GPIO_PULLUP_DISABLE,
-        .scl_pullup_en = GPIO_PULLUP_DISABLE,
-        .master.clk_speed = cfg->clk_hz,
-        .clk_flags = 0
-    };
+// One transaction in flight on s_dev. s_xfer_free is a binary semaphore (not a
+// mutex) so the completion ISR can release it for ds3231_get_time_async().
+static SemaphoreHandle_t  s_xfer_free;
+static SemaphoreHandle_t  s_xfer_done;
+static volatile bool      s_xfer_ok;
+static ds3231_time_cb_t   s_async_cb;
+static void              *s_async_ctx;
+static uint8_t            s_async_reg = REG_SECONDS;
+static uint8_t            s_async_buf[DS3231_SNAPSHOT_REGS];
+static uint8_t            s_xfer_w[8];   // register pointer + a full time/alarm write
+static uint8_t            s_xfer_r[DS3231_SNAPSHOT_REGS];
+static volatile uint32_t  s_txn_count;
 
-    esp_err_t err = i2c_param_config(s_port, &conf);
-    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
-        ESP_LOGE(TAG, "i2c_param_config failed: %s", esp_err_to_name(err));
-        return err;
-    }
+// Most recent burst read; the getters are views over it
+static portMUX_TYPE       s_snap_mux = portMUX_INITIALIZER_UNLOCKED;
+static ds3231_snapshot_t  s_snap;
+static bool               s_snap_valid;
 
-    err = i2c_driver_install(s_port, I2C_MODE_MASTER, 0, 0, 0);
-    if (err == ESP_ERR_INVALID_STATE) {
-        // already installed → OK
-        err = ESP_OK;
-    }
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "i2c_driver_install failed: %s", esp_err_to_name(err));
-        return err;
-    }
+// Control register bits
+#define CTRL_RS2            0x10
+#define CTRL_RS1            0x08
+#define CTRL_INTCN          0x04
 
-    return ESP_OK;
-}
+// Status register bits
+#define STAT_OSF            0x80
+#define STAT_BSY            0x04
 
-esp_err_t ds3231_get_time(struct tm *out)
-{
-    if (!out) return ESP_ERR_INVALID_ARG;
+// SQW tick state (written by the ISR)
+static portMUX_TYPE s_sqw_mux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_sqw_task;
+static time_t       s_sqw_epoch;
+static int64_t      s_sqw_edge_us;
+static volatile bool s_sqw_edge_seen;
+static gpio_num_t   s_sqw_pin = GPIO_NUM_NC;
+#if CONFIG_TK_PM_LIGHT_SLEEP
+static volatile bool s_sqw_wake;             // pin doubles as a light-sleep wake source
+static esp_timer_handle_t s_sqw_rearm;
+#endif
 
-    uint8_t reg = REG_SECONDS;
-    uint8_t b[7] = {0};
-    esp_err_t err = i2c_master_write_read_device(
-        s_port, DS3231_ADDR, &reg, 1, b, sizeof(b), pdMS_TO_TICKS(1000));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Read time failed: %s", esp_err_to_name(err));
-        return err;
-    }
+static inline uint8_t bcd2bin(uint8_t v) { return (v & 0x0F) + 10 * ((v >> 4) & 0x0F); }
+static inline uint8_t bin2bcd(uint8_t v) { return (uint8_t)(((v / 10) << 4) | (v % 10)); }
 
+static void decode_time(const uint8_t b[7], struct tm *out)
+{
     int sec = bcd2bin(b[0] & 0x7F);
     int min = bcd2bin(b[1] & 0x7F);
 
@@ -94,10 +100,218 @@ esp_err_t ds3231_get_time(struct tm *out)
     out->tm_mon  = mon;
     out->tm_year = y1900;
     // tm_wday and others can be derived by mktime() if needed.
+}
+
+// Integer-only so it can run in the completion ISR
+static void decode_snapshot(const uint8_t raw[DS3231_SNAPSHOT_REGS], int64_t taken_us,
+                            ds3231_snapshot_t *out)
+{
+    memcpy(out->raw, raw, DS3231_SNAPSHOT_REGS);
+    decode_time(raw, &out->time);
+    out->control  = raw[REG_CONTROL];
+    out->status   = raw[REG_STATUS];
+    out->osf      = (raw[REG_STATUS] & STAT_OSF) != 0;
+    out->busy     = (raw[REG_STATUS] & STAT_BSY) != 0;
+    out->aging    = (int8_t)raw[REG_AGING];
+    // Temp: MSB is integer, high 2 bits of LSB are fractional (.25 steps)
+    out->temp_qc  = (int16_t)(((int8_t)raw[REG_TEMP_MSB] * 4) + (raw[REG_TEMP_LSB] >> 6));
+    out->taken_us = taken_us;
+}
+
+static void publish_snapshot(const ds3231_snapshot_t *snap)
+{
+    portENTER_CRITICAL_SAFE(&s_snap_mux);
+    s_snap       = *snap;
+    s_snap_valid = true;
+    portEXIT_CRITICAL_SAFE(&s_snap_mux);
+}
+
+// Completion ISR: wake the blocked caller, or finish an async read
+static bool on_trans_done(i2c_master_dev_handle_t dev, const i2c_master_event_data_t *ev, void *arg)
+{
+    BaseType_t woken = pdFALSE;
+    s_xfer_ok = (ev->event == I2C_EVENT_DONE);
+
+    if (s_async_cb) {
+        ds3231_time_cb_t cb = s_async_cb;
+        s_async_cb = NULL;
+        ds3231_snapshot_t snap;
+        if (s_xfer_ok) {
+            decode_snapshot(s_async_buf, esp_timer_get_time(), &snap);
+            publish_snapshot(&snap);
+        }
+        cb(s_xfer_ok ? ESP_OK : ESP_FAIL, s_xfer_ok ? &snap.time : NULL, s_async_ctx);
+        xSemaphoreGiveFromISR(s_xfer_free, &woken);
+    } else {
+        xSemaphoreGiveFromISR(s_xfer_done, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+static inline esp_err_t start_xfer(const uint8_t *w, size_t wl, uint8_t *r, size_t rl)
+{
+    s_txn_count++;
+    return rl ? i2c_master_transmit_receive(s_dev, w, wl, r, rl, I2C_TIMEOUT_MS)
+              : i2c_master_transmit(s_dev, w, wl, I2C_TIMEOUT_MS);
+}
+
+// A completion that never came: the driver may still own s_xfer_w/s_xfer_r and would
+// give s_xfer_done to the next caller, so wait the transaction out (or reset the bus)
+// before anyone else may start one
+static void xfer_abandon(void)
+{
+    if (i2c_master_bus_wait_all_done(s_bus, I2C_TIMEOUT_MS) != ESP_OK) {
+        ESP_LOGW(TAG, "transaction stuck, resetting the bus");
+        (void)i2c_master_bus_reset(s_bus);
+    }
+    xSemaphoreTake(s_xfer_done, 0);
+}
+
+// Blocking transaction: only the calling task waits, the bus stays free for other devices.
+// In async mode the driver works on s_xfer_w/s_xfer_r (never the caller's stack), and r
+// is filled only when the read completed.
+static esp_err_t xfer(const uint8_t *w, size_t wl, uint8_t *r, size_t rl)
+{
+    if (!s_dev) return ESP_ERR_INVALID_STATE;
+    if (!s_async) return start_xfer(w, wl, r, rl);
+    if (wl > sizeof(s_xfer_w) || rl > sizeof(s_xfer_r)) return ESP_ERR_INVALID_SIZE;
+
+    if (xSemaphoreTake(s_xfer_free, pdMS_TO_TICKS(I2C_TIMEOUT_MS)) != pdTRUE) return ESP_ERR_TIMEOUT;
+    xSemaphoreTake(s_xfer_done, 0);             // drop a stale completion
+    memcpy(s_xfer_w, w, wl);
+    esp_err_t err = start_xfer(s_xfer_w, wl, rl ? s_xfer_r : NULL, rl);
+    if (err == ESP_OK) {
+        if (xSemaphoreTake(s_xfer_done, pdMS_TO_TICKS(I2C_TIMEOUT_MS)) != pdTRUE) {
+            err = ESP_ERR_TIMEOUT;
+            xfer_abandon();
+        } else if (!s_xfer_ok) {
+            err = ESP_FAIL;
+        } else if (rl) {
+            memcpy(r, s_xfer_r, rl);
+        }
+    }
+    xSemaphoreGive(s_xfer_free);
+    return err;
+}
+
+esp_err_t ds3231_init(const ds3231_config_t *cfg)
+{
+    if (!cfg) return ESP_ERR_INVALID_ARG;
+    if (s_dev) return ESP_OK;
+
+    esp_err_t err;
+    s_bus = cfg->bus;
+    if (!s_bus) {
+        i2c_master_bus_config_t bus_cfg = {
+            .i2c_port          = cfg->port,
+            .sda_io_num        = cfg->sda,
+            .scl_io_num        = cfg->scl,
+            .clk_source        = I2C_CLK_SRC_DEFAULT,
+            .glitch_ignore_cnt = 7,
+            .trans_queue_depth = I2C_QUEUE_DEPTH,
+            // Most DS3231 modules already have 3.3V pull-ups onboard:
+            .flags.enable_internal_pullup = false,
+        };
+        err = i2c_new_master_bus(&bus_cfg, &s_bus);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "i2c_new_master_bus failed: %s", esp_err_to_name(err));
+            return err;
+        }
+    }
+
+    err = i2c_master_probe(s_bus, DS3231_ADDR, I2C_TIMEOUT_MS);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "no device at 0x%02X: %s", DS3231_ADDR, esp_err_to_name(err));
+        return err;
+    }
+
+    i2c_device_config_t dev_cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address  = DS3231_ADDR,
+        .scl_speed_hz    = cfg->clk_hz,
+    };
+    err = i2c_master_bus_add_device(s_bus, &dev_cfg, &s_dev);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "i2c_master_bus_add_device failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    s_xfer_free = xSemaphoreCreateBinary();
+    s_xfer_done = xSemaphoreCreateBinary();
+    if (!s_xfer_free || !s_xfer_done) return ESP_ERR_NO_MEM;
+    xSemaphoreGive(s_xfer_free);
+
+    // A shared bus created without a transaction queue stays synchronous
+    i2c_master_event_callbacks_t cbs = { .on_trans_done = on_trans_done };
+    s_async = (i2c_master_register_event_callbacks(s_dev, &cbs, NULL) == ESP_OK);
 
     return ESP_OK;
 }
 
+i2c_master_bus_handle_t ds3231_get_bus(void)
+{
+    return s_bus;
+}
+
+uint32_t ds3231_get_txn_count(void)
+{
+    return s_txn_count;
+}
+
+esp_err_t ds3231_read_snapshot(ds3231_snapshot_t *out)
+{
+    uint8_t reg = REG_SECONDS;
+    uint8_t raw[DS3231_SNAPSHOT_REGS] = {0};
+    esp_err_t err = xfer(&reg, 1, raw, sizeof(raw));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Snapshot read failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    ds3231_snapshot_t snap;
+    decode_snapshot(raw, esp_timer_get_time(), &snap);
+    publish_snapshot(&snap);
+    if (out) *out = snap;
+    return ESP_OK;
+}
+
+esp_err_t ds3231_get_last_snapshot(ds3231_snapshot_t *out)
+{
+    if (!out) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&s_snap_mux);
+    bool valid = s_snap_valid;
+    if (valid) *out = s_snap;
+    portEXIT_CRITICAL(&s_snap_mux);
+    return valid ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t ds3231_get_time(struct tm *out)
+{
+    if (!out) return ESP_ERR_INVALID_ARG;
+
+    ds3231_snapshot_t snap;
+    esp_err_t err = ds3231_read_snapshot(&snap);
+    if (err != ESP_OK) return err;
+    *out = snap.time;
+    return ESP_OK;
+}
+
+esp_err_t ds3231_get_time_async(ds3231_time_cb_t cb, void *ctx)
+{
+    if (!cb) return ESP_ERR_INVALID_ARG;
+    if (!s_async) return ESP_ERR_NOT_SUPPORTED;
+    if (xSemaphoreTake(s_xfer_free, 0) != pdTRUE) return ESP_ERR_INVALID_STATE;
+
+    s_async_ctx = ctx;
+    s_async_cb  = cb;
+    esp_err_t err = start_xfer(&s_async_reg, 1, s_async_buf, sizeof(s_async_buf));
+    if (err != ESP_OK) {
+        s_async_cb = NULL;
+        xSemaphoreGive(s_xfer_free);
+    }
+    return err;
+}
+
 esp_err_t ds3231_set_time(const struct tm *in)
 {
     if (!in) return ESP_ERR_INVALID_ARG;
@@ -123,30 +337,210 @@ esp_err_t ds3231_set_time(const struct tm *in)
     }
     w[7] = bin2bcd((uint8_t)y2000);
 
-    esp_err_t err = i2c_master_write_to_device(
-        s_port, DS3231_ADDR, w, sizeof(w), pdMS_TO_TICKS(1000));
+    esp_err_t err = xfer(w, sizeof(w), NULL, 0);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Write time failed: %s", esp_err_to_name(err));
+        return err;
     }
-    return err;
+    // time is valid again
+    return ds3231_clear_osf();
 }
 
 esp_err_t ds3231_get_temperature(float *out_c)
 {
     if (!out_c) return ESP_ERR_INVALID_ARG;
 
-    uint8_t reg = REG_TEMP_MSB;
-    uint8_t b[2] = {0};
-    esp_err_t err = i2c_master_write_read_device(
-        s_port, DS3231_ADDR, &reg, 1, b, 2, pdMS_TO_TICKS(1000));
+    // The chip converts every 64 s, so the latest snapshot is as good as a fresh read
+    ds3231_snapshot_t snap;
+    esp_err_t err = ds3231_get_last_snapshot(&snap);
+    if (err != ESP_OK) err = ds3231_read_snapshot(&snap);
+    if (err != ESP_OK) return err;
+
+    *out_c = snap.temp_qc * 0.25f;
+    return ESP_OK;
+}
+
+esp_err_t ds3231_clear_osf(void)
+{
+    uint8_t reg = REG_STATUS, st = 0;
+    esp_err_t err = xfer(&reg, 1, &st, 1);
+    if (err != ESP_OK) return err;
+    if (!(st & STAT_OSF)) return ESP_OK;
+
+    uint8_t w[2] = { REG_STATUS, (uint8_t)(st & ~STAT_OSF) };
+    err = xfer(w, sizeof(w), NULL, 0);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Read temperature failed: %s", esp_err_to_name(err));
+        ESP_LOGE(TAG, "Clear OSF failed: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+// ================ 1 Hz SQW ================
+// The seconds register advances on the falling edge of the 1 Hz output.
+// Light sleep only wakes on GPIO levels, and arming a pin for wakeup also makes its
+// interrupt level-triggered. In wake mode the pin is therefore armed LOW_LEVEL while
+// SQW is high, disarmed by the ISR at the falling edge (so the low half neither
+// re-interrupts nor blocks sleep) and re-armed by a timer in the next high half.
+// Built only with CONFIG_TK_PM_LIGHT_SLEEP; otherwise the pin stays NEGEDGE.
+#define SQW_REARM_US        600000
+#define SQW_REARM_RETRY_US  50000
+
+static void sqw_isr(void *arg)
+{
+    int64_t now = esp_timer_get_time();
+#if CONFIG_TK_PM_LIGHT_SLEEP
+    if (s_sqw_wake) {
+        gpio_wakeup_disable(s_sqw_pin);
+        esp_timer_start_once(s_sqw_rearm, SQW_REARM_US);
+    }
+#endif
+    portENTER_CRITICAL_ISR(&s_sqw_mux);
+    if (s_sqw_epoch) s_sqw_epoch++;
+    s_sqw_edge_us = now;
+    portEXIT_CRITICAL_ISR(&s_sqw_mux);
+    s_sqw_edge_seen = true;
+
+    if (s_sqw_task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(s_sqw_task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+#if CONFIG_TK_PM_LIGHT_SLEEP
+static void sqw_rearm_cb(void *arg)
+{
+    if (!s_sqw_wake) return;
+    // Still low (edge came late): arming now would count a second edge
+    if (gpio_get_level(s_sqw_pin) == 0) {
+        esp_timer_start_once(s_sqw_rearm, SQW_REARM_RETRY_US);
+        return;
+    }
+    gpio_wakeup_enable(s_sqw_pin, GPIO_INTR_LOW_LEVEL);
+}
+
+esp_err_t ds3231_sqw_set_wakeup(bool enable)
+{
+    if (s_sqw_pin == GPIO_NUM_NC) return ESP_ERR_INVALID_STATE;
+    if (!s_sqw_rearm) {
+        const esp_timer_create_args_t targs = {
+            .callback        = sqw_rearm_cb,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name            = "sqw_rearm",
+        };
+        esp_err_t err = esp_timer_create(&targs, &s_sqw_rearm);
+        if (err != ESP_OK) return err;
+    }
+
+    if (enable) {
+        esp_err_t err = esp_sleep_enable_gpio_wakeup();
+        if (err != ESP_OK) return err;
+        s_sqw_wake = true;
+        sqw_rearm_cb(NULL);                   // arms now if high, else retries shortly
+    } else {
+        s_sqw_wake = false;
+        esp_timer_stop(s_sqw_rearm);
+        gpio_wakeup_disable(s_sqw_pin);
+        gpio_set_intr_type(s_sqw_pin, GPIO_INTR_NEGEDGE);
+    }
+    ESP_LOGI(TAG, "SQW light-sleep wake %s", enable ? "on" : "off");
+    return ESP_OK;
+}
+#else
+esp_err_t ds3231_sqw_set_wakeup(bool enable)
+{
+    (void)enable;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+#endif
+
+esp_err_t ds3231_sqw_resync(void)
+{
+    struct tm t;
+    esp_err_t err = ds3231_get_time(&t);
+    if (err != ESP_OK) return err;
+    time_t epoch = mktime(&t);
+
+    portENTER_CRITICAL(&s_sqw_mux);
+    s_sqw_epoch = epoch;
+    portEXIT_CRITICAL(&s_sqw_mux);
+    return ESP_OK;
+}
+
+time_t ds3231_sqw_epoch(void)
+{
+    portENTER_CRITICAL(&s_sqw_mux);
+    time_t e = s_sqw_epoch;
+    portEXIT_CRITICAL(&s_sqw_mux);
+    return e;
+}
+
+esp_err_t ds3231_sqw_last_edge(time_t *epoch, int64_t *edge_us)
+{
+    if (!epoch || !edge_us) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&s_sqw_mux);
+    *epoch   = s_sqw_epoch;
+    *edge_us = s_sqw_edge_us;
+    portEXIT_CRITICAL(&s_sqw_mux);
+    return (*epoch && *edge_us) ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t ds3231_sqw_start(gpio_num_t pin, TaskHandle_t notify)
+{
+    if (pin < 0) return ESP_ERR_INVALID_ARG;
+
+    // INTCN=0 selects the square wave, RS2:RS1=00 selects 1 Hz
+    uint8_t reg = REG_CONTROL, ctrl = 0;
+    esp_err_t err = xfer(&reg, 1, &ctrl, 1);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Read control failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    uint8_t w[2] = { REG_CONTROL, (uint8_t)(ctrl & ~(CTRL_RS2 | CTRL_RS1 | CTRL_INTCN)) };
+    err = xfer(w, sizeof(w), NULL, 0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Write control failed: %s", esp_err_to_name(err));
         return err;
     }
 
-    // Temp: MSB is integer, high 2 bits of LSB are fractional (.25 steps)
-    int8_t  msb = (int8_t)b[0];
-    uint8_t lsb = b[1] >> 6;       // top 2 bits
-    *out_c = (float)msb + (lsb * 0.25f);
+    // SQW is open-drain
+    gpio_config_t io = {
+        .pin_bit_mask = 1ULL << pin,
+        .mode         = GPIO_MODE_INPUT,
+        .pull_up_en   = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type    = GPIO_INTR_NEGEDGE
+    };
+    err = gpio_config(&io);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "SQW GPIO%d config failed: %s", (int)pin, esp_err_to_name(err));
+        return err;
+    }
+
+    err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) return err;
+
+    s_sqw_task      = NULL;
+    s_sqw_epoch     = 0;
+    s_sqw_edge_seen = false;
+    err = gpio_isr_handler_add(pin, sqw_isr, NULL);
+    if (err != ESP_OK) return err;
+
+    // Seed right after an edge so the cached second is phase-aligned with the RTC
+    for (int i = 0; i < 110 && !s_sqw_edge_seen; i++) vTaskDelay(pdMS_TO_TICKS(10));
+    if (!s_sqw_edge_seen) {
+        ESP_LOGW(TAG, "No SQW edge on GPIO%d", (int)pin);
+        gpio_isr_handler_remove(pin);
+        return ESP_ERR_TIMEOUT;
+    }
+    err = ds3231_sqw_resync();
+    if (err != ESP_OK) {
+        gpio_isr_handler_remove(pin);
+        return err;
+    }
+
+    s_sqw_task = notify;
+    s_sqw_pin  = pin;
+    ESP_LOGI(TAG, "1 Hz SQW tick on GPIO%d", (int)pin);
     return ESP_OK;
 }
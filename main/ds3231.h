@@ -1,31 +1,118 @@
 #pragma once
 #include <time.h>
-#include "driver/i2c.h"
+#include "driver/i2c_master.h"
+#include "driver/gpio.h"
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 typedef struct {
+    i2c_master_bus_handle_t bus;  // shared bus, or NULL to create one from the fields below
     i2c_port_t port;      // e.g. I2C_NUM_0
     gpio_num_t sda;       // e.g. GPIO_NUM_21
     gpio_num_t scl;       // e.g. GPIO_NUM_22
     uint32_t   clk_hz;    // e.g. 100000 or 400000
 } ds3231_config_t;
 
-// Init DS3231 + install I2C driver on the given port (idempotent)
+// Registers 0x00..0x12: time, alarms, control, status, aging, temperature
+#define DS3231_SNAPSHOT_REGS 19
+
+// Everything the chip reports, from one burst read
+typedef struct {
+    uint8_t   raw[DS3231_SNAPSHOT_REGS];
+    struct tm time;       // decoded like ds3231_get_time()
+    uint8_t   control;
+    uint8_t   status;
+    bool      osf;        // oscillator stopped (power lost): time is not trustworthy
+    bool      busy;       // TCXO conversion in progress
+    int8_t    aging;      // aging offset register
+    int16_t   temp_qc;    // temperature in 0.25 °C steps
+    int64_t   taken_us;   // esp_timer timestamp of the read
+} ds3231_snapshot_t;
+
+// Async read completion; runs in ISR context (t is NULL on error)
+typedef void (*ds3231_time_cb_t)(esp_err_t err, const struct tm *t, void *ctx);
+
+// Init DS3231: create (or join) the i2c_master bus, probe 0x68, add the device (idempotent)
 esp_err_t ds3231_init(const ds3231_config_t *cfg);
 
-// Read RTC time into struct tm (interpreted as local time; set TZ before use)
+// Bus handle for other peripherals / scanning with i2c_master_probe()
+i2c_master_bus_handle_t ds3231_get_bus(void);
+
+// I2C transactions issued so far
+uint32_t ds3231_get_txn_count(void);
+
+// One I2C transaction for registers 0x00..0x12; also becomes the "last snapshot" (out may be NULL)
+esp_err_t ds3231_read_snapshot(ds3231_snapshot_t *out);
+
+// Most recent snapshot without touching the bus (ESP_ERR_INVALID_STATE if none yet)
+esp_err_t ds3231_get_last_snapshot(ds3231_snapshot_t *out);
+
+// Read RTC time into struct tm (interpreted as local time; set TZ before use).
+// Takes a fresh snapshot.
 esp_err_t ds3231_get_time(struct tm *out_tm);
 
-// Write struct tm (local time) into RTC (24h mode)
+// Start a time read and return at once; ESP_ERR_INVALID_STATE if a transaction is in flight
+esp_err_t ds3231_get_time_async(ds3231_time_cb_t cb, void *ctx);
+
+// Write struct tm (local time) into RTC (24h mode); clears OSF
 esp_err_t ds3231_set_time(const struct tm *in_tm);
 
-// Optional: read on-chip temperature (°C)
+// Clear the oscillator-stop flag once the time is known good
+esp_err_t ds3231_clear_osf(void);
+
+// Optional: on-chip temperature (°C) from the latest snapshot (reads one if none yet)
 esp_err_t ds3231_get_temperature(float *out_c);
 
+// ---- 1 Hz SQW tick mode ----
+// Programs INT/SQW for a 1 Hz square wave and counts its edges on `pin` in an ISR,
+// so time advances without I2C traffic. Waits for the first edge, seeds the
+// cached epoch from a full read, then notifies `notify` (xTaskNotifyGive) once per second.
+esp_err_t ds3231_sqw_start(gpio_num_t pin, TaskHandle_t notify);
+
+// Cached epoch advanced by the ISR (0 until seeded)
+time_t ds3231_sqw_epoch(void);
+
+// Epoch and esp_timer timestamp (µs) of the most recent SQW edge, read together
+esp_err_t ds3231_sqw_last_edge(time_t *epoch, int64_t *edge_us);
+
+// Full register read that re-seeds the cached epoch; call right after a tick
+esp_err_t ds3231_sqw_resync(void);
+
+// Let SQW edges wake the chip from automatic light sleep (GPIO wake source). Edges are
+// still counted either way; without this they are only seen while awake.
+// ESP_ERR_NOT_SUPPORTED when built without CONFIG_TK_PM_LIGHT_SLEEP.
+esp_err_t ds3231_sqw_set_wakeup(bool enable);
+
+// ---- Cached clock (ds3231_clock.c) ----
+// Sub-second time from one RTC anchor plus esp_timer deltas; the RTC is consulted
+// only every discipline_interval_s, and re-anchored when drift exceeds max_drift_us.
+typedef struct {
+    uint32_t discipline_interval_s;   // compare against the RTC this often
+    uint32_t max_drift_us;            // re-anchor beyond this
+} ds3231_clock_config_t;
+
+typedef struct {
+    int64_t  last_drift_us;           // interpolated minus RTC at the last discipline
+    int64_t  max_abs_drift_us;        // worst seen since boot
+    int32_t  drift_ppm;               // esp_timer vs RTC rate (SQW mode only, else 0)
+    uint32_t disciplines;
+    uint32_t reanchors;
+    uint32_t rtc_reads;
+} ds3231_clock_stats_t;
+
+// Take the first anchor (aligned to a seconds edge: SQW if running, else by polling)
+esp_err_t ds3231_clock_init(const ds3231_clock_config_t *cfg);
+
+// Local epoch in µs; touches I2C only when a discipline is due
+esp_err_t ds3231_clock_now(int64_t *epoch_us);
+
+void ds3231_clock_get_stats(ds3231_clock_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
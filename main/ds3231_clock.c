@@ -0,0 +1,145 @@
+#include "ds3231.h"
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#define US_PER_SEC          1000000LL
+#define ALIGN_TIMEOUT_MS    1100              // a seconds edge is at most 1 s away
+
+static const char *TAG = "ds3231_clock";
+
+static ds3231_clock_config_t s_cfg;
+static portMUX_TYPE          s_mux = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t     s_discipline_lock;
+
+// Anchor: RTC second `s_anchor_epoch` began at esp_timer time `s_anchor_us`
+static time_t  s_anchor_epoch;
+static int64_t s_anchor_us;
+static int64_t s_next_discipline_us;
+static ds3231_clock_stats_t s_stats;
+
+static inline int64_t interpolate(int64_t at_us)
+{
+    return (int64_t)s_anchor_epoch * US_PER_SEC + (at_us - s_anchor_us);
+}
+
+static esp_err_t read_epoch(time_t *out)
+{
+    struct tm t;
+    esp_err_t err = ds3231_get_time(&t);
+    s_stats.rtc_reads++;
+    if (err == ESP_OK) *out = mktime(&t);
+    return err;
+}
+
+// Find the start of an RTC second: the SQW edge if the tick ISR runs, else poll for a rollover
+static esp_err_t aligned_sample(time_t *epoch, int64_t *at_us)
+{
+    if (ds3231_sqw_last_edge(epoch, at_us) == ESP_OK) return ESP_OK;
+
+    time_t first, cur;
+    esp_err_t err = read_epoch(&first);
+    if (err != ESP_OK) return err;
+    for (int64_t t0 = esp_timer_get_time();
+         esp_timer_get_time() - t0 < ALIGN_TIMEOUT_MS * 1000LL; ) {
+        vTaskDelay(1);
+        if ((err = read_epoch(&cur)) != ESP_OK) return err;
+        if (cur != first) {
+            *epoch = cur;
+            *at_us = esp_timer_get_time();   // within one tick + one I2C read of the edge
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+static esp_err_t anchor(void)
+{
+    time_t  epoch;
+    int64_t at_us;
+    esp_err_t err = aligned_sample(&epoch, &at_us);
+    if (err != ESP_OK) return err;
+
+    portENTER_CRITICAL(&s_mux);
+    s_anchor_epoch = epoch;
+    s_anchor_us    = at_us;
+    portEXIT_CRITICAL(&s_mux);
+    return ESP_OK;
+}
+
+// Compare the interpolated clock with the RTC. With SQW the edge gives an exact
+// reference; otherwise the RTC's whole second only bounds the error.
+static void discipline(void)
+{
+    time_t  epoch;
+    int64_t at_us, drift;
+    bool    exact = (ds3231_sqw_last_edge(&epoch, &at_us) == ESP_OK);
+
+    if (exact) {
+        drift = interpolate(at_us) - (int64_t)epoch * US_PER_SEC;
+    } else {
+        if (read_epoch(&epoch) != ESP_OK) return;
+        at_us = esp_timer_get_time();
+        int64_t pred = interpolate(at_us);
+        int64_t lo = (int64_t)epoch * US_PER_SEC, hi = lo + US_PER_SEC;
+        drift = (pred < lo) ? pred - lo : (pred >= hi) ? pred - hi : 0;
+    }
+
+    s_stats.disciplines++;
+    s_stats.last_drift_us = drift;
+    if (llabs(drift) > s_stats.max_abs_drift_us) s_stats.max_abs_drift_us = llabs(drift);
+    int64_t span = at_us - s_anchor_us;
+    s_stats.drift_ppm = (exact && span > 0) ? (int32_t)(drift * US_PER_SEC / span) : 0;
+
+    if (llabs(drift) > s_cfg.max_drift_us) {
+        ESP_LOGW(TAG, "drift %lld us > %lu us, re-anchoring",
+                 (long long)drift, (unsigned long)s_cfg.max_drift_us);
+        if (anchor() == ESP_OK) s_stats.reanchors++;
+    }
+}
+
+esp_err_t ds3231_clock_init(const ds3231_clock_config_t *cfg)
+{
+    if (!cfg || cfg->discipline_interval_s == 0) return ESP_ERR_INVALID_ARG;
+    s_cfg = *cfg;
+    if (!s_discipline_lock) s_discipline_lock = xSemaphoreCreateMutex();
+    if (!s_discipline_lock) return ESP_ERR_NO_MEM;
+
+    esp_err_t err = anchor();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "anchor failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    s_next_discipline_us = s_anchor_us + (int64_t)s_cfg.discipline_interval_s * US_PER_SEC;
+    return ESP_OK;
+}
+
+esp_err_t ds3231_clock_now(int64_t *epoch_us)
+{
+    if (!epoch_us) return ESP_ERR_INVALID_ARG;
+    if (!s_discipline_lock) return ESP_ERR_INVALID_STATE;
+
+    int64_t now = esp_timer_get_time();
+    // one caller disciplines; the others keep interpolating
+    if (now >= s_next_discipline_us && xSemaphoreTake(s_discipline_lock, 0) == pdTRUE) {
+        if (now >= s_next_discipline_us) {
+            discipline();
+            s_next_discipline_us = now + (int64_t)s_cfg.discipline_interval_s * US_PER_SEC;
+        }
+        xSemaphoreGive(s_discipline_lock);
+        now = esp_timer_get_time();
+    }
+
+    portENTER_CRITICAL(&s_mux);
+    *epoch_us = interpolate(now);
+    portEXIT_CRITICAL(&s_mux);
+    return ESP_OK;
+}
+
+void ds3231_clock_get_stats(ds3231_clock_stats_t *out)
+{
+    if (out) *out = s_stats;
+}
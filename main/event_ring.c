@@ -0,0 +1,85 @@
+#include "event_ring.h"
+#include <stdatomic.h>
+#include <string.h>
+#include "esp_timer.h"
+
+_Static_assert((EVENT_RING_DEPTH & (EVENT_RING_DEPTH - 1)) == 0, "ring depth must be a power of two");
+
+static tk_evt_t          s_slots[EVENT_RING_DEPTH];
+static _Atomic uint32_t  s_head;          // written by the producer only
+static _Atomic uint32_t  s_tail;          // written by the consumer only
+
+// Producer-owned counters
+static uint32_t   s_pushed, s_dropped, s_hwm;
+static lat_hist_t s_handler;
+// Consumer-owned counters
+static uint32_t   s_popped;
+static lat_hist_t s_queued;
+
+void lat_hist_add(lat_hist_t *h, int64_t us)
+{
+    if (us < 0) us = 0;
+    uint32_t v = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+    uint32_t b = v ? 31 - __builtin_clz(v) : 0;
+    if (b >= LAT_BUCKETS) b = LAT_BUCKETS - 1;
+    h->bucket[b]++;
+    h->count++;
+    if (v > h->max_us) h->max_us = v;
+}
+
+uint32_t lat_hist_pct(const lat_hist_t *h, uint32_t pct)
+{
+    if (!h->count) return 0;
+    uint64_t want = ((uint64_t)h->count * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < LAT_BUCKETS; b++) {
+        seen += h->bucket[b];
+        if (seen >= want) return (2u << b) - 1;
+    }
+    return h->max_us;
+}
+
+bool event_ring_push(const tk_evt_t *ev)
+{
+    uint32_t head = atomic_load_explicit(&s_head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&s_tail, memory_order_acquire);
+    if (head - tail >= EVENT_RING_DEPTH) {
+        s_dropped++;
+        return false;
+    }
+    s_slots[head & (EVENT_RING_DEPTH - 1)] = *ev;
+    atomic_store_explicit(&s_head, head + 1, memory_order_release);
+
+    s_pushed++;
+    uint32_t depth = head + 1 - tail;
+    if (depth > s_hwm) s_hwm = depth;
+    lat_hist_add(&s_handler, esp_timer_get_time() - ev->ts_us);
+    return true;
+}
+
+bool event_ring_pop(tk_evt_t *out)
+{
+    uint32_t tail = atomic_load_explicit(&s_tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&s_head, memory_order_acquire);
+    if (tail == head) return false;
+    *out = s_slots[tail & (EVENT_RING_DEPTH - 1)];
+    atomic_store_explicit(&s_tail, tail + 1, memory_order_release);
+
+    s_popped++;
+    lat_hist_add(&s_queued, esp_timer_get_time() - out->ts_us);
+    return true;
+}
+
+// Counters are single-writer words; a reader may see them a tick apart, never torn
+void event_ring_get_stats(event_ring_stats_t *out)
+{
+    uint32_t head = atomic_load_explicit(&s_head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&s_tail, memory_order_acquire);
+    out->pushed    = s_pushed;
+    out->dropped   = s_dropped;
+    out->popped    = s_popped;
+    out->depth     = head - tail;
+    out->depth_hwm = s_hwm;
+    out->handler   = s_handler;
+    out->queued    = s_queued;
+}
@@ -0,0 +1,64 @@
+#pragma once
+// Single-producer/single-consumer ring of compact station events. The producer is the
+// default event loop task (Wi-Fi and presence handlers only push); one worker task pops
+// and does the slow part (policy, flash, logging). Lock-free: C11 atomics on head/tail.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EVENT_RING_DEPTH   32            // power of two
+
+typedef enum {
+    TK_EVT_STA_CONNECTED = 1,
+    TK_EVT_STA_DISCONNECTED,
+    TK_EVT_PRESENCE,                     // sniffed frame from an enrolled MAC
+    TK_EVT_RSSI_NEAR,                    // smoothed RSSI crossed the enter threshold
+    TK_EVT_RSSI_FAR,                     // ... or fell below the leave threshold
+} tk_evt_type_t;
+
+typedef struct {
+    uint8_t  type;                       // tk_evt_type_t
+    int8_t   rssi;                       // dBm: frame (presence) or smoothed (RSSI_*)
+    uint16_t aid;                        // SoftAP association id (0 for presence)
+    uint8_t  mac[6];
+    uint8_t  subtype;                    // 802.11 mgmt subtype (presence)
+    int64_t  ts_us;                      // esp_timer time the handler saw it
+} tk_evt_t;
+
+// Latency histogram: bucket i counts samples in [2^i, 2^(i+1)) us (bucket 0 also holds 0)
+#define LAT_BUCKETS 20
+typedef struct {
+    uint32_t bucket[LAT_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+} lat_hist_t;
+
+typedef struct {
+    uint32_t   pushed;
+    uint32_t   dropped;                  // ring full
+    uint32_t   popped;
+    uint32_t   depth;                    // current
+    uint32_t   depth_hwm;                // high-water mark
+    lat_hist_t handler;                  // handler entry -> push done
+    lat_hist_t queued;                   // handler entry -> worker pop
+} event_ring_stats_t;
+
+// Producer side (one task only). Stamps handler latency from ev->ts_us; false when full.
+bool event_ring_push(const tk_evt_t *ev);
+
+// Consumer side (one task only); false when empty
+bool event_ring_pop(tk_evt_t *out);
+
+void event_ring_get_stats(event_ring_stats_t *out);
+
+void     lat_hist_add(lat_hist_t *h, int64_t us);
+// Upper bound (us) of the bucket holding the pct-th percentile (0 if empty)
+uint32_t lat_hist_pct(const lat_hist_t *h, uint32_t pct);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,352 @@
+#include "history.h"
+#include <stddef.h>
+#include <string.h>
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#define HISTORY_LABEL        "history"
+#define HISTORY_SUBTYPE      0x41
+#define HISTORY_SECTOR       4096
+#define HISTORY_BLANK        0xFFFFFFFFu
+
+typedef struct __attribute__((packed)) {
+    uint32_t pos;            // absolute position: slot = pos % capacity (tells laps apart)
+    uint32_t day_key;
+    uint8_t  user;
+    uint8_t  flags;
+    int32_t  checkin_sod;
+    int32_t  done_sod;
+    int32_t  worked;
+    int32_t  remaining;
+    int32_t  overtime;
+    uint16_t crc;            // CRC-16 over the preceding 30 bytes
+} hrec_t;
+
+typedef struct {
+    uint32_t month;          // yyyymm
+    uint32_t pos;            // first record of the month
+} hidx_t;
+
+_Static_assert(sizeof(hrec_t) == 32, "history record must stay 32 bytes");
+
+#define RECS_PER_SECTOR      (HISTORY_SECTOR / sizeof(hrec_t))
+#define IDX_PER_SECTOR       (HISTORY_SECTOR / sizeof(hidx_t))
+#define CHUNK                16
+
+static const char *TAG = "history";
+
+// s_lock covers the flash and the state below: appends come from the owner task,
+// queries and stats from httpd. A query holds it only while it reads a chunk, never
+// across its callback (which may be sending over the network).
+static SemaphoreHandle_t s_lock;
+static const esp_partition_t *s_part;
+static uint32_t        s_data_sectors;       // sectors after the index sector
+static uint32_t        s_idx_n;              // index entries in use
+static uint32_t        s_idx_gen;            // bumps when the index is started over
+static uint32_t        s_month;              // month of the newest index entry (0 = none)
+static bool            s_marked;             // the newest entry is a late-record marker
+static history_stats_t s_stats;
+
+static inline uint16_t rec_crc(const hrec_t *r)
+{
+    return esp_rom_crc16_le(0, (const uint8_t *)r, offsetof(hrec_t, crc));
+}
+
+static inline bool rec_blank(const hrec_t *r)
+{
+    const uint8_t *b = (const uint8_t *)r;
+    for (size_t i = 0; i < sizeof(*r); i++) if (b[i] != 0xFF) return false;
+    return true;
+}
+
+static inline bool rec_valid(const hrec_t *r, uint32_t pos)
+{
+    return r->pos == pos && r->crc == rec_crc(r);
+}
+
+static inline bool idx_blank(const hidx_t *e) { return e->month == HISTORY_BLANK && e->pos == HISTORY_BLANK; }
+
+static inline bool idx_valid(const hidx_t *e)
+{
+    uint32_t mm = e->month % 100;
+    return e->pos != HISTORY_BLANK && e->month >= 200001 && e->month <= 999912 && mm >= 1 && mm <= 12;
+}
+
+static inline uint32_t slot_offset(uint32_t pos)
+{
+    return HISTORY_SECTOR + (pos % s_stats.capacity) * sizeof(hrec_t);
+}
+
+static esp_err_t read_idx(uint32_t i, hidx_t *e)
+{
+    return esp_partition_read(s_part, i * sizeof(hidx_t), e, sizeof(*e));
+}
+
+// Oldest position still on flash: the sector being filled was erased on entry
+static uint32_t oldest_pos(void)
+{
+    uint32_t live = (s_data_sectors - 1) * RECS_PER_SECTOR + s_stats.pos % RECS_PER_SECTOR;
+    return s_stats.pos > live ? s_stats.pos - live : 0;
+}
+
+// Records from pos up to the first blank slot (or a record from an older lap)
+static esp_err_t find_end(uint32_t pos)
+{
+    hrec_t chunk[CHUNK];
+    for (;;) {
+        // never straddle a sector (or the ring end) in one read
+        uint32_t n = RECS_PER_SECTOR - pos % RECS_PER_SECTOR;
+        if (n > CHUNK) n = CHUNK;
+        esp_err_t err = esp_partition_read(s_part, slot_offset(pos), chunk, n * sizeof(hrec_t));
+        if (err != ESP_OK) return err;
+        for (uint32_t k = 0; k < n; k++, pos++) {
+            s_stats.boot_scanned++;
+            if (rec_blank(&chunk[k])) { s_stats.pos = pos; return ESP_OK; }
+            // a torn record keeps its slot; a valid record with another position is an older lap
+            if (chunk[k].crc == rec_crc(&chunk[k]) && chunk[k].pos != pos) { s_stats.pos = pos; return ESP_OK; }
+        }
+    }
+}
+
+static esp_err_t init_locked(const esp_partition_t *part)
+{
+    uint32_t sectors = part->size / HISTORY_SECTOR;
+    if (sectors < 3) return ESP_ERR_INVALID_SIZE;
+    s_part = part;
+    s_data_sectors = sectors - 1;
+    s_stats.capacity = s_data_sectors * RECS_PER_SECTOR;
+
+    // Entries are appended in order: binary search for the first blank one
+    uint32_t lo = 0, hi = IDX_PER_SECTOR;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        hidx_t e;
+        esp_err_t err = read_idx(mid, &e);
+        if (err != ESP_OK) return err;
+        if (idx_blank(&e)) hi = mid; else lo = mid + 1;
+    }
+    s_idx_n = lo;
+
+    // Newest usable entry (the very last one may be torn), and the one before it: the
+    // same month twice is a late-record marker
+    hidx_t last = { 0, 0 };
+    bool found = false;
+    s_marked = false;
+    for (uint32_t i = s_idx_n; i-- > 0;) {
+        hidx_t e;
+        esp_err_t err = read_idx(i, &e);
+        if (err != ESP_OK) return err;
+        if (!idx_valid(&e)) continue;
+        if (found) { s_marked = (e.month == last.month); break; }
+        last  = e;
+        found = true;
+    }
+    if (!found) {
+        // Fresh (or unreadable) index: data sectors are erased lazily as appends enter them
+        if (s_idx_n) {
+            ESP_LOGW(TAG, "index unusable, starting over");
+            esp_err_t err = esp_partition_erase_range(s_part, 0, HISTORY_SECTOR);
+            if (err != ESP_OK) return err;
+            s_stats.erases++;
+        }
+        s_idx_n = 0;
+        s_month = 0;
+        s_marked = false;
+        s_stats.pos = 0;
+        s_stats.months = 0;
+        return ESP_OK;
+    }
+
+    s_month = last.month;
+    s_stats.months = s_idx_n;
+    esp_err_t err = find_end(last.pos);
+    if (err != ESP_OK) return err;
+    ESP_LOGI(TAG, "%lu months indexed, next record %lu (%lu read)", (unsigned long)s_idx_n,
+             (unsigned long)s_stats.pos, (unsigned long)s_stats.boot_scanned);
+    return ESP_OK;
+}
+
+esp_err_t history_init(void)
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           (esp_partition_subtype_t)HISTORY_SUBTYPE, HISTORY_LABEL);
+    if (!part) {
+        ESP_LOGW(TAG, "no '%s' partition", HISTORY_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (!s_lock) s_lock = xSemaphoreCreateMutex();
+    if (!s_lock) return ESP_ERR_NO_MEM;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    esp_err_t err = init_locked(part);
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+static esp_err_t index_month(uint32_t month)
+{
+    if (s_idx_n == IDX_PER_SECTOR) {
+        // ~42 years of months: start the index over; older months are no longer queryable
+        ESP_LOGW(TAG, "index full, restarting it");
+        esp_err_t err = esp_partition_erase_range(s_part, 0, HISTORY_SECTOR);
+        if (err != ESP_OK) return err;
+        s_stats.erases++;
+        s_idx_n = 0;
+        s_idx_gen++;
+    }
+    hidx_t e = { .month = month, .pos = s_stats.pos };
+    esp_err_t err = esp_partition_write(s_part, s_idx_n * sizeof(hidx_t), &e, sizeof(e));
+    if (err != ESP_OK) return err;
+    s_idx_n++;
+    s_marked = (month == s_month);
+    s_month = month;
+    s_stats.months = s_idx_n;
+    return ESP_OK;
+}
+
+static esp_err_t append_locked(const history_day_t *d)
+{
+    uint32_t pos = s_stats.pos;
+    if (pos % RECS_PER_SECTOR == 0) {
+        esp_err_t err = esp_partition_erase_range(s_part, slot_offset(pos), HISTORY_SECTOR);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "erase failed: %s", esp_err_to_name(err));
+            return err;
+        }
+        s_stats.erases++;
+    }
+    // index first: a reset in between leaves an entry pointing at a blank slot, which is fine.
+    // Months only go up. A record for an older month (clock set back) stays in the newest
+    // month; the first one there re-enters that month as a marker, so queries know the
+    // month holds older days too and the index costs one entry per such month, not one
+    // per flip between months.
+    uint32_t month = d->day_key / 100;
+    if (month > s_month || (month < s_month && !s_marked)) {
+        esp_err_t err = index_month(month > s_month ? month : s_month);
+        if (err != ESP_OK) return err;
+    }
+
+    hrec_t r = {
+        .pos         = pos,
+        .day_key     = d->day_key,
+        .user        = d->user,
+        .flags       = d->flags,
+        .checkin_sod = d->checkin_sod,
+        .done_sod    = d->done_sod,
+        .worked      = d->worked,
+        .remaining   = d->remaining,
+        .overtime    = d->overtime,
+    };
+    r.crc = rec_crc(&r);
+    esp_err_t err = esp_partition_write(s_part, slot_offset(pos), &r, sizeof(r));
+    // the slot is consumed either way: a torn record is skipped by readers
+    s_stats.pos = pos + 1;
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "write failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    s_stats.appends++;
+    return ESP_OK;
+}
+
+esp_err_t history_append(const history_day_t *d)
+{
+    if (!d) return ESP_ERR_INVALID_ARG;
+    if (!s_part) return ESP_ERR_INVALID_STATE;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    esp_err_t err = append_locked(d);
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+// Deliver valid records in [start, end) within the day range; false if cb asked to stop.
+// Each chunk is read under the lock; a slot the ring has overwritten since no longer
+// carries its position and is skipped.
+static bool scan_range(uint32_t start, uint32_t end, uint32_t from_day, uint32_t to_day,
+                       history_cb_t cb, void *ctx, esp_err_t *err)
+{
+    hrec_t chunk[CHUNK];
+    for (uint32_t pos = start; pos < end;) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        uint32_t oldest = oldest_pos();
+        if (pos < oldest) pos = oldest;
+        uint32_t n = RECS_PER_SECTOR - pos % RECS_PER_SECTOR;
+        if (n > CHUNK) n = CHUNK;
+        if (pos >= end) n = 0;
+        else if (n > end - pos) n = end - pos;
+        *err = n ? esp_partition_read(s_part, slot_offset(pos), chunk, n * sizeof(hrec_t)) : ESP_OK;
+        xSemaphoreGive(s_lock);
+        if (*err != ESP_OK) return false;
+        for (uint32_t k = 0; k < n; k++, pos++) {
+            const hrec_t *r = &chunk[k];
+            if (!rec_valid(r, pos) || r->day_key < from_day || r->day_key > to_day) continue;
+            history_day_t d = {
+                .day_key     = r->day_key,
+                .user        = r->user,
+                .flags       = r->flags,
+                .checkin_sod = r->checkin_sod,
+                .done_sod    = r->done_sod,
+                .worked      = r->worked,
+                .remaining   = r->remaining,
+                .overtime    = r->overtime,
+            };
+            if (!cb(&d, ctx)) return false;
+        }
+    }
+    return true;
+}
+
+esp_err_t history_query(uint32_t from_day, uint32_t to_day, history_cb_t cb, void *ctx)
+{
+    if (!cb || from_day > to_day) return ESP_ERR_INVALID_ARG;
+    if (!s_part) return ESP_ERR_INVALID_STATE;
+
+    // Appends may run concurrently (owner task): work on a consistent end
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint32_t n_idx = s_idx_n, end_pos = s_stats.pos, gen = s_idx_gen;
+    xSemaphoreGive(s_lock);
+    uint32_t from_m = from_day / 100, to_m = to_day / 100;
+
+    hidx_t buf[CHUNK], prev = { 0, 0 };
+    bool have_prev = false, prev_marker = false;
+    for (uint32_t i = 0; i <= n_idx; i++) {
+        bool last = (i == n_idx);
+        hidx_t cur = { 0, end_pos };
+        if (!last) {
+            if (i % CHUNK == 0) {
+                uint32_t n = n_idx - i < CHUNK ? n_idx - i : CHUNK;
+                xSemaphoreTake(s_lock, portMAX_DELAY);
+                esp_err_t err = (gen == s_idx_gen)
+                              ? esp_partition_read(s_part, i * sizeof(hidx_t), buf, n * sizeof(hidx_t))
+                              : ESP_ERR_INVALID_STATE;     // the index started over under us
+                xSemaphoreGive(s_lock);
+                if (err != ESP_OK) return err;
+            }
+            cur = buf[i % CHUNK];
+            if (!idx_valid(&cur)) continue;            // torn entry: the previous month runs on
+        }
+        // A month runs from its entry to the next entry (or the write position). From a
+        // marker on it may also hold older days, so it is read for any range reaching
+        // back to it; the day filter sorts the records out.
+        if (have_prev && prev.month >= from_m && (prev.month <= to_m || prev_marker)) {
+            uint32_t stop = cur.pos < end_pos ? cur.pos : end_pos;
+            esp_err_t err = ESP_OK;
+            if (!scan_range(prev.pos, stop, from_day, to_day, cb, ctx, &err)) return err;
+        }
+        prev_marker = have_prev && cur.month == prev.month;
+        prev = cur;
+        have_prev = true;
+    }
+    return ESP_OK;
+}
+
+void history_get_stats(history_stats_t *out)
+{
+    if (!out) return;
+    if (!s_lock) { *out = s_stats; return; }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *out = s_stats;
+    xSemaphoreGive(s_lock);
+}
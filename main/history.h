@@ -0,0 +1,62 @@
+#pragma once
+// Per-day work history in a dedicated flash partition ("history", data/0x41).
+// Sector 0 is a sparse month index ({yyyymm, first position} appended when a month
+// starts); the rest is a ring of 32-byte CRC-protected day records. Appends cost one
+// 32-byte program (plus a sector erase every 128 records); boot reads the index and
+// at most the current month's records; a range query reads the index sector and only
+// the data sectors of the months it covers. Index months only go up: a record for an
+// older month (RTC set back) lands in the newest month, which is then indexed a second
+// time as a marker so queries for older days read it too.
+//
+// Appends (owner task) and queries/stats (httpd) may run concurrently.
+//
+// A user-day is written more than once (check-in, target reached, day close); the
+// newest record for a (user, day) wins.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HISTORY_F_CHECKED_IN   0x01
+#define HISTORY_F_DONE         0x02    // daily target reached
+#define HISTORY_F_FINAL        0x04    // day closed (rollover)
+
+typedef struct {
+    uint32_t day_key;      // yyyymmdd
+    uint8_t  user;
+    uint8_t  flags;        // HISTORY_F_*
+    int32_t  checkin_sod;  // check-in, seconds since local midnight; -1 = none
+    int32_t  done_sod;     // target reached; -1 = not (yet)
+    int32_t  worked;       // seconds, overtime included
+    int32_t  remaining;    // seconds left of the target
+    int32_t  overtime;     // seconds present after reaching the target
+} history_day_t;
+
+typedef struct {
+    uint32_t pos;              // next append position (records ever written)
+    uint32_t capacity;         // data records the ring holds
+    uint32_t appends;          // since boot
+    uint32_t erases;           // since boot
+    uint32_t months;           // index entries
+    uint32_t boot_scanned;     // records read at boot to find the end
+} history_stats_t;
+
+// Return false to stop the query
+typedef bool (*history_cb_t)(const history_day_t *d, void *ctx);
+
+esp_err_t history_init(void);
+
+esp_err_t history_append(const history_day_t *d);
+
+// Records with from_day <= day_key <= to_day, oldest first (still-present records only)
+esp_err_t history_query(uint32_t from_day, uint32_t to_day, history_cb_t cb, void *ctx);
+
+void history_get_stats(history_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
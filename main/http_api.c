@@ -0,0 +1,337 @@
+#include "http_api.h"
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_http_server.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "snapshot.h"
+#include "history.h"
+#include "rssi.h"
+
+#define STATUS_USER_JSON   112                 // worst-case bytes per user object
+#define STATUS_MAX         (96 + TK_USERS_MAX * STATUS_USER_JSON)
+#define HISTORY_CHUNK      512
+#define RSSI_STA_JSON      160                 // worst-case station object is 120 bytes
+
+static const char *TAG = "http_api";
+
+static httpd_handle_t   s_server;
+static http_api_stats_t s_stats;              // written by the server task only
+
+// /status cache; all handlers run on the single httpd task, so no lock
+static char          s_status[STATUS_MAX];
+static size_t        s_status_len;
+static uint32_t      s_status_ver;            // snapshot version last looked at
+static uint32_t      s_status_gen;            // bumps on every rebuild (ETag)
+static char          s_etag[12];
+static tk_snapshot_t s_snap, s_cached;
+
+static void ep_done(http_ep_t ep, int64_t t0_us, size_t bytes, esp_err_t err)
+{
+    http_ep_stats_t *e = &s_stats.ep[ep];
+    e->requests++;
+    e->bytes += bytes;
+    if (err != ESP_OK) e->errors++;
+    lat_hist_add(&e->lat, esp_timer_get_time() - t0_us);
+}
+
+// Append to a fixed reply buffer. A piece that does not fit is dropped whole and *n
+// stays within the buffer, so the caller can still close the JSON it has.
+static bool buf_add(char *buf, size_t size, size_t *n, const char *fmt, ...)
+{
+    if (*n >= size) return false;
+    va_list ap;
+    va_start(ap, fmt);
+    int w = vsnprintf(buf + *n, size - *n, fmt, ap);
+    va_end(ap);
+    if (w < 0 || (size_t)w >= size - *n) {
+        buf[*n] = 0;
+        return false;
+    }
+    *n += (size_t)w;
+    return true;
+}
+
+// The API is open to anyone on the SoftAP. An enrolled MAC is what a spoofer needs
+// to check someone in, so replies show only the last two octets: enough to tell
+// the phones apart, not enough to clone one.
+static const char *mac_redact(char out[18], const uint8_t mac[6])
+{
+    snprintf(out, 18, "**:**:**:**:%02X:%02X", mac[4], mac[5]);
+    return out;
+}
+
+// ---------------- /status ----------------
+// last_epoch moves every tick for everyone; it is not part of the served state
+static bool same_state(const tk_snapshot_t *a, const tk_snapshot_t *b)
+{
+    if (a->today != b->today || a->focus != b->focus || a->n != b->n || a->running != b->running) return false;
+    for (uint32_t i = 0; i < a->n; i++) {
+        const tk_state_t *x = &a->user[i], *y = &b->user[i];
+        if (x->day_key != y->day_key || x->remaining != y->remaining || x->worked != y->worked ||
+            x->started != y->started || x->paused != y->paused ||
+            x->have_mac != y->have_mac || memcmp(x->mac, y->mac, 6) != 0) return false;
+    }
+    return true;
+}
+
+static void status_build(const tk_snapshot_t *s)
+{
+    static const char *const phase[] = { [TK_WAIT] = "wait", [TK_RUN] = "run", [TK_DONE] = "done", [TK_PAUSE] = "away" };
+    size_t n = 0;
+    bool ok = buf_add(s_status, sizeof(s_status), &n,
+                      "{\"day\":%" PRIu32 ",\"focus\":%" PRId32 ",\"running\":%" PRIu32 ",\"users\":[",
+                      s->today, s->focus, s->running);
+    for (uint32_t i = 0; i < s->n && ok; i++) {
+        const tk_state_t *u = &s->user[i];
+        char mac[18];
+        ok = buf_add(s_status, sizeof(s_status), &n,
+                     "%s{\"id\":%" PRIu32 ",\"mac\":\"%s\","
+                     "\"phase\":\"%s\",\"rem\":%" PRId32 ",\"worked\":%" PRId32 ",\"day\":%" PRIu32 "}",
+                     i ? "," : "", i, mac_redact(mac, u->mac),
+                     phase[tk_core_phase(u)], u->remaining, u->worked, u->day_key);
+    }
+    if (ok) ok = buf_add(s_status, sizeof(s_status), &n, "]}");
+    if (!ok) {
+        // cannot happen with STATUS_USER_JSON sized for the widest object; keep the reply valid
+        ESP_LOGE(TAG, "status JSON truncated");
+        n = (size_t)snprintf(s_status, sizeof(s_status), "{}");
+    }
+    s_status_len = n;
+    s_status_gen++;
+    snprintf(s_etag, sizeof(s_etag), "\"%08" PRIx32 "\"", s_status_gen);
+    s_stats.status_builds++;
+}
+
+// Re-serialise only when the owner has published a different state
+static void status_refresh(void)
+{
+    uint32_t v = snapshot_version();
+    if (v == s_status_ver && s_status_len) { s_stats.status_hits++; return; }
+    if (!snapshot_read(&s_snap)) return;
+    s_status_ver = v;
+    if (s_status_len && same_state(&s_snap, &s_cached)) { s_stats.status_hits++; return; }
+    s_cached = s_snap;
+    status_build(&s_cached);
+}
+
+static esp_err_t status_get(httpd_req_t *req)
+{
+    int64_t t0 = esp_timer_get_time();
+    status_refresh();
+    if (!s_status_len) {
+        esp_err_t err = httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "no state yet");
+        ep_done(HTTP_EP_STATUS, t0, 0, err);
+        return err;
+    }
+
+    httpd_resp_set_hdr(req, "ETag", s_etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    char inm[sizeof(s_etag)];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", inm, sizeof(inm)) == ESP_OK && strcmp(inm, s_etag) == 0) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        esp_err_t err = httpd_resp_send(req, NULL, 0);
+        s_stats.ep[HTTP_EP_STATUS].not_modified++;
+        ep_done(HTTP_EP_STATUS, t0, 0, err);
+        return err;
+    }
+    httpd_resp_set_type(req, "application/json");
+    esp_err_t err = httpd_resp_send(req, s_status, (ssize_t)s_status_len);
+    ep_done(HTTP_EP_STATUS, t0, s_status_len, err);
+    return err;
+}
+
+// ---------------- /history ----------------
+// GET /history[?from=yyyymmdd&to=yyyymmdd]: one row per user and day, the newest
+// record of that user-day (check-in, target reached and day close each write one)
+typedef struct {
+    httpd_req_t  *req;
+    esp_err_t     err;
+    size_t        len, sent;
+    bool          have[TK_USERS_MAX];
+    history_day_t last[TK_USERS_MAX];
+    char          buf[HISTORY_CHUNK];
+} history_ctx_t;
+
+static void history_flush(history_ctx_t *h)
+{
+    if (!h->len || h->err != ESP_OK) return;
+    h->err = httpd_resp_send_chunk(h->req, h->buf, (ssize_t)h->len);
+    h->sent += h->len;
+    h->len = 0;
+}
+
+// "hh:mm:ss", or empty for -1
+static void sod_str(char out[9], int32_t sod)
+{
+    if (sod < 0) { out[0] = 0; return; }
+    snprintf(out, 9, "%02u:%02u:%02u", (unsigned)(sod / 3600 % 100), (unsigned)(sod / 60 % 60), (unsigned)(sod % 60));
+}
+
+static void history_row(history_ctx_t *h, const history_day_t *d)
+{
+    if (h->len + 96 > sizeof(h->buf)) history_flush(h);
+    char in[9], done[9];
+    sod_str(in, d->checkin_sod);
+    sod_str(done, d->done_sod);
+    h->len += (size_t)snprintf(h->buf + h->len, sizeof(h->buf) - h->len,
+                               "%u,%" PRIu32 ",%s,%s,%" PRId32 ",%" PRId32 ",%" PRId32 ",%u\n",
+                               (unsigned)d->user, d->day_key, in, done, d->worked, d->remaining, d->overtime,
+                               (d->flags & HISTORY_F_FINAL) ? 1u : 0u);
+}
+
+static bool history_visit(const history_day_t *d, void *ctx)
+{
+    history_ctx_t *h = ctx;
+    if (d->user >= TK_USERS_MAX) return true;
+    // records arrive oldest first: a new day for a user closes out the previous one
+    if (h->have[d->user] && h->last[d->user].day_key != d->day_key) history_row(h, &h->last[d->user]);
+    h->have[d->user] = true;
+    h->last[d->user] = *d;
+    return h->err == ESP_OK;
+}
+
+static uint32_t query_day(const char *query, const char *key, uint32_t def)
+{
+    char val[12];
+    if (!query || httpd_query_key_value(query, key, val, sizeof(val)) != ESP_OK) return def;
+    char *end;
+    unsigned long v = strtoul(val, &end, 10);
+    return (*end == 0 && v <= 99991231UL) ? (uint32_t)v : def;
+}
+
+static esp_err_t history_get(httpd_req_t *req)
+{
+    static history_ctx_t h;              // ~2 KB: off the httpd stack
+    int64_t t0 = esp_timer_get_time();
+    memset(&h, 0, sizeof(h));
+    h.req = req;
+
+    char query[48];
+    bool have_q = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK;
+    uint32_t from = query_day(have_q ? query : NULL, "from", 0);
+    uint32_t to   = query_day(have_q ? query : NULL, "to", 99991231);
+
+    httpd_resp_set_type(req, "text/csv");
+    h.len = (size_t)snprintf(h.buf, sizeof(h.buf), "user,day,checkin,done,worked_s,remaining_s,overtime_s,final\n");
+    esp_err_t err = (from <= to) ? history_query(from, to, history_visit, &h) : ESP_OK;
+    for (uint32_t u = 0; u < TK_USERS_MAX && h.err == ESP_OK; u++) {
+        if (h.have[u]) history_row(&h, &h.last[u]);
+    }
+    history_flush(&h);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) ESP_LOGW(TAG, "history query: %s", esp_err_to_name(err));
+    if (h.err == ESP_OK) h.err = httpd_resp_send_chunk(req, NULL, 0);
+    ep_done(HTTP_EP_HISTORY, t0, h.sent, h.err);
+    return h.err;
+}
+
+// ---------------- /stats ----------------
+static esp_err_t stats_get(httpd_req_t *req)
+{
+    static const char *const name[HTTP_EP_COUNT] = {
+        [HTTP_EP_STATUS] = "status", [HTTP_EP_HISTORY] = "history", [HTTP_EP_STATS] = "stats",
+        [HTTP_EP_RSSI] = "rssi"
+    };
+    int64_t t0 = esp_timer_get_time();
+    char buf[768];
+    size_t n = 0;
+    bool ok = buf_add(buf, sizeof(buf), &n, "{");
+    for (uint32_t i = 0; i < HTTP_EP_COUNT && ok; i++) {
+        const http_ep_stats_t *e = &s_stats.ep[i];
+        ok = buf_add(buf, sizeof(buf), &n,
+                     "\"%s\":{\"req\":%" PRIu32 ",\"304\":%" PRIu32 ",\"err\":%" PRIu32 ",\"bytes\":%" PRIu64 ","
+                     "\"p50_us\":%" PRIu32 ",\"p99_us\":%" PRIu32 ",\"max_us\":%" PRIu32 "},",
+                     name[i], e->requests, e->not_modified, e->errors, e->bytes,
+                     lat_hist_pct(&e->lat, 50), lat_hist_pct(&e->lat, 99), e->lat.max_us);
+    }
+    if (ok) ok = buf_add(buf, sizeof(buf), &n, "\"status_cache\":{\"builds\":%" PRIu32 ",\"hits\":%" PRIu32 "}}",
+                         s_stats.status_builds, s_stats.status_hits);
+    if (!ok) {
+        ESP_LOGE(TAG, "stats JSON truncated");
+        n = 0;
+        buf_add(buf, sizeof(buf), &n, "{}");
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    esp_err_t err = httpd_resp_send(req, buf, (ssize_t)n);
+    ep_done(HTTP_EP_STATS, t0, n, err);
+    return err;
+}
+
+// ---------------- /rssi ----------------
+static esp_err_t rssi_get(httpd_req_t *req)
+{
+    static rssi_sta_t sta[RSSI_MAX_STA];
+    static char       buf[192 + RSSI_MAX_STA * RSSI_STA_JSON];
+    int64_t t0 = esp_timer_get_time();
+    rssi_stats_t rs;
+    rssi_get_stats(&rs);
+    uint32_t ns = rssi_get_table(sta, RSSI_MAX_STA);
+
+    size_t n = 0;
+    bool ok = buf_add(buf, sizeof(buf), &n,
+                      "{\"periods\":%" PRIu32 ",\"listed\":%" PRIu32 ",\"fed\":%" PRIu32 ",\"near\":%" PRIu32
+                      ",\"far\":%" PRIu32 ",\"evicted\":%" PRIu32 ",\"cost_p99_us\":%" PRIu32
+                      ",\"cost_max_us\":%" PRIu32 ",\"sta\":[",
+                      rs.periods, rs.listed, rs.fed, rs.near, rs.far, rs.evicted,
+                      lat_hist_pct(&rs.cost, 99), rs.cost.max_us);
+    // a station that does not fit is left out; the closing "]}" always has room
+    for (uint32_t i = 0; i < ns && ok; i++) {
+        const rssi_sta_t *e = &sta[i];
+        char mac[18];
+        ok = buf_add(buf, sizeof(buf) - 2, &n,
+                     "%s{\"mac\":\"%s\",\"dbm\":%d,\"last\":%d,"
+                     "\"near\":%s,\"samples\":%u,\"transitions\":%u,\"age_ms\":%" PRIu32 "}",
+                     i ? "," : "", mac_redact(mac, e->mac),
+                     e->dbm, e->last_dbm, e->near ? "true" : "false", e->samples, e->transitions, e->age_ms);
+    }
+    if (!ok) ESP_LOGW(TAG, "rssi JSON truncated at %u bytes", (unsigned)n);
+    buf_add(buf, sizeof(buf), &n, "]}");
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    esp_err_t err = httpd_resp_send(req, buf, (ssize_t)n);
+    ep_done(HTTP_EP_RSSI, t0, n, err);
+    return err;
+}
+
+esp_err_t http_api_start(const http_api_config_t *cfg)
+{
+    if (s_server) return ESP_OK;
+    httpd_config_t hc = HTTPD_DEFAULT_CONFIG();
+    if (cfg) {
+        if (cfg->port) hc.server_port = cfg->port;
+        if (cfg->task_prio) hc.task_priority = cfg->task_prio;
+        if (cfg->max_clients) hc.max_open_sockets = cfg->max_clients;
+    }
+    hc.lru_purge_enable = true;           // phones drop off the AP without closing sockets
+
+    esp_err_t err = httpd_start(&s_server, &hc);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "httpd_start: %s", esp_err_to_name(err));
+        s_server = NULL;
+        return err;
+    }
+    static const httpd_uri_t uris[] = {
+        { .uri = "/status",  .method = HTTP_GET, .handler = status_get },
+        { .uri = "/history", .method = HTTP_GET, .handler = history_get },
+        { .uri = "/stats",   .method = HTTP_GET, .handler = stats_get },
+        { .uri = "/rssi",    .method = HTTP_GET, .handler = rssi_get },
+    };
+    for (size_t i = 0; i < sizeof(uris) / sizeof(uris[0]); i++) {
+        err = httpd_register_uri_handler(s_server, &uris[i]);
+        if (err != ESP_OK) return err;
+    }
+    ESP_LOGI(TAG, "listening on port %u", (unsigned)hc.server_port);
+    return ESP_OK;
+}
+
+void http_api_get_stats(http_api_stats_t *out)
+{
+    if (out) *out = s_stats;
+}
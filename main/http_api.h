@@ -0,0 +1,52 @@
+#pragma once
+// HTTP API on the SoftAP (esp_http_server):
+//   GET /status   current state as compact JSON; pre-serialised, rebuilt only when the
+//                 published state changes; ETag / If-None-Match gives 304s to pollers
+//   GET /history  per-user, per-day CSV streamed in chunks from the history partition
+//                 (?from=yyyymmdd&to=yyyymmdd)
+//   GET /rssi     smoothed RSSI and near/far state per station, sampler counters (tuning)
+//   GET /stats    request counts, bytes and latency per endpoint
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "event_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    HTTP_EP_STATUS,
+    HTTP_EP_HISTORY,
+    HTTP_EP_STATS,
+    HTTP_EP_RSSI,
+    HTTP_EP_COUNT
+} http_ep_t;
+
+typedef struct {
+    uint16_t port;            // 80
+    uint8_t  task_prio;       // keep below the owner task
+    uint8_t  max_clients;     // open sockets; the oldest is purged when full
+} http_api_config_t;
+
+typedef struct {
+    uint32_t   requests;
+    uint32_t   not_modified;  // 304 answers (/status)
+    uint32_t   errors;        // send failures
+    uint64_t   bytes;         // body bytes sent
+    lat_hist_t lat;           // handler entry -> last byte queued
+} http_ep_stats_t;
+
+typedef struct {
+    http_ep_stats_t ep[HTTP_EP_COUNT];
+    uint32_t        status_builds;    // JSON re-serialisations
+    uint32_t        status_hits;      // served from the cache
+} http_api_stats_t;
+
+esp_err_t http_api_start(const http_api_config_t *cfg);
+
+void http_api_get_stats(http_api_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
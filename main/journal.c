@@ -0,0 +1,245 @@
+#include "journal.h"
+#include <stddef.h>
+#include <string.h>
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_log.h"
+
+#define JOURNAL_LABEL        "journal"
+#define JOURNAL_SUBTYPE      0x40
+#define JOURNAL_SECTOR       4096
+#define JOURNAL_SEQ_BLANK    0xFFFFFFFFu
+#define JOURNAL_PAYLOAD      10               // day_key + remaining + flags
+
+typedef struct __attribute__((packed)) {
+    uint32_t seq;
+    uint32_t day_key;
+    int32_t  remaining;
+    uint16_t flags;          // user << 8 | JOURNAL_FLAG_*
+    uint16_t crc;            // CRC-16 over the preceding 14 bytes
+} jrec_t;
+
+_Static_assert(sizeof(jrec_t) == 16, "journal record must stay 16 bytes");
+
+#define RECS_PER_SECTOR      (JOURNAL_SECTOR / sizeof(jrec_t))
+
+static const char *TAG = "journal";
+
+static const esp_partition_t *s_part;
+static uint32_t        s_n_recs;             // ring capacity in records
+static uint32_t        s_next;               // slot for the next append
+static jrec_t          s_live[JOURNAL_MAX_USERS];       // newest record per user
+static uint32_t        s_live_slot[JOURNAL_MAX_USERS];  // where it lives; UINT32_MAX = none
+static journal_stats_t s_stats;
+
+_Static_assert(2 * JOURNAL_MAX_USERS < RECS_PER_SECTOR, "carried records must leave room in a sector");
+
+static inline uint16_t rec_crc(const jrec_t *r)
+{
+    return esp_rom_crc16_le(0, (const uint8_t *)r, offsetof(jrec_t, crc));
+}
+
+static inline bool rec_blank(const jrec_t *r)
+{
+    static const uint8_t ff[sizeof(jrec_t)] = {
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF
+    };
+    return memcmp(r, ff, sizeof(*r)) == 0;
+}
+
+static inline bool rec_valid(const jrec_t *r)
+{
+    return r->seq != JOURNAL_SEQ_BLANK && r->crc == rec_crc(r) && (r->flags >> 8) < JOURNAL_MAX_USERS;
+}
+
+static inline uint8_t rec_user(const jrec_t *r) { return (uint8_t)(r->flags >> 8); }
+
+// Whether every slot in [slot, slot + n) reads blank
+static esp_err_t slots_blank(uint32_t slot, uint32_t n, bool *blank)
+{
+    jrec_t chunk[16];
+    *blank = true;
+    while (n && *blank) {
+        uint32_t k = n < 16 ? n : 16;
+        esp_err_t err = esp_partition_read(s_part, slot * sizeof(jrec_t), chunk, k * sizeof(jrec_t));
+        if (err != ESP_OK) return err;
+        for (uint32_t i = 0; i < k && *blank; i++) *blank = rec_blank(&chunk[i]);
+        slot += k;
+        n -= k;
+    }
+    return ESP_OK;
+}
+
+// Walk every record: newest per user, the newest overall (seq) and the slot after it
+static esp_err_t scan_all(void)
+{
+    jrec_t   chunk[16];
+    uint32_t newest_slot = UINT32_MAX;
+    for (uint32_t slot = 0; slot < s_n_recs; slot += 16) {
+        esp_err_t err = esp_partition_read(s_part, slot * sizeof(jrec_t), chunk, sizeof(chunk));
+        if (err != ESP_OK) return err;
+        for (uint32_t k = 0; k < 16; k++) {
+            // a torn record keeps its slot but is ignored
+            if (!rec_valid(&chunk[k])) continue;
+            uint8_t u = rec_user(&chunk[k]);
+            if (s_live_slot[u] == UINT32_MAX || chunk[k].seq > s_live[u].seq) {
+                s_live[u] = chunk[k];
+                s_live_slot[u] = slot + k;
+            }
+            if (newest_slot == UINT32_MAX || chunk[k].seq > s_stats.seq) {
+                s_stats.seq = chunk[k].seq;
+                newest_slot = slot + k;
+            }
+        }
+    }
+    if (newest_slot == UINT32_MAX) return ESP_ERR_NOT_FOUND;
+
+    // Append after the newest record; unless that sector's whole tail is blank (a torn
+    // record, or a torn erase that left a later slot programmed), start the next sector
+    s_next = (newest_slot + 1) % s_n_recs;
+    if (s_next % RECS_PER_SECTOR != 0) {
+        bool blank;
+        esp_err_t err = slots_blank(s_next, RECS_PER_SECTOR - s_next % RECS_PER_SECTOR, &blank);
+        if (err != ESP_OK) return err;
+        if (!blank) s_next = ((newest_slot / RECS_PER_SECTOR + 1) % s_stats.sectors) * RECS_PER_SECTOR;
+    }
+    return ESP_OK;
+}
+
+esp_err_t journal_init(void)
+{
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                      (esp_partition_subtype_t)JOURNAL_SUBTYPE, JOURNAL_LABEL);
+    if (!s_part) {
+        ESP_LOGW(TAG, "no '%s' partition", JOURNAL_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_stats.sectors = s_part->size / JOURNAL_SECTOR;
+    if (s_stats.sectors < 2) return ESP_ERR_INVALID_SIZE;
+    s_n_recs = s_stats.sectors * RECS_PER_SECTOR;
+    for (uint32_t u = 0; u < JOURNAL_MAX_USERS; u++) s_live_slot[u] = UINT32_MAX;
+    s_stats.seq = 0;
+
+    esp_err_t err = scan_all();
+    if (err == ESP_ERR_NOT_FOUND) {
+        ESP_LOGI(TAG, "empty, formatting %lu sectors", (unsigned long)s_stats.sectors);
+        err = esp_partition_erase_range(s_part, 0, s_part->size);
+        if (err != ESP_OK) return err;
+        s_stats.erases += s_stats.sectors;
+        s_next = 0;
+        return ESP_OK;
+    }
+    if (err != ESP_OK) return err;
+
+    s_stats.users = 0;
+    for (uint32_t u = 0; u < JOURNAL_MAX_USERS; u++) s_stats.users += (s_live_slot[u] != UINT32_MAX);
+    s_stats.lifetime_erases = s_stats.seq / RECS_PER_SECTOR;
+    ESP_LOGI(TAG, "newest seq %lu, %lu users, next slot %lu",
+             (unsigned long)s_stats.seq, (unsigned long)s_stats.users, (unsigned long)s_next);
+    return ESP_OK;
+}
+
+esp_err_t journal_load(uint8_t user, journal_state_t *out)
+{
+    if (!out || user >= JOURNAL_MAX_USERS) return ESP_ERR_INVALID_ARG;
+    if (s_live_slot[user] == UINT32_MAX) return ESP_ERR_NOT_FOUND;
+    const jrec_t *r = &s_live[user];
+    out->user      = user;
+    out->flags     = (uint8_t)r->flags;
+    out->day_key   = r->day_key;
+    out->remaining = r->remaining;
+    return ESP_OK;
+}
+
+// Program one record at s_next (no sector handling) and make it the user's newest
+static esp_err_t program(uint8_t user, uint32_t day_key, int32_t remaining, uint16_t flags)
+{
+    jrec_t r = {
+        .seq       = s_stats.seq + 1,
+        .day_key   = day_key,
+        .remaining = remaining,
+        .flags     = (uint16_t)(((uint16_t)user << 8) | (flags & 0xFF)),
+    };
+    r.crc = rec_crc(&r);
+
+    esp_err_t err = esp_partition_write(s_part, s_next * sizeof(jrec_t), &r, sizeof(r));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "write failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    if (s_live_slot[user] == UINT32_MAX) s_stats.users++;
+    s_live[user] = r;
+    s_live_slot[user] = s_next;
+    s_next = (s_next + 1) % s_n_recs;
+    s_stats.seq = r.seq;
+    s_stats.flash_bytes += sizeof(r);
+    return ESP_OK;
+}
+
+// Re-program every user's newest record that lives in sector (into the current sector)
+static esp_err_t carry_from(uint32_t sector, const jrec_t *live, const uint32_t *live_slot)
+{
+    for (uint32_t u = 0; u < JOURNAL_MAX_USERS; u++) {
+        if (live_slot[u] == UINT32_MAX || live_slot[u] / RECS_PER_SECTOR != sector) continue;
+        esp_err_t err = program((uint8_t)u, live[u].day_key, live[u].remaining, live[u].flags);
+        if (err != ESP_OK) return err;
+        s_stats.carried++;
+    }
+    return ESP_OK;
+}
+
+// The write pointer enters sector: erase it unless every slot reads blank (a blank
+// first slot alone proves nothing after a torn erase), restore anything still live in
+// it (only possible on the first wrap after an upgrade), then carry the live records
+// out of the following sector so it holds nothing live by the time it is reclaimed.
+static esp_err_t reclaim(uint32_t sector)
+{
+    bool blank;
+    esp_err_t err = slots_blank(sector * RECS_PER_SECTOR, RECS_PER_SECTOR, &blank);
+    if (err != ESP_OK) return err;
+    if (!blank) {
+        static jrec_t   saved[JOURNAL_MAX_USERS];
+        static uint32_t saved_slot[JOURNAL_MAX_USERS];
+        memcpy(saved, s_live, sizeof(saved));
+        memcpy(saved_slot, s_live_slot, sizeof(saved_slot));
+
+        err = esp_partition_erase_range(s_part, sector * JOURNAL_SECTOR, JOURNAL_SECTOR);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "erase failed: %s", esp_err_to_name(err));
+            return err;
+        }
+        s_stats.erases++;
+        s_stats.lifetime_erases++;
+        err = carry_from(sector, saved, saved_slot);
+        if (err != ESP_OK) return err;
+    }
+    uint32_t following = (sector + 1) % s_stats.sectors;
+    return carry_from(following, s_live, s_live_slot);
+}
+
+esp_err_t journal_append(const journal_state_t *st)
+{
+    if (!st || st->user >= JOURNAL_MAX_USERS) return ESP_ERR_INVALID_ARG;
+    if (!s_part) return ESP_ERR_INVALID_STATE;
+
+    s_stats.payload_bytes += JOURNAL_PAYLOAD;
+    const jrec_t *last = &s_live[st->user];
+    if (s_live_slot[st->user] != UINT32_MAX && last->day_key == st->day_key &&
+        last->remaining == st->remaining && (uint8_t)last->flags == st->flags) {
+        s_stats.skipped++;
+        return ESP_OK;
+    }
+
+    if (s_next % RECS_PER_SECTOR == 0) {
+        esp_err_t err = reclaim(s_next / RECS_PER_SECTOR);
+        if (err != ESP_OK) return err;
+    }
+    esp_err_t err = program(st->user, st->day_key, st->remaining, st->flags);
+    if (err == ESP_OK) s_stats.appends++;
+    return err;
+}
+
+void journal_get_stats(journal_stats_t *out)
+{
+    if (out) *out = s_stats;
+}
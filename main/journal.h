@@ -0,0 +1,55 @@
+#pragma once
+// Append-only state journal in a dedicated flash partition ("journal", data/0x40).
+// 16-byte CRC-protected records fill a ring of sectors; a sector is erased only when
+// the write pointer enters it, so each append costs one 16-byte program.
+// Records are keyed by user; each user's newest record is carried forward out of the
+// sector that will be reclaimed next, so a wrap never loses live state.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JOURNAL_FLAG_STARTED   0x01
+#define JOURNAL_FLAG_HAVE_MAC  0x02
+#define JOURNAL_FLAG_PAUSED    0x04
+
+#define JOURNAL_MAX_USERS      64
+
+typedef struct {
+    uint8_t  user;         // < JOURNAL_MAX_USERS (stored in the high byte of the record flags)
+    uint8_t  flags;        // JOURNAL_FLAG_*
+    uint32_t day_key;      // yyyymmdd
+    int32_t  remaining;    // seconds
+} journal_state_t;
+
+typedef struct {
+    uint32_t seq;              // sequence number of the newest record
+    uint32_t appends;          // records written since boot
+    uint32_t skipped;          // appends identical to the newest record (not written)
+    uint32_t erases;           // sector erases since boot
+    uint32_t lifetime_erases;  // sector erases over the partition's life (from seq)
+    uint32_t carried;          // live records copied forward ahead of a sector reclaim
+    uint32_t users;            // users with a live record
+    uint32_t sectors;
+    uint64_t flash_bytes;      // bytes programmed since boot
+    uint64_t payload_bytes;    // state bytes the caller asked to persist since boot
+} journal_stats_t;
+
+// Locate the partition and the newest valid record (formats a partition holding no valid records)
+esp_err_t journal_init(void);
+
+// Newest record for user; ESP_ERR_NOT_FOUND if that user has none
+esp_err_t journal_load(uint8_t user, journal_state_t *out);
+
+// Append unless identical to that user's newest record
+esp_err_t journal_append(const journal_state_t *st);
+
+void journal_get_stats(journal_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
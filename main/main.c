@@ -1,6 +1,8 @@
 // main.c — ESP-IDF v5.3.x
-// SoftAP "check-in": phone connects -> (relearn MAC if needed) -> start 9:15 countdown -> delayed deauth.
+// SoftAP "check-in": phone connects -> (enroll / relearn MAC if needed) -> start its 9:15 countdown -> delayed deauth.
+// Up to USERS_MAX phones, each with its own countdown; the display follows the last to check in.
 // Timebase: DS3231 (I2C). Display: TM1637 (HH:MM). State: NVS.
+// Countdown/MAC policy: components/tk_core (hardware-free, host-buildable).
 // Fixes:
 //  - NVS loads use temps (no volatile pointer warnings)
 //  - Deauth by AID (IDF v5.3 API), not MAC
@@ -14,35 +16,107 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
 
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_timer.h"
+#include "esp_bit_defs.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "esp_netif.h"
 #include "esp_log.h"
-#include "driver/i2c.h"
+#include "sdkconfig.h"
+#include "driver/i2c_master.h"
 
 #include "tm1637.h"
 #include "ds3231.h"
+#include "journal.h"
+#include "warm_state.h"
+#include "tk_app.h"
+#include "tk_civil.h"
+#include "tk_ratelimit.h"
+#include "presence.h"
+#include "event_ring.h"
+#include "snapshot.h"
+#include "power.h"
+#include "dlog.h"
+#include "http_api.h"
+#include "history.h"
+#include "boot.h"
+#include "rssi.h"
 
 // ================= USER CONFIG =================
 #define SOFTAP_SSID        "ESP32-Timekeeper"
 #define SOFTAP_PASS        "timekeeper123"     // >=8 chars for WPA2
 #define SOFTAP_CHANNEL     6
-#define SOFTAP_MAX_CONN    2
+#define SOFTAP_MAX_CONN    10                 // ESP32 SoftAP limit; phones are deauthed after check-in
 
-// Deauth policy (choose ONE)
-#define AUTO_DEAUTH_ON_FIRST_CONNECT  1       // deauth only on first connect of the day
-// #define AUTO_DEAUTH_ALWAYS         1       // deauth on every connect (may cause loops)
+// Enrolled phones (one MAC per person); the first USERS_MAX distinct MACs to connect are
+// enrolled. 1 = single-phone unit: the stored MAC is relearned instead (CONFIG_TK_RELEARN_MAC_DAILY).
+#define USERS_MAX          32
+// Full table: a new phone takes the slot of the user not checked in for longest, once that is
+// at least this many days (0 = never). A phone that changes its MAC enrolls anew and its old
+// entry ages out this way.
+#define USERS_EVICT_IDLE_DAYS 30
 
-// Relearn MAC on first connect of the day if it changed (handles phone's private MAC)
-#define RELEARN_MAC_DAILY  1
+// Reconnect-storm guard, checked first in the Wi-Fi handler: per-MAC token bucket, then a
+// doubling back-off for a MAC that keeps running it dry; the global bucket caps a flood of
+// (spoofed) MACs that each stay under their own limit. Enrolled phones skip the global
+// bucket, so a flood does not lock them out. Dropped events are only counted.
+#define RL_BURST              4               // connects back to back
+#define RL_REFILL_MS          15000           // then one per 15 s
+#define RL_BACKOFF_MS         30000
+#define RL_BACKOFF_MAX_MS     (15 * 60 * 1000)
+#define RL_GLOBAL_BURST       16
+#define RL_GLOBAL_REFILL_MS   1000
+
+// Owner task: sole writer of the countdown/user state. Applies ticks from app_main and
+// station events from the event loop, off the system event task; others read snapshots.
+#define OWNER_TASK_PRIO    5
+#define OWNER_TASK_STACK   4096
+
+// Deferred log formatter: lowest useful priority, drains the binary log ring this often
+#define DLOG_TASK_PRIO     1
+#define DLOG_PERIOD_MS     200
 
 // Delay before deauth so phone marks AP join as successful (helps auto-join later)
 #define DEAUTH_DELAY_MS    4000               // 4 seconds
 
+// Presence by sniffing the enrolled phone's probe/auth frames (check-in without association).
+// Enrollment still happens through a normal SoftAP connect.
+#define PRESENCE_SNIFF        1
+#define PRESENCE_DEBOUNCE_MS  30000
+#define PRESENCE_RSSI_MIN     (-80)
+
+// Checked in but unseen this long (not associated, no sniffed frame): the session ends at
+// the last sighting and the countdown pauses until the phone shows up again.
+// Without the sniffer a deauthed phone is never seen, so the countdown never pauses.
+#if PRESENCE_SNIFF
+#define AWAY_GRACE_SEC        900
+#else
+#define AWAY_GRACE_SEC        0
+#endif
+
+// RSSI gate: an association or sniffed frame counts only once the phone's smoothed signal
+// is near (EWMA of one sample per second, hysteresis between the two thresholds), so a
+// phone in the corridor neither checks in nor keeps a paused countdown running.
+#define RSSI_GATE             1
+#define RSSI_PERIOD_MS        1000
+#define RSSI_ENTER_DBM        (-67)
+#define RSSI_LEAVE_DBM        (-75)
+#define RSSI_EWMA_SHIFT       2               // new sample weighs 1/4: ~4 s to follow a step
+#define RSSI_MIN_SAMPLES      3
+#define RSSI_STALE_MS         120000          // no sample this long: forget (near -> far)
+#define RSSI_TASK_PRIO        2               // below the owner task
+
+// HTTP status/history API on the SoftAP (http://192.168.4.1/status)
+#define HTTP_API              1
+#define HTTP_API_PORT         80
+#define HTTP_API_PRIO         3               // below the owner task
+#define HTTP_API_CLIENTS      4
+
 // TM1637 pins/brightness
 #define TM_DIO_PIN         GPIO_NUM_16
 #define TM_CLK_PIN         GPIO_NUM_17
@@ -54,197 +128,860 @@
 #define I2C_SCL            GPIO_NUM_22
 #define I2C_FREQ_HZ        400000
 
+// DS3231 INT/SQW -> GPIO for the 1 Hz tick (GPIO_NUM_NC = poll the RTC every second)
+#define RTC_SQW_PIN        GPIO_NUM_4
+#define RTC_RESYNC_SEC     3600               // full register read at least this often
+#define RTC_SQW_TIMEOUT_MS 1500               // missing edge -> resync from registers
+
+// Cached clock (no SQW): esp_timer interpolation checked against the RTC
+#define CLOCK_DISCIPLINE_SEC  600
+#define CLOCK_MAX_DRIFT_US    250000
+
+// Periodic flash save while counting down; every tick goes to RTC memory instead
+#define FLASH_SAVE_SEC     900
+
 // Work target: 9h15m
 #define DAILY_TARGET_SEC   (9*3600 + 15*60)   // 33300
+#define MAX_TICK_DELTA_SEC 60                 // clamp per tick (clock jumps, long stalls)
 
-// NVS storage
+// NVS storage (MAC; countdown state only when there is no journal partition)
 #define NVS_NS             "tk"
 #define NVS_KEY_DAY        "day"              // uint32 (yyyymmdd)
 #define NVS_KEY_REM        "rem"              // int32  (remaining seconds)
 #define NVS_KEY_STARTED    "start"            // u8
 #define NVS_KEY_MAC        "mac"              // blob(6)
 #define NVS_KEY_HAVE_MAC   "hmac"             // u8
+#define NVS_KEY_USERS      "nusers"           // u8 (enrolled user count)
+#define NVS_KEY_LAST_IN    "lastin"           // uint32 (yyyymmdd of the latest check-in)
+#define NVS_KEY_POL_DEAUTH "pol_deauth"       // u8 tk_deauth_policy_t (optional override)
+#define NVS_KEY_POL_RELRN  "pol_relearn"      // u8 0/1 (optional override)
+// User 0 keeps the key names above; user i > 0 appends its index ("mac3", "rem3", ...)
 
 static const char *TAG = "timekeeper";
 
 // ================ STATE ================
-static volatile bool     s_started    = false;
-static volatile int32_t  s_remaining  = DAILY_TARGET_SEC;
-static volatile uint32_t s_day_key    = 0;     // yyyymmdd
-static uint8_t           s_phone_mac[6] = {0};
-static volatile bool     s_have_mac   = false;
+// Countdown/MAC policy and the owner task's decisions live in tk_core (tk_app); this file
+// does the I/O around them. s_app and everything persisted belong to the owner task once
+// it runs (app_main sets them up before creating it); other tasks use snapshot_read().
+// Deauth/relearn policy: Kconfig defaults here, NVS overrides applied by policy_load()
+// before the owner task starts; fixed after that.
+static tk_config_t s_tk_cfg = {
+    .daily_target_sec   = DAILY_TARGET_SEC,
+    .max_tick_delta_sec = MAX_TICK_DELTA_SEC,
+#if CONFIG_TK_RELEARN_MAC_DAILY
+    .relearn_mac_daily  = true,
+#endif
+#if CONFIG_TK_DEAUTH_ALWAYS
+    .deauth             = TK_DEAUTH_ALWAYS,
+#elif CONFIG_TK_DEAUTH_NONE
+    .deauth             = TK_DEAUTH_NONE,
+#else
+    .deauth             = TK_DEAUTH_FIRST_CONNECT,
+#endif
+    .away_grace_sec     = AWAY_GRACE_SEC,
+    .evict_idle_days    = USERS_EVICT_IDLE_DAYS,
+};
+// Connect limiter; used by the Wi-Fi handler on the event loop task only
+static const tk_rl_config_t s_rl_cfg = {
+    .burst            = RL_BURST,
+    .refill_ms        = RL_REFILL_MS,
+    .backoff_ms       = RL_BACKOFF_MS,
+    .backoff_max_ms   = RL_BACKOFF_MAX_MS,
+    .global_burst     = RL_GLOBAL_BURST,
+    .global_refill_ms = RL_GLOBAL_REFILL_MS,
+};
+static tk_rl_t s_rl;                           // others only read its counters (racily, for logs)
+
+static tk_app_t          s_app;                // users, today, display focus, save cadence
 static volatile bool     s_rtc_ok     = false;
+static bool              s_sqw        = false; // 1 Hz tick from DS3231 SQW
+static bool              s_clock      = false; // ds3231_clock interpolation available
+static time_t            s_last_resync = 0;
+
+// Deauth queue (v5.3: deauth by AID); one entry per station waiting for its deauth
+typedef struct {
+    uint16_t aid;                                  // 0 = free
+    uint8_t  mac[6];                               // just for logging
+    int64_t  due_us;
+} deauth_slot_t;
 
-static time_t            s_last_save_epoch = 0;
+static esp_timer_handle_t s_deauth_timer = NULL;
+static deauth_slot_t      s_deauth[SOFTAP_MAX_CONN];
+static portMUX_TYPE       s_deauth_mux = portMUX_INITIALIZER_UNLOCKED;
 
-// Deauth timer state (v5.3: deauth by AID)
-static esp_timer_handle_t s_deauth_timer  = NULL;
-static volatile bool       s_deauth_pending = false;
-static uint16_t            s_deauth_aid = 0;       // AID to deauth
-static uint8_t             s_deauth_mac[6];        // just for logging
+static TaskHandle_t       s_owner_task = NULL;
+
+// app_main -> owner: latest tick (one slot, overwritten; elapsed time comes from the epoch)
+typedef struct {
+    time_t   epoch;
+    uint32_t today;
+} tick_msg_t;
+static QueueHandle_t      s_tick_q = NULL;
+
+_Static_assert(USERS_MAX <= TK_USERS_MAX && USERS_MAX <= JOURNAL_MAX_USERS &&
+               USERS_MAX <= WARM_STATE_MAX_USERS && USERS_MAX <= PRESENCE_MAX_MACS,
+               "USERS_MAX exceeds a table capacity");
 
 // ================ HELPERS ================
-static inline uint32_t day_key_from_tm(const struct tm *t) {
-    return (uint32_t)((t->tm_year + 1900) * 10000 + (t->tm_mon + 1) * 100 + t->tm_mday);
+// Local (IST) calendar math goes through tk_civil: fixed offset, no TZ parsing
+static inline time_t tm_local_to_epoch(const struct tm *t) {
+    return (time_t)tk_civil_to_epoch(t, TK_CIVIL_IST_OFFSET);
+}
+
+// Epoch -> local time for the 1 Hz path: consecutive seconds just advance the cached tm
+static void local_from_epoch(time_t epoch, struct tm *t) {
+    static time_t    s_cached_epoch;
+    static struct tm s_cached_tm;
+    if (s_cached_epoch && epoch == s_cached_epoch + 1) tk_civil_tick(&s_cached_tm);
+    else if (epoch != s_cached_epoch) tk_civil_from_epoch(epoch, TK_CIVIL_IST_OFFSET, &s_cached_tm);
+    s_cached_epoch = epoch;
+    *t = s_cached_tm;
 }
-static inline time_t tm_local_to_epoch(struct tm tlocal) { return mktime(&tlocal); }
 
 static void set_system_time_from_tm(const struct tm *t_local) {
-    struct tm tmp = *t_local;
-    struct timeval tv = { .tv_sec = mktime(&tmp), .tv_usec = 0 };
+    struct timeval tv = { .tv_sec = tm_local_to_epoch(t_local), .tv_usec = 0 };
     settimeofday(&tv, NULL);
 }
 
-static void i2c_scan(i2c_port_t port) {
+#if CONFIG_TK_BOOT_I2C_SCAN
+static void i2c_scan(i2c_master_bus_handle_t bus) {
     printf("\n[I2C] scanning...\n");
     for (int addr = 0x03; addr <= 0x77; ++addr) {
-        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-        i2c_master_start(cmd);
-        i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_WRITE, true);
-        i2c_master_stop(cmd);
-        esp_err_t r = i2c_master_cmd_begin(port, cmd, pdMS_TO_TICKS(50));
-        i2c_cmd_link_delete(cmd);
-        if (r == ESP_OK) printf("  FOUND: 0x%02X\n", addr);
-        vTaskDelay(pdMS_TO_TICKS(5));
+        if (i2c_master_probe(bus, addr, 10) == ESP_OK) printf("  FOUND: 0x%02X\n", addr);
     }
     printf("[I2C] scan done.\n\n");
 }
+#endif
+
+// SQW mode: wait for the next edge and take time from the ISR-advanced epoch.
+// Registers are read only on a missed edge, at the day boundary, or every RTC_RESYNC_SEC.
+static bool sqw_tick(struct tm *t, time_t *epoch, uint32_t last_day) {
+    bool edge = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(RTC_SQW_TIMEOUT_MS)) > 0;
+    *epoch = ds3231_sqw_epoch();
+    local_from_epoch(*epoch, t);
 
-static void print_mac(const char *prefix, const uint8_t mac[6]) {
-    ESP_LOGI(TAG, "%s %02X:%02X:%02X:%02X:%02X:%02X",
-             prefix,
-             (unsigned int)mac[0], (unsigned int)mac[1], (unsigned int)mac[2],
-             (unsigned int)mac[3], (unsigned int)mac[4], (unsigned int)mac[5]);
+    bool resync = !edge
+               || (*epoch - s_last_resync >= RTC_RESYNC_SEC)
+               || tk_day_key_from_tm(t) != last_day;
+    if (resync && ds3231_sqw_resync() == ESP_OK) {
+        *epoch = ds3231_sqw_epoch();
+        local_from_epoch(*epoch, t);
+        s_last_resync = *epoch;
+    }
+    return *epoch != 0;
 }
 
-// ================ NVS ================
-static void nvs_save_state(void) {
-    time_t now; time(&now);
-    if (now - s_last_save_epoch < 60) return; // <= 1/min
-    s_last_save_epoch = now;
+// Poll mode: time from the cached clock layer (I2C only when a discipline is due)
+static bool clock_tick(struct tm *t, time_t *epoch) {
+    int64_t us;
+    if (ds3231_clock_now(&us) != ESP_OK) return false;
+    *epoch = (time_t)(us / 1000000);
+    local_from_epoch(*epoch, t);
+    return true;
+}
+
+// ================ Persistence ================
+// Countdown state goes to the append-only journal (one 16-byte record per save, keyed
+// by user); MACs change rarely and stay in NVS, written only when they change.
+// Without a journal partition everything falls back to the NVS keys.
+static bool s_journal_ok = false;
+static uint32_t s_nvs_commits = 0;
+
+static const char *nvs_key(char buf[NVS_KEY_NAME_MAX_SIZE], const char *base, uint32_t user) {
+    if (user == 0) return base;
+    snprintf(buf, NVS_KEY_NAME_MAX_SIZE, "%s%" PRIu32, base, user);
+    return buf;
+}
 
+static void nvs_write_state(uint32_t u) {
+    const tk_state_t *st = &s_app.users.user[u];
+    char k[NVS_KEY_NAME_MAX_SIZE];
     nvs_handle_t h;
     if (nvs_open(NVS_NS, NVS_READWRITE, &h) != ESP_OK) return;
-    (void)nvs_set_u32(h, NVS_KEY_DAY, s_day_key);
-    (void)nvs_set_i32(h, NVS_KEY_REM, s_remaining);
-    (void)nvs_set_u8(h,  NVS_KEY_STARTED, s_started ? 1 : 0);
-    (void)nvs_set_u8(h,  NVS_KEY_HAVE_MAC, s_have_mac ? 1 : 0);
-    if (s_have_mac) (void)nvs_set_blob(h, NVS_KEY_MAC, s_phone_mac, 6);
+    (void)nvs_set_u32(h, nvs_key(k, NVS_KEY_DAY, u), st->day_key);
+    (void)nvs_set_i32(h, nvs_key(k, NVS_KEY_REM, u), st->remaining);
+    (void)nvs_set_u8(h,  nvs_key(k, NVS_KEY_STARTED, u), st->started ? 1 : 0);
+    (void)nvs_set_u8(h,  nvs_key(k, NVS_KEY_HAVE_MAC, u), st->have_mac ? 1 : 0);
+    if (st->have_mac) (void)nvs_set_blob(h, nvs_key(k, NVS_KEY_MAC, u), st->mac, 6);
     (void)nvs_commit(h);
     nvs_close(h);
+    s_nvs_commits++;
 }
 
-static void nvs_save_state_immediate(void) {
+// Enrollment record: MAC and latest check-in day (idle eviction); once per check-in day
+static void nvs_save_mac(uint32_t u) {
+    const tk_state_t *st = &s_app.users.user[u];
+    char k[NVS_KEY_NAME_MAX_SIZE];
     nvs_handle_t h;
     if (nvs_open(NVS_NS, NVS_READWRITE, &h) != ESP_OK) return;
-    (void)nvs_set_u32(h, NVS_KEY_DAY, s_day_key);
-    (void)nvs_set_i32(h, NVS_KEY_REM, s_remaining);
-    (void)nvs_set_u8(h,  NVS_KEY_STARTED, s_started ? 1 : 0);
-    (void)nvs_set_u8(h,  NVS_KEY_HAVE_MAC, s_have_mac ? 1 : 0);
-    if (s_have_mac) (void)nvs_set_blob(h, NVS_KEY_MAC, s_phone_mac, 6);
+    (void)nvs_set_u8(h, NVS_KEY_USERS, (uint8_t)s_app.users.n);
+    (void)nvs_set_u8(h, nvs_key(k, NVS_KEY_HAVE_MAC, u), st->have_mac ? 1 : 0);
+    if (st->have_mac) (void)nvs_set_blob(h, nvs_key(k, NVS_KEY_MAC, u), st->mac, 6);
+    (void)nvs_set_u32(h, nvs_key(k, NVS_KEY_LAST_IN, u), st->last_in);
     (void)nvs_commit(h);
     nvs_close(h);
-    s_last_save_epoch = 0;
+    s_nvs_commits++;
+}
+
+// RTC slow-memory copy of the live state; refreshed every tick, no flash cost
+static void mirror_state(void) {
+    static warm_state_t w[USERS_MAX];
+    uint32_t n = s_app.users.n;
+    for (uint32_t u = 0; u < n; u++) {
+        const tk_state_t *st = &s_app.users.user[u];
+        w[u] = (warm_state_t){
+            .day_key   = st->day_key,
+            .remaining = st->remaining,
+            .worked    = st->worked,
+            .started   = st->started ? 1 : 0,
+            .have_mac  = st->have_mac ? 1 : 0,
+            .paused    = st->paused ? 1 : 0,
+        };
+        memcpy(w[u].mac, st->mac, 6);
+    }
+    warm_state_store(w, n);
+}
+
+static void write_state(uint32_t u) {
+    if (!s_journal_ok) { nvs_write_state(u); return; }
+    const tk_state_t *st = &s_app.users.user[u];
+    journal_state_t js = {
+        .user      = (uint8_t)u,
+        .day_key   = st->day_key,
+        .remaining = st->remaining,
+        .flags     = (st->started ? JOURNAL_FLAG_STARTED : 0) | (st->have_mac ? JOURNAL_FLAG_HAVE_MAC : 0) |
+                     (st->paused ? JOURNAL_FLAG_PAUSED : 0),
+    };
+    (void)journal_append(&js);
 }
 
-static void nvs_load_state(void) {
+// Write the users in a bit mask (bit u = user u); tk_app decides when
+static void state_save_mask(uint64_t mask) {
+    if (!mask) return;
+    mirror_state();
+    for (; mask; mask &= mask - 1) write_state((uint32_t)__builtin_ctzll(mask));
+}
+
+static void mac_save_mask(uint64_t mask) {
+    for (; mask; mask &= mask - 1) nvs_save_mac((uint32_t)__builtin_ctzll(mask));
+}
+
+// What a station event asked for: the enrollment record first, then the state
+static void persist(const tk_app_out_t *o) {
+    if (o->save_mac)   nvs_save_mac((uint32_t)o->user);
+    if (o->save_state) state_save_mask(1ull << o->user);
+}
+
+// Per-unit policy overrides from NVS, then one lookup into tk_core's dispatch table
+static void policy_load(void) {
+    static const char *const deauth_str[] = {
+        [TK_DEAUTH_NONE] = "never", [TK_DEAUTH_FIRST_CONNECT] = "first connect", [TK_DEAUTH_ALWAYS] = "always"
+    };
     nvs_handle_t h;
-    if (nvs_open(NVS_NS, NVS_READONLY, &h) != ESP_OK) return;
+    if (nvs_open(NVS_NS, NVS_READONLY, &h) == ESP_OK) {
+        uint8_t v;
+        if (nvs_get_u8(h, NVS_KEY_POL_DEAUTH, &v) == ESP_OK) {
+            if (v <= TK_DEAUTH_ALWAYS) s_tk_cfg.deauth = (tk_deauth_policy_t)v;
+            else ESP_LOGW(TAG, "ignoring %s=%u", NVS_KEY_POL_DEAUTH, v);
+        }
+        if (nvs_get_u8(h, NVS_KEY_POL_RELRN, &v) == ESP_OK) s_tk_cfg.relearn_mac_daily = (v != 0);
+        nvs_close(h);
+    }
+    tk_config_resolve(&s_tk_cfg);
+    ESP_LOGI(TAG, "policy: deauth %s, MAC relearn %s", deauth_str[s_tk_cfg.deauth],
+             s_tk_cfg.relearn_mac_daily ? "before check-in" : "never");
+}
+
+static void state_load(void) {
+    tk_app_init(&s_app, &s_tk_cfg, USERS_MAX, FLASH_SAVE_SEC);
+    s_journal_ok = (journal_init() == ESP_OK);
 
-    uint8_t b = 0;
-    uint32_t dk;
-    int32_t rem;
-    size_t len = 6;
+    nvs_handle_t h;
+    bool nvs_ok = (nvs_open(NVS_NS, NVS_READONLY, &h) == ESP_OK);
 
-    if (nvs_get_u32(h, NVS_KEY_DAY, &dk) == ESP_OK) s_day_key = dk;
-    if (nvs_get_i32(h, NVS_KEY_REM, &rem) == ESP_OK) s_remaining = rem;
-    if (nvs_get_u8(h, NVS_KEY_STARTED, &b) == ESP_OK) s_started = (b != 0);
-    if (nvs_get_u8(h, NVS_KEY_HAVE_MAC, &b) == ESP_OK) s_have_mac = (b != 0);
-    if (s_have_mac && nvs_get_blob(h, NVS_KEY_MAC, s_phone_mac, &len) != ESP_OK) {
-        s_have_mac = false;
-        memset(s_phone_mac, 0, 6);
+    // Enrolled count; units from before the user table have one user at most
+    uint8_t n = 0, b = 0;
+    if (nvs_ok && nvs_get_u8(h, NVS_KEY_USERS, &n) != ESP_OK) {
+        n = (nvs_get_u8(h, NVS_KEY_HAVE_MAC, &b) == ESP_OK && b) ? 1 : 0;
     }
-    nvs_close(h);
+    if (n > USERS_MAX) n = USERS_MAX;
+
+    for (uint32_t u = 0; u < n; u++) {
+        tk_state_t *st = &s_app.users.user[u];
+        tk_core_init(st, &s_tk_cfg);
+        char k[NVS_KEY_NAME_MAX_SIZE];
+        uint32_t dk;
+        int32_t rem;
+        size_t len = 6;
+
+        journal_state_t js;
+        if (s_journal_ok && journal_load((uint8_t)u, &js) == ESP_OK) {
+            st->day_key   = js.day_key;
+            st->remaining = js.remaining;
+            st->started   = (js.flags & JOURNAL_FLAG_STARTED) != 0;
+            st->paused    = (js.flags & JOURNAL_FLAG_PAUSED) != 0;
+        } else {
+            // first boot on the journal (or no journal): take the legacy keys
+            if (nvs_get_u32(h, nvs_key(k, NVS_KEY_DAY, u), &dk) == ESP_OK) st->day_key = dk;
+            if (nvs_get_i32(h, nvs_key(k, NVS_KEY_REM, u), &rem) == ESP_OK) st->remaining = rem;
+            if (nvs_get_u8(h, nvs_key(k, NVS_KEY_STARTED, u), &b) == ESP_OK) st->started = (b != 0);
+        }
+        st->have_mac = (nvs_get_blob(h, nvs_key(k, NVS_KEY_MAC, u), st->mac, &len) == ESP_OK);
+        if (!st->have_mac) memset(st->mac, 0, 6);
+        if (nvs_get_u32(h, nvs_key(k, NVS_KEY_LAST_IN, u), &dk) == ESP_OK) st->last_in = dk;
+    }
+    s_app.users.n = n;
+    if (nvs_ok) nvs_close(h);
+
+    // After a soft reset the RTC copy is newer than anything in flash
+    static warm_state_t w[USERS_MAX];
+    uint32_t wn;
+    if (warm_state_load(w, USERS_MAX, &wn) && wn >= s_app.users.n) {
+        for (uint32_t u = 0; u < wn; u++) {
+            tk_state_t *st = &s_app.users.user[u];
+            if (u >= s_app.users.n) tk_core_init(st, &s_tk_cfg);
+            st->day_key   = w[u].day_key;
+            st->remaining = w[u].remaining;
+            st->worked    = w[u].worked;
+            st->started   = w[u].started != 0;
+            st->paused    = w[u].paused != 0;
+            st->have_mac  = w[u].have_mac != 0;
+            memcpy(st->mac, w[u].mac, 6);
+        }
+        s_app.users.n = wn;
+        ESP_LOGI(TAG, "Warm restart: resumed %" PRIu32 " users from RTC memory", wn);
+    }
+
+    // Migrate: journal gets a record for anyone it does not know yet
+    if (s_journal_ok) {
+        for (uint32_t u = 0; u < s_app.users.n; u++) {
+            journal_state_t js;
+            if (journal_load((uint8_t)u, &js) != ESP_OK) write_state(u);
+        }
+    }
+    ESP_LOGI(TAG, "%" PRIu32 " enrolled users (max %d)", s_app.users.n, USERS_MAX);
+}
+
+// ================ Work history ================
+// Day records for HR in the history partition: written at check-in (so the time survives
+// a reboot), when the target is reached, on every pause, and once more when the day closes.
+typedef struct {
+    int32_t checkin_sod;                       // seconds since local midnight; -1 = none
+    int32_t done_sod;                          // target reached; -1 = not yet
+} day_log_t;
+
+static bool      s_history_ok = false;
+static day_log_t s_day_log[TK_USERS_MAX];
+
+static int32_t sod_from_epoch(time_t e) { return tk_civil_sod(e, TK_CIVIL_IST_OFFSET); }
+
+static void day_log_reset(uint32_t u) {
+    s_day_log[u] = (day_log_t){ .checkin_sod = -1, .done_sod = -1 };
+}
+
+static void history_write(uint32_t u, uint8_t flags) {
+    if (!s_history_ok) return;
+    const tk_state_t *st = &s_app.users.user[u];
+    const day_log_t  *l  = &s_day_log[u];
+    // overtime: on-site time past the target
+    int32_t overtime = st->worked > s_tk_cfg.daily_target_sec ? st->worked - s_tk_cfg.daily_target_sec : 0;
+    history_day_t d = {
+        .day_key     = st->day_key,
+        .user        = (uint8_t)u,
+        .flags       = (uint8_t)(flags | (st->started ? HISTORY_F_CHECKED_IN : 0) |
+                                 (st->remaining <= 0 ? HISTORY_F_DONE : 0)),
+        .checkin_sod = l->checkin_sod,
+        .done_sod    = l->done_sod,
+        .worked      = st->worked,
+        .remaining   = st->remaining,
+        .overtime    = overtime,
+    };
+    esp_err_t err = history_append(&d);
+    if (err != ESP_OK) ESP_LOGW(TAG, "history append (user %" PRIu32 "): %s", u, esp_err_to_name(err));
+}
+
+// Final record for everyone who checked in; call before the day's counters reset
+static void history_close_day(void) {
+    for (uint32_t u = 0; u < s_app.users.n; u++) {
+        if (s_app.users.user[u].started) history_write(u, HISTORY_F_FINAL);
+        day_log_reset(u);
+    }
+}
+
+static bool history_restore_cb(const history_day_t *d, void *ctx) {
+    if (d->user < s_app.users.n && s_app.users.user[d->user].day_key == d->day_key) {
+        day_log_t  *l  = &s_day_log[d->user];
+        tk_state_t *st = &s_app.users.user[d->user];
+        l->checkin_sod = d->checkin_sod;
+        l->done_sod    = d->done_sod;
+        // the journal keeps only the countdown; the record also has the time past the target
+        if (d->worked > st->worked) st->worked = d->worked;
+    }
+    return true;
+}
+
+// Check-in/done times of the persisted day(s): reads only the months involved
+static void history_restore(void) {
+    uint32_t from = UINT32_MAX, to = 0;
+    for (uint32_t u = 0; u < s_app.users.n; u++) {
+        day_log_reset(u);
+        const tk_state_t *st = &s_app.users.user[u];
+        if (!st->started) continue;
+        if (st->day_key < from) from = st->day_key;
+        if (st->day_key > to)   to   = st->day_key;
+    }
+    if (s_history_ok && from <= to) (void)history_query(from, to, history_restore_cb, NULL);
+}
+
+// ================ Per-day cost ================
+// Side effects of one day of ticking, logged at rollover: flash writes, display
+// traffic, RTC bus traffic and the CPU time of the tick body itself.
+typedef struct {
+    uint32_t nvs_commits;
+    uint32_t journal_appends;
+    uint32_t journal_erases;
+    uint32_t frames_sent;       // TM1637 bus frames
+    uint32_t frames_skipped;    // frames identical to the shadow (no bus traffic)
+    uint32_t i2c_txns;
+} cost_counters_t;
+
+static cost_counters_t s_cost_base;          // counters at the start of the day
+static uint32_t        s_cost_ticks;
+static int64_t         s_cost_tick_us_total;
+static int64_t         s_cost_tick_us_max;
+
+static void cost_sample(cost_counters_t *c) {
+    tm1637_stats_t ts;
+    tm1637_get_stats(&ts);
+    journal_stats_t js = {0};
+    if (s_journal_ok) journal_get_stats(&js);
+    c->nvs_commits     = s_nvs_commits;
+    c->journal_appends = js.appends;
+    c->journal_erases  = js.erases;
+    c->frames_sent     = ts.frames_sent;
+    c->frames_skipped  = ts.frames_skipped;
+    c->i2c_txns        = s_rtc_ok ? ds3231_get_txn_count() : 0;
+}
+
+static void cost_tick(int64_t t0_us) {
+    int64_t dt = esp_timer_get_time() - t0_us;
+    s_cost_ticks++;
+    s_cost_tick_us_total += dt;
+    if (dt > s_cost_tick_us_max) s_cost_tick_us_max = dt;
+}
+
+// Log the day that just ended (day_key) and start counting the next one
+static void cost_rollover(uint32_t day_key) {
+    cost_counters_t now;
+    cost_sample(&now);
+    if (s_cost_ticks) {
+        ESP_LOGI(TAG, "day %" PRIu32 " cost: nvs %" PRIu32 ", journal %" PRIu32 " (%" PRIu32 " erases), "
+                 "frames %" PRIu32 " sent / %" PRIu32 " skipped, i2c %" PRIu32 ", "
+                 "ticks %" PRIu32 " avg %" PRId64 " us max %" PRId64 " us",
+                 day_key,
+                 now.nvs_commits     - s_cost_base.nvs_commits,
+                 now.journal_appends - s_cost_base.journal_appends,
+                 now.journal_erases  - s_cost_base.journal_erases,
+                 now.frames_sent     - s_cost_base.frames_sent,
+                 now.frames_skipped  - s_cost_base.frames_skipped,
+                 now.i2c_txns        - s_cost_base.i2c_txns,
+                 s_cost_ticks, s_cost_tick_us_total / s_cost_ticks, s_cost_tick_us_max);
+    }
+    s_cost_base = now;
+    s_cost_ticks = 0;
+    s_cost_tick_us_total = 0;
+    s_cost_tick_us_max = 0;
 }
 
 // ================ Deauth timer ================
+// (Re)arm the one-shot timer for the earliest pending deauth
+static void deauth_rearm(void) {
+    int64_t next = INT64_MAX;
+    portENTER_CRITICAL(&s_deauth_mux);
+    for (int i = 0; i < SOFTAP_MAX_CONN; i++) {
+        if (s_deauth[i].aid && s_deauth[i].due_us < next) next = s_deauth[i].due_us;
+    }
+    portEXIT_CRITICAL(&s_deauth_mux);
+
+    (void)esp_timer_stop(s_deauth_timer);
+    if (next == INT64_MAX) return;
+    int64_t wait = next - esp_timer_get_time();
+    if (wait < 1000) wait = 1000;
+    (void)esp_timer_start_once(s_deauth_timer, (uint64_t)wait);
+}
+
+static void deauth_schedule(uint16_t aid, const uint8_t mac[6]) {
+    bool queued = false;
+    portENTER_CRITICAL(&s_deauth_mux);
+    int slot = -1;
+    for (int i = 0; i < SOFTAP_MAX_CONN; i++) {
+        if (s_deauth[i].aid == aid) { slot = i; break; }
+        if (slot < 0 && s_deauth[i].aid == 0) slot = i;
+    }
+    if (slot >= 0) {
+        s_deauth[slot].aid = aid;
+        memcpy(s_deauth[slot].mac, mac, 6);
+        s_deauth[slot].due_us = esp_timer_get_time() + (int64_t)DEAUTH_DELAY_MS * 1000;
+        queued = true;
+    }
+    portEXIT_CRITICAL(&s_deauth_mux);
+
+    if (!queued) { DLOG(DLOG_DEAUTH_FULL, aid); return; }
+    DLOG(DLOG_DEAUTH_SCHED, DEAUTH_DELAY_MS, aid);
+    deauth_rearm();
+}
+
+static void deauth_cancel(uint16_t aid) {
+    portENTER_CRITICAL(&s_deauth_mux);
+    for (int i = 0; i < SOFTAP_MAX_CONN; i++) {
+        if (s_deauth[i].aid == aid) s_deauth[i].aid = 0;
+    }
+    portEXIT_CRITICAL(&s_deauth_mux);
+    deauth_rearm();
+}
+
 static void deauth_timer_cb(void *arg) {
-    if (s_deauth_pending && s_deauth_aid != 0) {
-        esp_err_t r = esp_wifi_deauth_sta(s_deauth_aid); // IDF v5.3: by AID
-        s_deauth_pending = false;
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < SOFTAP_MAX_CONN; i++) {
+        deauth_slot_t d = {0};
+        portENTER_CRITICAL(&s_deauth_mux);
+        if (s_deauth[i].aid && s_deauth[i].due_us <= now) {
+            d = s_deauth[i];
+            s_deauth[i].aid = 0;
+        }
+        portEXIT_CRITICAL(&s_deauth_mux);
+        if (!d.aid) continue;
+
+        esp_err_t r = esp_wifi_deauth_sta(d.aid); // IDF v5.3: by AID
         if (r != ESP_OK) {
-            ESP_LOGW(TAG, "deauth (AID=%u) failed: %s", (unsigned)s_deauth_aid, esp_err_to_name(r));
+            DLOG(DLOG_DEAUTH_FAIL, d.aid, DLOG_STR(esp_err_to_name(r)));
         } else {
-            print_mac("Deauth sent (delayed) to:", s_deauth_mac);
+            DLOG(DLOG_DEAUTH_SENT, d.aid, d.mac[0], d.mac[1], d.mac[2], d.mac[3], d.mac[4], d.mac[5]);
         }
-        s_deauth_aid = 0;
     }
+    deauth_rearm();
 }
 
-// ================ Wi-Fi SoftAP ================
-static void wifi_event_handler(void* arg, esp_event_base_t base, int32_t id, void* data) {
-    if (base == WIFI_EVENT && id == WIFI_EVENT_AP_STACONNECTED) {
-        wifi_event_ap_staconnected_t *ev = (wifi_event_ap_staconnected_t*)data;
-        print_mac("STA connected:", ev->mac);
-        ESP_LOGI(TAG, "STA AID=%u", (unsigned)ev->aid);
-
-        bool mac_matches = s_have_mac && (memcmp(s_phone_mac, ev->mac, 6) == 0);
-        bool can_relearn =
-        #ifdef RELEARN_MAC_DAILY
-            (!s_started);   // only before first check-in of the day
-        #else
-            false;
-        #endif
-
-        bool accept_as_phone = (!s_have_mac) || mac_matches || can_relearn;
-
-        if (accept_as_phone) {
-            if (!s_have_mac || (!mac_matches && can_relearn)) {
-                memcpy((void*)s_phone_mac, ev->mac, 6);
-                s_have_mac = true;
-                print_mac("Phone MAC set/updated to:", s_phone_mac);
-                nvs_save_state_immediate();
-            }
+// ================ Owner task ================
+#if RSSI_GATE
+// Associations waiting for their signal to turn near (owner task only)
+typedef struct {
+    uint16_t aid;                                  // 0 = free
+    uint8_t  mac[6];
+} held_t;
 
-            bool should_deauth = false;
-            #ifdef AUTO_DEAUTH_ALWAYS
-                should_deauth = true;
-            #endif
-            #ifdef AUTO_DEAUTH_ON_FIRST_CONNECT
-                if (!s_started) should_deauth = true;
-            #endif
-
-            if (!s_started) {
-                s_started = true;
-                ESP_LOGI(TAG, "Checked in: starting today's countdown");
-                nvs_save_state_immediate();
-            } else {
-                ESP_LOGI(TAG, "Already started today");
-            }
+static held_t s_held[SOFTAP_MAX_CONN];
 
-            if (should_deauth && s_deauth_timer) {
-                memcpy(s_deauth_mac, ev->mac, 6);
-                s_deauth_aid = ev->aid;           // <-- capture AID for deauth
-                s_deauth_pending = true;
-                (void)esp_timer_stop(s_deauth_timer);
-                ESP_LOGI(TAG, "Scheduling deauth in %d ms (AID=%u)", DEAUTH_DELAY_MS, (unsigned)s_deauth_aid);
-                ESP_ERROR_CHECK(esp_timer_start_once(s_deauth_timer, (uint64_t)DEAUTH_DELAY_MS * 1000));
-            } else {
-                ESP_LOGI(TAG, "Deauth not scheduled (policy/state)");
+static void held_put(const uint8_t mac[6], uint16_t aid) {
+    held_t *free_h = NULL;
+    for (int i = 0; i < SOFTAP_MAX_CONN; i++) {
+        if (s_held[i].aid == aid) { free_h = &s_held[i]; break; }
+        if (!s_held[i].aid && !free_h) free_h = &s_held[i];
+    }
+    if (!free_h) return;                           // cannot happen: one per associated station
+    free_h->aid = aid;
+    memcpy(free_h->mac, mac, 6);
+}
+
+// AID held for mac (released), or 0
+static uint16_t held_take(const uint8_t mac[6]) {
+    for (int i = 0; i < SOFTAP_MAX_CONN; i++) {
+        if (s_held[i].aid && memcmp(s_held[i].mac, mac, 6) == 0) {
+            uint16_t aid = s_held[i].aid;
+            s_held[i].aid = 0;
+            return aid;
+        }
+    }
+    return 0;
+}
+#endif
+
+// Today's countdown started for u at now: history record (caller persists the state)
+static void note_checkin(int u, time_t now) {
+    s_day_log[u].checkin_sod = sod_from_epoch(now);
+    history_write((uint32_t)u, 0);
+}
+
+// Association accepted as a check-in candidate (directly, or once its signal is near)
+static void connect_accept(const uint8_t *m, uint16_t aid) {
+    time_t now = time(NULL);
+    tk_app_out_t o;
+    tk_app_connect(&s_app, m, now, &o);
+    int u = o.user;
+    if (u < 0) {
+        DLOG(DLOG_UNKNOWN_STA);
+        return;
+    }
+    if (o.c.evicted) DLOG(DLOG_EVICTED, u, USERS_EVICT_IDLE_DAYS);
+    if (o.c.mac_updated) {
+        DLOG(DLOG_ENROLLED, u, s_app.users.n, m[0], m[1], m[2], m[3], m[4], m[5]);
+        presence_clear();
+        for (uint32_t i = 0; i < s_app.users.n; i++) {
+            if (s_app.users.user[i].have_mac) (void)presence_enroll(s_app.users.user[i].mac);
+        }
+    }
+    if (o.c.checked_in) {
+        DLOG(DLOG_CHECKED_IN, u);
+        note_checkin(u, now);
+    } else if (o.resumed) {
+        DLOG(DLOG_RESUMED, u);
+    } else {
+        DLOG(DLOG_ALREADY, u);
+    }
+    persist(&o);
+
+    if (o.deauth && s_deauth_timer) {
+        deauth_schedule(aid, m);
+    } else {
+        DLOG(DLOG_DEAUTH_NONE);
+    }
+}
+
+static void apply_connect(const tk_evt_t *ev) {
+    const uint8_t *m = ev->mac;
+    DLOG(DLOG_STA_CONNECTED, m[0], m[1], m[2], m[3], m[4], m[5], ev->aid);
+#if RSSI_GATE
+    // Just associated, usually before the filter has enough samples: decide on RSSI_EVENT_NEAR
+    if (!rssi_is_near(m)) {
+        held_put(m, ev->aid);
+        DLOG(DLOG_HELD, m[0], m[1], m[2], m[3], m[4], m[5], ev->aid);
+        return;
+    }
+#endif
+    connect_accept(m, ev->aid);
+}
+
+static void apply_disconnect(const tk_evt_t *ev) {
+    const uint8_t *m = ev->mac;
+    DLOG(DLOG_STA_GONE, m[0], m[1], m[2], m[3], m[4], m[5], ev->aid);
+#if RSSI_GATE
+    (void)held_take(m);
+#endif
+    // leaving is only the last sighting; the pause comes from the tick once the grace runs out
+    (void)tk_app_disconnect(&s_app, ev->mac, time(NULL));
+    if (s_deauth_timer) deauth_cancel(ev->aid);
+}
+
+// Enrolled phone seen over the air: same check-in (or resume) as a connect, minus the deauth
+static void apply_presence(const tk_evt_t *ev) {
+#if RSSI_GATE
+    if (!rssi_is_near(ev->mac)) return;            // the handler fed the frame to the filter
+#endif
+    time_t now = time(NULL);
+    tk_app_out_t o;
+    tk_app_seen(&s_app, ev->mac, now, &o);
+    if (o.c.checked_in) {
+        DLOG(DLOG_SNIFFED, o.user, ev->rssi, ev->subtype);
+        note_checkin(o.user, now);
+    } else if (o.resumed) {
+        DLOG(DLOG_RESUMED, o.user);
+    }
+    if (o.user >= 0) persist(&o);
+}
+
+#if RSSI_GATE
+// Smoothed signal crossed a threshold. Near: a held association goes through the normal
+// connect path; otherwise it is a sighting. Far: the phone no longer counts as in range.
+static void apply_rssi(const tk_evt_t *ev) {
+    const uint8_t *m = ev->mac;
+    bool near = (ev->type == TK_EVT_RSSI_NEAR);
+    if (near) DLOG(DLOG_RSSI_NEAR, m[0], m[1], m[2], m[3], m[4], m[5], ev->rssi);
+    else DLOG(DLOG_RSSI_FAR, m[0], m[1], m[2], m[3], m[4], m[5], ev->rssi);
+    if (near) {
+        uint16_t aid = held_take(m);
+        if (aid) { connect_accept(m, aid); return; }
+    }
+    // in range without a held association (sniffed frames): a check-in has no deauth
+    time_t now = time(NULL);
+    tk_app_out_t o;
+    tk_app_link(&s_app, m, near, now, &o);
+    if (o.c.checked_in) {
+        DLOG(DLOG_CHECKED_IN, o.user);
+        note_checkin(o.user, now);
+    } else if (o.resumed) {
+        DLOG(DLOG_RESUMED, o.user);
+    }
+    if (o.user >= 0) persist(&o);
+}
+#endif
+
+static void apply_tick(const tick_msg_t *m) {
+    int64_t t0_us = esp_timer_get_time();
+
+    // Day boundary (IST): close the ending day here; every user resets inside tk_app_tick()
+    if (tk_app_new_day(&s_app, m->today)) {
+        history_close_day();
+        cost_rollover(s_app.today);
+        ESP_LOGI(TAG, "New day %" PRIu32 " - reset to 9:15", m->today);
+        if (s_journal_ok) {
+            journal_stats_t js;
+            journal_get_stats(&js);
+            ESP_LOGI(TAG, "journal: seq %" PRIu32 ", %" PRIu32 " erases (lifetime), %" PRIu32 " carried, "
+                     "%" PRIu64 " flash / %" PRIu64 " payload bytes since boot",
+                     js.seq, js.lifetime_erases, js.carried, js.flash_bytes, js.payload_bytes);
+        }
+        if (s_history_ok) {
+            history_stats_t hs;
+            history_get_stats(&hs);
+            ESP_LOGI(TAG, "history: %" PRIu32 "/%" PRIu32 " records, %" PRIu32 " months, %" PRIu32 " appends, "
+                     "%" PRIu32 " erases since boot", hs.pos < hs.capacity ? hs.pos : hs.capacity, hs.capacity,
+                     hs.months, hs.appends, hs.erases);
+        }
+        if (power_enabled()) power_dump(stdout);
+        event_ring_stats_t es;
+        event_ring_get_stats(&es);
+        ESP_LOGI(TAG, "events: %" PRIu32 " queued, %" PRIu32 " dropped, depth hwm %" PRIu32 "/%d; "
+                 "handler p50/p99/max %" PRIu32 "/%" PRIu32 "/%" PRIu32 " us, "
+                 "to worker p50/p99/max %" PRIu32 "/%" PRIu32 "/%" PRIu32 " us",
+                 es.pushed, es.dropped, es.depth_hwm, EVENT_RING_DEPTH,
+                 lat_hist_pct(&es.handler, 50), lat_hist_pct(&es.handler, 99), es.handler.max_us,
+                 lat_hist_pct(&es.queued, 50), lat_hist_pct(&es.queued, 99), es.queued.max_us);
+        dlog_stats_t ds;
+        dlog_get_stats(&ds);
+        ESP_LOGI(TAG, "dlog: %" PRIu32 " written, %" PRIu32 " dropped (status %" PRIu32 "), depth hwm %" PRIu32 "/%d",
+                 ds.written, ds.dropped, ds.dropped_by_id[DLOG_STATUS], ds.depth_hwm, DLOG_DEPTH);
+#if HTTP_API
+        http_api_stats_t hs;
+        http_api_get_stats(&hs);
+        ESP_LOGI(TAG, "http: status %" PRIu32 " (%" PRIu32 " not modified, %" PRIu32 " builds), history %" PRIu32,
+                 hs.ep[HTTP_EP_STATUS].requests, hs.ep[HTTP_EP_STATUS].not_modified, hs.status_builds,
+                 hs.ep[HTTP_EP_HISTORY].requests);
+#endif
+        ESP_LOGI(TAG, "connect limiter: %" PRIu32 " passed, dropped %" PRIu32 " rate / %" PRIu32 " back-off / "
+                 "%" PRIu32 " global / %" PRIu32 " paired disconnects; MACs %" PRIu32 " recycled, %" PRIu32 " displaced, "
+                 "%" PRIu32 " untracked",
+                 s_rl.passed, s_rl.dropped[TK_RL_DROP_RATE], s_rl.dropped[TK_RL_DROP_BACKOFF],
+                 s_rl.dropped[TK_RL_DROP_GLOBAL], s_rl.dropped_disconnects, s_rl.recycled, s_rl.displaced,
+                 s_rl.untracked);
+#if RSSI_GATE
+        rssi_stats_t rs;
+        rssi_get_stats(&rs);
+        ESP_LOGI(TAG, "rssi: %" PRIu32 " samples (+%" PRIu32 " sniffed), %" PRIu32 " near / %" PRIu32 " far, "
+                 "pass p99/max %" PRIu32 "/%" PRIu32 " us", rs.listed, rs.fed, rs.near, rs.far,
+                 lat_hist_pct(&rs.cost, 99), rs.cost.max_us);
+#endif
+    }
+
+    // One pass over all users; transitions persist now, minute marks on the slow interval
+    tk_app_tick_t t;
+    tk_app_tick(&s_app, m->epoch, m->today, &t);
+    for (uint64_t done = t.ev.done; done; done &= done - 1) {
+        uint32_t u = (uint32_t)__builtin_ctzll(done);
+        s_day_log[u].done_sod = sod_from_epoch(m->epoch);
+        history_write(u, 0);
+    }
+    for (uint64_t away = t.ev.pause; away; away &= away - 1) {
+        uint32_t u = (uint32_t)__builtin_ctzll(away);
+        const tk_state_t *st = &s_app.users.user[u];
+        int32_t since = sod_from_epoch(st->last_seen);
+        DLOG(DLOG_PAUSED, u, since / 3600, since / 60 % 60, st->session_worked / 60, st->worked / 60);
+        history_write(u, 0);
+    }
+    state_save_mask(t.save_now | t.save_due);
+    mirror_state();
+    cost_tick(t0_us);
+}
+
+static void publish_state(time_t epoch) {
+    static tk_snapshot_t snap;                     // owner-only scratch, too big for the stack
+    snap.today   = s_app.today;
+    snap.epoch   = epoch;
+    snap.focus   = s_app.focus;
+    snap.n       = s_app.users.n;
+    snap.running = 0;
+    for (uint32_t u = 0; u < s_app.users.n; u++) {
+        snap.user[u] = s_app.users.user[u];
+        snap.running += (tk_core_phase(&s_app.users.user[u]) == TK_RUN);
+    }
+    snapshot_publish(&snap);
+}
+
+static void owner_task(void *arg) {
+    time_t last_epoch = 0;
+    publish_state(last_epoch);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        bool changed = false;
+
+        tk_evt_t ev;
+        while (event_ring_pop(&ev)) {
+            switch (ev.type) {
+            case TK_EVT_STA_CONNECTED:    apply_connect(&ev);    break;
+            case TK_EVT_STA_DISCONNECTED: apply_disconnect(&ev); break;
+            case TK_EVT_PRESENCE:         apply_presence(&ev);   break;
+#if RSSI_GATE
+            case TK_EVT_RSSI_NEAR:
+            case TK_EVT_RSSI_FAR:         apply_rssi(&ev);       break;
+#endif
+            default: break;
             }
-        } else {
-            ESP_LOGW(TAG, "Unknown device ignored (stored MAC exists and does not match; not first connect of day)");
+            changed = true;
+        }
+        tick_msg_t m;
+        if (xQueueReceive(s_tick_q, &m, 0) == pdTRUE) {
+            apply_tick(&m);
+            last_epoch = m.epoch;
+            changed = true;
         }
+        if (changed) publish_state(last_epoch);
+    }
+}
+
+// ================ Wi-Fi SoftAP ================
+// Both handlers run on the default event loop task (the ring's single producer):
+// copy the event into the ring and wake the worker, nothing else.
+static void post_event(tk_evt_t *ev) {
+    if (event_ring_push(ev) && s_owner_task) xTaskNotifyGive(s_owner_task);
+}
+
+static void wifi_event_handler(void* arg, esp_event_base_t base, int32_t id, void* data) {
+    tk_evt_t ev = { .ts_us = esp_timer_get_time() };
+    if (base == WIFI_EVENT && id == WIFI_EVENT_AP_STACONNECTED) {
+        const wifi_event_ap_staconnected_t *e = (const wifi_event_ap_staconnected_t*)data;
+        // over budget: no ring slot, no log, no deauth timer, no flash. The enrolled set is
+        // presence's (locked, any task): s_app.users belongs to the owner task
+        bool enrolled = presence_is_enrolled(e->mac);
+        if (tk_rl_connect(&s_rl, &s_rl_cfg, e->mac, enrolled, (uint32_t)(ev.ts_us / 1000)) != TK_RL_PASS) return;
+        ev.type = TK_EVT_STA_CONNECTED;
+        ev.aid  = e->aid;
+        memcpy(ev.mac, e->mac, 6);
     } else if (base == WIFI_EVENT && id == WIFI_EVENT_AP_STADISCONNECTED) {
-        wifi_event_ap_stadisconnected_t *ev = (wifi_event_ap_stadisconnected_t*)data;
-        print_mac("STA disconnected:", ev->mac);
-        ESP_LOGI(TAG, "STA AID=%u", (unsigned)ev->aid);
-        if (s_deauth_timer) (void)esp_timer_stop(s_deauth_timer);
-        s_deauth_pending = false;
-        s_deauth_aid = 0;
+        const wifi_event_ap_stadisconnected_t *e = (const wifi_event_ap_stadisconnected_t*)data;
+        if (tk_rl_disconnect(&s_rl, e->mac)) return;   // its connect was dropped
+        ev.type = TK_EVT_STA_DISCONNECTED;
+        ev.aid  = e->aid;
+        memcpy(ev.mac, e->mac, 6);
+    } else {
+        return;
     }
+    post_event(&ev);
+}
+
+static void presence_event_handler(void* arg, esp_event_base_t base, int32_t id, void* data) {
+    const presence_event_t *p = (const presence_event_t*)data;
+    tk_evt_t ev = {
+        .type    = TK_EVT_PRESENCE,
+        .rssi    = p->rssi,
+        .subtype = p->subtype,
+        .ts_us   = esp_timer_get_time(),
+    };
+    memcpy(ev.mac, p->mac, 6);
+    post_event(&ev);
 }
 
+#if RSSI_GATE
+static void rssi_event_handler(void* arg, esp_event_base_t base, int32_t id, void* data) {
+    const rssi_event_t *r = (const rssi_event_t*)data;
+    tk_evt_t ev = {
+        .type  = (id == RSSI_EVENT_NEAR) ? TK_EVT_RSSI_NEAR : TK_EVT_RSSI_FAR,
+        .rssi  = r->dbm,
+        .ts_us = esp_timer_get_time(),
+    };
+    memcpy(ev.mac, r->mac, 6);
+    post_event(&ev);
+}
+#endif
+
 static void wifi_init_softap(void) {
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
@@ -253,6 +990,8 @@ static void wifi_init_softap(void) {
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
 
+    tk_rl_init(&s_rl, &s_rl_cfg, (uint32_t)(esp_timer_get_time() / 1000));
+
     ESP_ERROR_CHECK(esp_event_handler_instance_register(
         WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL, NULL));
 
@@ -269,55 +1008,130 @@ static void wifi_init_softap(void) {
     ESP_ERROR_CHECK(esp_wifi_start());
 
     ESP_LOGI(TAG, "SoftAP started: SSID=%s, PASS=%s, CH=%d", SOFTAP_SSID, SOFTAP_PASS, SOFTAP_CHANNEL);
+
+#if PRESENCE_SNIFF
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(
+        PRESENCE_EVENT, PRESENCE_EVENT_SEEN, &presence_event_handler, NULL, NULL));
+    presence_config_t pcfg = { .debounce_ms = PRESENCE_DEBOUNCE_MS, .rssi_min = PRESENCE_RSSI_MIN };
+#if RSSI_GATE
+    // Every sniffed frame counts towards near/far, not just the debounced sightings,
+    // paced like the station-list poll the filter is tuned for
+    pcfg.on_sample = rssi_feed;
+    pcfg.sample_ms = RSSI_PERIOD_MS;
+#endif
+    (void)presence_start(&pcfg);
+#endif
+#if RSSI_GATE
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(
+        RSSI_EVENT, ESP_EVENT_ANY_ID, &rssi_event_handler, NULL, NULL));
+    rssi_config_t rcfg = {
+        .filter    = { .enter_dbm = RSSI_ENTER_DBM, .leave_dbm = RSSI_LEAVE_DBM,
+                       .shift = RSSI_EWMA_SHIFT, .min_samples = RSSI_MIN_SAMPLES },
+        .period_ms = RSSI_PERIOD_MS,
+        .stale_ms  = RSSI_STALE_MS,
+        .task_prio = RSSI_TASK_PRIO,
+        .core      = 0,                            // next to the Wi-Fi task it queries
+    };
+    ESP_ERROR_CHECK(rssi_start(&rcfg));
+#endif
 }
 
 // ================ App ================
-void app_main(void) {
-    setvbuf(stdout, NULL, _IONBF, 0);
-    ESP_ERROR_CHECK(nvs_flash_init());
+// ================ Boot ================
+// Display first ("boot"), then RTC, storage and Wi-Fi bring-up in parallel on both
+// cores. The countdown is shown as soon as RTC + storage are in; Wi-Fi finishes on its own.
+#define BOOT_EV_NVS        BIT0               // nvs_flash_init() done (Wi-Fi needs it)
+#define BOOT_EV_STORAGE    BIT1               // users, journal, history loaded
+#define BOOT_EV_RTC        BIT2               // system time set from the RTC (or RTC absent)
+#define BOOT_EV_WIFI       BIT3               // SoftAP (and HTTP API) up
 
-    // IST (UTC+5:30). POSIX sign inverted.
-    setenv("TZ", "IST-5:30", 1);
-    tzset();
+static struct tm s_boot_tm;                   // RTC time read by the RTC job
+static bool      s_boot_tm_ok = false;
 
-    // DS3231 init
+static void boot_rtc(void) {
     ds3231_config_t rtc = { .port=I2C_PORT, .sda=I2C_SDA, .scl=I2C_SCL, .clk_hz=I2C_FREQ_HZ };
-    if (ds3231_init(&rtc) == ESP_OK) {
-        s_rtc_ok = true;
-        i2c_scan(I2C_PORT);
-        struct tm t = {0};
-        if (ds3231_get_time(&t) == ESP_OK) {
-            printf("RTC @ boot: %04d-%02d-%02d %02d:%02d:%02d\n",
-                   t.tm_year+1900, t.tm_mon+1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec);
-            set_system_time_from_tm(&t);
-        } else {
-            ESP_LOGW(TAG, "RTC read failed @ boot");
-        }
-    } else {
+    if (ds3231_init(&rtc) != ESP_OK) {
         ESP_LOGW(TAG, "RTC init failed");
+        return;
+    }
+    s_rtc_ok = true;
+#if CONFIG_TK_BOOT_I2C_SCAN
+    i2c_scan(ds3231_get_bus());
+#endif
+    ds3231_snapshot_t snap;
+    if (ds3231_read_snapshot(&snap) != ESP_OK) {
+        ESP_LOGW(TAG, "RTC read failed @ boot");
+        return;
     }
+    const struct tm t = snap.time;
+    ESP_LOGI(TAG, "RTC @ boot: %04d-%02d-%02d %02d:%02d:%02d  %.2f C  aging %d",
+             t.tm_year+1900, t.tm_mon+1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec,
+             snap.temp_qc * 0.25, (int)snap.aging);
+    if (snap.osf) ESP_LOGW(TAG, "RTC oscillator stopped (power lost): time not trustworthy");
+    set_system_time_from_tm(&t);
+    s_boot_tm = t;
+    s_boot_tm_ok = true;
+}
 
-    // Load persisted state
-    nvs_load_state();
+static void boot_storage(void) {
+    ESP_ERROR_CHECK(nvs_flash_init());
+    xEventGroupSetBits(boot_events(), BOOT_EV_NVS);
+    policy_load();
+    state_load();
+    s_history_ok = (history_init() == ESP_OK);
+    history_restore();
+}
 
-    // Establish today's key & handle day reset if needed
-    struct tm now_tm = {0};
-    time_t now_epoch;
-    if (s_rtc_ok && ds3231_get_time(&now_tm) == ESP_OK) {
-        uint32_t today = day_key_from_tm(&now_tm);
-        if (s_day_key != today) {
-            s_day_key   = today;
-            s_started   = false;
-            s_remaining = DAILY_TARGET_SEC;
-            ESP_LOGI(TAG, "New day %" PRIu32 " - reset to 9:15", s_day_key);
-            nvs_save_state_immediate();
-        }
-    } else {
-        time(&now_epoch); localtime_r(&now_epoch, &now_tm);
-        s_day_key = day_key_from_tm(&now_tm);
-    }
+static void boot_wifi(void) {
+    boot_wait(BOOT_EV_NVS, portMAX_DELAY);
+    wifi_init_softap();
+#if HTTP_API
+    http_api_config_t hcfg = { .port = HTTP_API_PORT, .task_prio = HTTP_API_PRIO, .max_clients = HTTP_API_CLIENTS };
+    if (http_api_start(&hcfg) != ESP_OK) ESP_LOGW(TAG, "HTTP API unavailable");
+#endif
+}
+
+static const boot_job_t s_boot_jobs[] = {
+    { .name = "rtc",     .fn = boot_rtc,     .done_bit = BOOT_EV_RTC,     .core = 1, .stack = 4096, .prio = 5 },
+    { .name = "storage", .fn = boot_storage, .done_bit = BOOT_EV_STORAGE, .core = 1, .stack = 4096, .prio = 4 },
+    { .name = "wifi",    .fn = boot_wifi,    .done_bit = BOOT_EV_WIFI,    .core = 0, .stack = 4096, .prio = 4 },
+};
+
+// ================ App ================
+void app_main(void) {
+    ESP_ERROR_CHECK(boot_begin());
+
+    // TM1637 first: "boot" on the display while everything else comes up
+    tm1637_init(TM_DIO_PIN, TM_CLK_PIN, TM_BRIGHTNESS);
+    ESP_ERROR_CHECK(tm1637_start_task());
+    tm1637_frame_t boot_frame = { .seg = { 0x7C, 0x5C, 0x5C, 0x78 }, .brightness = -1 };   // b o o t
+    tm1637_post_frame(&boot_frame);
+    boot_mark("display");
+
+    // Hot-path logs and the status line are formatted here, off the tick path
+    ESP_ERROR_CHECK(dlog_start(DLOG_TASK_PRIO, DLOG_PERIOD_MS));
+
+#if CONFIG_TK_POWER_SAVE
+    // DFS + tickless idle; light sleep when the radio lets go (see Kconfig)
+    power_config_t pm = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_TK_PM_MIN_FREQ_MHZ,
+#if CONFIG_TK_PM_LIGHT_SLEEP
+        .light_sleep  = true,
+#endif
+    };
+    (void)power_init(&pm);
+#endif
 
-    // Create deauth timer BEFORE starting AP
+    // IST (UTC+5:30). POSIX sign inverted. Our own time math uses tk_civil; this is for
+    // libc users left (the DS3231 driver reads registers as local time via mktime).
+    setenv("TZ", "IST-5:30", 1);
+    tzset();
+
+    // Readers may poll before the owner's first publish; Wi-Fi events queue until it runs
+    snapshot_init();
+    s_tick_q = xQueueCreate(1, sizeof(tick_msg_t));
+    ESP_ERROR_CHECK(s_tick_q ? ESP_OK : ESP_ERR_NO_MEM);
     {
         esp_timer_create_args_t targs = {
             .callback = deauth_timer_cb,
@@ -328,61 +1142,139 @@ void app_main(void) {
         ESP_ERROR_CHECK(esp_timer_create(&targs, &s_deauth_timer));
     }
 
-    // Bring up SoftAP
-    wifi_init_softap();
+    // RTC, storage and Wi-Fi in parallel
+    for (size_t i = 0; i < sizeof(s_boot_jobs) / sizeof(s_boot_jobs[0]); i++) {
+        ESP_ERROR_CHECK(boot_spawn(&s_boot_jobs[i]));
+    }
+    boot_wait(BOOT_EV_RTC | BOOT_EV_STORAGE, portMAX_DELAY);
+    boot_mark("rtc+storage");
 
-    // TM1637 init
-    tm1637_init(TM_DIO_PIN, TM_CLK_PIN, TM_BRIGHTNESS);
+    // Establish today's key; without the RTC the persisted days stand (no tick comes anyway)
+    struct tm now_tm = {0};
+    uint32_t today = 0;
+    if (s_boot_tm_ok) {
+        now_tm = s_boot_tm;
+        today = tk_day_key_from_tm(&now_tm);
+        // powered off across midnight: close the day that was interrupted
+        for (uint32_t u = 0; u < s_app.users.n; u++) {
+            if (s_app.users.user[u].day_key != today && s_app.users.user[u].started) {
+                history_write(u, HISTORY_F_FINAL);
+                day_log_reset(u);
+            }
+        }
+    } else {
+        time_t now_epoch;
+        time(&now_epoch); tk_civil_from_epoch(now_epoch, TK_CIVIL_IST_OFFSET, &now_tm);
+    }
+
+    // Last touches of the state from this task; the owner takes it over from here.
+    // tk_app rolls stale days over, reopens running sessions and focuses the first
+    // user (lowest index) already checked in today.
+    uint64_t save_state, save_mac;
+    tk_app_start(&s_app, today, tm_local_to_epoch(&now_tm), &save_state, &save_mac);
+    for (uint64_t m = save_state; m; m &= m - 1) {
+        ESP_LOGI(TAG, "User %d: new day %" PRIu32 " - reset to 9:15", __builtin_ctzll(m), today);
+    }
+    state_save_mask(save_state);
+    mac_save_mask(save_mac);
+    for (uint32_t u = 0; u < s_app.users.n; u++) {
+        if (s_app.users.user[u].have_mac) (void)presence_enroll(s_app.users.user[u].mac);
+    }
+    cost_sample(&s_cost_base);
+
+    // First real frame: the focus user's countdown (or the full target) from the loaded state
+    {
+        tk_state_t idle;
+        const tk_state_t *shown = tk_app_shown(s_app.users.user, s_app.users.n, s_app.focus, &s_tk_cfg, &idle);
+        uint8_t rh, rm;
+        tk_core_hhmm(shown, &rh, &rm);
+        tm1637_frame_t frame;
+        tm1637_frame_hhmm(&frame, rh, rm, true);
+        tm1637_post_frame(&frame);
+    }
+    boot_mark("countdown");
 
-    // Main loop — drive display & countdown
-    time_t last_epoch = tm_local_to_epoch(now_tm);
+    // Owner takes over the state; events Wi-Fi queued meanwhile are drained on its first wake
+    ESP_ERROR_CHECK(xTaskCreate(owner_task, "tk_owner", OWNER_TASK_STACK, NULL, OWNER_TASK_PRIO,
+                                &s_owner_task) == pdPASS ? ESP_OK : ESP_ERR_NO_MEM);
+    boot_mark("owner");
+
+    // Tick source: SQW edges if wired, else poll the RTC
+    if (s_rtc_ok && RTC_SQW_PIN != GPIO_NUM_NC) {
+        s_sqw = (ds3231_sqw_start(RTC_SQW_PIN, xTaskGetCurrentTaskHandle()) == ESP_OK);
+        if (s_sqw) s_last_resync = ds3231_sqw_epoch();
+        else ESP_LOGW(TAG, "SQW tick unavailable, polling RTC");
+#if CONFIG_TK_PM_LIGHT_SLEEP
+        if (s_sqw && power_enabled()) (void)ds3231_sqw_set_wakeup(true);
+#endif
+    }
+    if (s_rtc_ok && !s_sqw) {
+        ds3231_clock_config_t ccfg = {
+            .discipline_interval_s = CLOCK_DISCIPLINE_SEC,
+            .max_drift_us          = CLOCK_MAX_DRIFT_US,
+        };
+        s_clock = (ds3231_clock_init(&ccfg) == ESP_OK);
+    }
+    boot_mark("tick source");
+
+    if (!boot_wait(BOOT_EV_WIFI, pdMS_TO_TICKS(5000))) ESP_LOGW(TAG, "Wi-Fi bring-up still running");
+    boot_report();
+
+    // Main loop — tick source for the owner, then display & UART from its snapshot.
+    // Reads land in the spare buffer and swap in only when consistent: a read that keeps
+    // losing to the owner leaves a torn copy, and the last good snapshot is shown instead.
+    static tk_snapshot_t snap_buf[2];
+    tk_snapshot_t *snap  = &snap_buf[0];         // last good (focus -1 until the first read)
+    tk_snapshot_t *spare = &snap_buf[1];
+    snap->focus = -1;
+    uint32_t last_day = s_app.today;
     while (1) {
         struct tm t = {0};
-        if (s_rtc_ok && ds3231_get_time(&t) == ESP_OK) {
-            time_t epoch = mktime(&t);
-
-            // Day boundary check (IST)
-            uint32_t today = day_key_from_tm(&t);
-            if (today != s_day_key) {
-                s_day_key   = today;
-                s_started   = false;
-                s_remaining = DAILY_TARGET_SEC;
-                ESP_LOGI(TAG, "New day %" PRIu32 " - reset to 9:15", s_day_key);
-                nvs_save_state_immediate();
-            }
+        time_t epoch = 0;
+        bool have_time;
+        if (s_sqw)        have_time = sqw_tick(&t, &epoch, last_day);
+        else if (s_clock) have_time = clock_tick(&t, &epoch);
+        else {
+            have_time = s_rtc_ok && ds3231_get_time(&t) == ESP_OK;
+            if (have_time) epoch = tm_local_to_epoch(&t);
+        }
+        if (have_time) {
+            tick_msg_t m = { .epoch = epoch, .today = tk_day_key_from_tm(&t) };
+            last_day = m.today;
+            xQueueOverwrite(s_tick_q, &m);
+            xTaskNotifyGive(s_owner_task);
 
-            // Decrement by elapsed seconds (robust to delays)
-            time_t delta = epoch - last_epoch;
-            if (delta < 0) delta = 0;
-            if (delta > 60) delta = 60;
-            if (s_started && s_remaining > 0) {
-                int32_t dec = (int32_t)delta;
-                if (dec > s_remaining) dec = s_remaining;
-                s_remaining -= dec;
-                if (dec > 0 && (s_remaining % 60 == 0)) {
-                    nvs_save_state();
-                }
+            // The owner outranks this task and normally publishes before we get here;
+            // on the other core it may need a moment
+            bool fresh = false;
+            for (int i = 0; i < 4 && !fresh; i++) {
+                if (i) vTaskDelay(1);
+                if (!snapshot_read(spare)) continue;
+                tk_snapshot_t *tmp = snap; snap = spare; spare = tmp;
+                fresh = (snap->epoch == epoch);
             }
-            last_epoch = epoch;
 
-            // Display remaining on TM1637 (HH:MM, blink colon)
-            int rem = s_remaining; if (rem < 0) rem = 0;
-            int rh = rem / 3600;
-            int rm = (rem % 3600) / 60;
+            // Display the focus user's remaining time (HH:MM, blink colon); nobody yet = full target
+            tk_state_t idle;
+            const tk_state_t *shown = tk_app_shown(snap->user, snap->n, snap->focus, &s_tk_cfg, &idle);
+            uint8_t rh, rm;
+            tk_core_hhmm(shown, &rh, &rm);
             bool colon = (t.tm_sec % 2) == 0;
-            if (rh > 99) rh = 99;
-            tm1637_show_hhmm((uint8_t)rh, (uint8_t)rm, colon);
-
-            // UART single-line
-            char timebuf[64];
-            strftime(timebuf, sizeof(timebuf), "%I:%M:%S %p %d-%m-%Y IST", &t);
-            const char *state = (s_remaining == 0) ? "DONE" : (s_started ? "RUN " : "WAIT");
-            printf("\r\x1b[K%s | Rem %02d:%02d | %s", timebuf, rh, rm, state);
+            tm1637_frame_t frame;
+            tm1637_frame_hhmm(&frame, rh, rm, colon);
+            tm1637_post_frame(&frame);
+
+            // UART single-line (formatted later by the dlog task)
+            static const char *const phase_str[] = { [TK_WAIT] = "WAIT", [TK_RUN] = "RUN ", [TK_DONE] = "DONE", [TK_PAUSE] = "AWAY" };
+            DLOG(DLOG_STATUS, DLOG_EPOCH(epoch), rh, rm, DLOG_STR(phase_str[tk_core_phase(shown)]),
+                 snap->running, snap->n);
         } else {
-            tm1637_show_hhmm(0, 0, false);
-            printf("\r\x1b[KRTC read failed...");
+            tm1637_frame_t frame;
+            tm1637_frame_hhmm(&frame, 0, 0, false);
+            tm1637_post_frame(&frame);
+            DLOG(DLOG_RTC_FAIL);
         }
 
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        if (!s_sqw) vTaskDelay(pdMS_TO_TICKS(1000));
     }
 }
@@ -0,0 +1,55 @@
+#include "power.h"
+#include "sdkconfig.h"
+#include "esp_log.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+
+static const char *TAG = "power";
+
+static bool s_enabled;
+
+esp_err_t power_init(const power_config_t *cfg)
+{
+#if CONFIG_PM_ENABLE
+    if (!cfg) return ESP_ERR_INVALID_ARG;
+    esp_pm_config_t pm = {
+        .max_freq_mhz       = cfg->max_freq_mhz,
+        .min_freq_mhz       = cfg->min_freq_mhz,
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+        .light_sleep_enable = cfg->light_sleep,
+#endif
+    };
+    esp_err_t err = esp_pm_configure(&pm);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_pm_configure failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    s_enabled = true;
+    ESP_LOGI(TAG, "DFS %d..%d MHz, light sleep %s", cfg->min_freq_mhz, cfg->max_freq_mhz,
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+             cfg->light_sleep ? "auto" : "off"
+#else
+             "off (no tickless idle)"
+#endif
+             );
+    return ESP_OK;
+#else
+    (void)cfg;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool power_enabled(void)
+{
+    return s_enabled;
+}
+
+void power_dump(FILE *out)
+{
+#if CONFIG_PM_ENABLE
+    if (s_enabled) esp_pm_dump_locks(out);
+#else
+    (void)out;
+#endif
+}
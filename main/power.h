@@ -0,0 +1,31 @@
+#pragma once
+// Power management: DFS between max/min CPU frequency, FreeRTOS tickless idle and
+// automatic light sleep (CONFIG_PM_ENABLE + CONFIG_FREERTOS_USE_TICKLESS_IDLE).
+// While the SoftAP runs, the Wi-Fi driver holds a lock that keeps the chip out of light
+// sleep, so in that mode the saving comes from DFS and idle clock gating.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int  max_freq_mhz;
+    int  min_freq_mhz;        // ESP32: 10/20/40/80 (XTAL-derived)
+    bool light_sleep;
+} power_config_t;
+
+// ESP_ERR_NOT_SUPPORTED when built without CONFIG_PM_ENABLE
+esp_err_t power_init(const power_config_t *cfg);
+
+bool power_enabled(void);
+
+// PM locks and, with CONFIG_TK_PM_PROFILING, time spent in each power mode
+void power_dump(FILE *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,192 @@
+#include "presence.h"
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_wifi.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "tk_mac.h"
+
+ESP_EVENT_DEFINE_BASE(PRESENCE_EVENT);
+
+static const char *TAG = "presence";
+
+// 802.11 header: frame control (2), duration (2), addr1 (6), addr2 = source (6) ...
+#define FC0_TYPE_MASK     0x0C
+#define FC0_TYPE_MGMT     0x00
+#define FC0_SUBTYPE(b)    (((b) >> 4) & 0x0F)
+#define HDR_ADDR2_OFF     10
+#define HDR_MIN_LEN       24
+
+// Subtypes a station sends while looking for / joining an AP
+#define SUBTYPE_MASK      ((1u << 0x0) | (1u << 0x2) | (1u << 0x4) | (1u << 0xB))   // assoc, reassoc, probe, auth
+
+// Open addressing on the 48-bit MAC; table twice the enrolled capacity keeps probes short
+#define SLOTS             (PRESENCE_MAX_MACS * 2)
+
+typedef struct {
+    uint64_t key;                 // MAC as 48-bit integer, 0 = empty
+    int64_t  last_post_us;
+    int64_t  last_sample_us;
+} slot_t;
+
+static slot_t            s_slots[SLOTS];
+static uint32_t          s_count;
+static portMUX_TYPE      s_mux = portMUX_INITIALIZER_UNLOCKED;
+static presence_config_t s_cfg;
+static presence_stats_t  s_stats;
+static bool              s_running;
+
+static inline uint32_t slot_of(uint64_t k)
+{
+    return tk_mac_hash(k) % SLOTS;
+}
+
+// Slot holding k, or the empty slot where it would go; -1 if absent and full. Caller holds s_mux.
+static int find(uint64_t k)
+{
+    uint32_t i = slot_of(k);
+    for (int n = 0; n < SLOTS; n++, i = (i + 1) % SLOTS) {
+        if (s_slots[i].key == k || s_slots[i].key == 0) return (int)i;
+    }
+    return -1;
+}
+
+static void rx_cb(void *buf, wifi_promiscuous_pkt_type_t type)
+{
+    if (type != WIFI_PKT_MGMT) return;
+    const wifi_promiscuous_pkt_t *pkt = (const wifi_promiscuous_pkt_t *)buf;
+    const uint8_t *p = pkt->payload;
+    s_stats.mgmt_frames++;
+
+    if (pkt->rx_ctrl.sig_len < HDR_MIN_LEN) return;
+    if ((p[0] & FC0_TYPE_MASK) != FC0_TYPE_MGMT) return;
+    uint8_t sub = FC0_SUBTYPE(p[0]);
+    if (!(SUBTYPE_MASK & (1u << sub))) return;
+    if (pkt->rx_ctrl.rssi < s_cfg.rssi_min) return;
+
+    uint64_t k = tk_mac_key(p + HDR_ADDR2_OFF);
+    int64_t now = esp_timer_get_time();
+    bool post = false, sample = false;
+
+    portENTER_CRITICAL(&s_mux);
+    int i = s_count ? find(k) : -1;
+    if (i >= 0 && s_slots[i].key == k) {
+        s_stats.matched++;
+        // Samples are paced separately: a probe burst is one reading, not a dozen
+        if (s_cfg.on_sample && (s_slots[i].last_sample_us == 0 ||
+            now - s_slots[i].last_sample_us >= (int64_t)s_cfg.sample_ms * 1000)) {
+            s_slots[i].last_sample_us = now;
+            s_stats.sampled++;
+            sample = true;
+        }
+        if (s_slots[i].last_post_us == 0 ||
+            now - s_slots[i].last_post_us >= (int64_t)s_cfg.debounce_ms * 1000) {
+            s_slots[i].last_post_us = now;
+            post = true;
+        }
+    }
+    portEXIT_CRITICAL(&s_mux);
+    if (sample) s_cfg.on_sample(p + HDR_ADDR2_OFF, pkt->rx_ctrl.rssi);
+    if (!post) return;
+
+    presence_event_t ev = { .rssi = pkt->rx_ctrl.rssi, .subtype = sub };
+    memcpy(ev.mac, p + HDR_ADDR2_OFF, 6);
+    // Wi-Fi task context: never block here
+    if (esp_event_post(PRESENCE_EVENT, PRESENCE_EVENT_SEEN, &ev, sizeof(ev), 0) == ESP_OK) s_stats.posted++;
+    else s_stats.post_failed++;
+}
+
+esp_err_t presence_start(const presence_config_t *cfg)
+{
+    if (!cfg) return ESP_ERR_INVALID_ARG;
+    s_cfg = *cfg;
+    if (s_running) return ESP_OK;
+
+    wifi_promiscuous_filter_t filt = { .filter_mask = WIFI_PROMIS_FILTER_MASK_MGMT };
+    esp_err_t err = esp_wifi_set_promiscuous_filter(&filt);
+    if (err == ESP_OK) err = esp_wifi_set_promiscuous_rx_cb(rx_cb);
+    if (err == ESP_OK) err = esp_wifi_set_promiscuous(true);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "promiscuous enable failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    s_running = true;
+    ESP_LOGI(TAG, "sniffing mgmt frames (debounce %" PRIu32 " ms, rssi >= %d)",
+             s_cfg.debounce_ms, (int)s_cfg.rssi_min);
+    return ESP_OK;
+}
+
+esp_err_t presence_stop(void)
+{
+    if (!s_running) return ESP_OK;
+    s_running = false;
+    return esp_wifi_set_promiscuous(false);
+}
+
+esp_err_t presence_enroll(const uint8_t mac[6])
+{
+    uint64_t k = tk_mac_key(mac);
+    esp_err_t err = ESP_OK;
+    portENTER_CRITICAL(&s_mux);
+    int i = find(k);
+    if (i < 0 || (s_slots[i].key == 0 && s_count >= PRESENCE_MAX_MACS)) {
+        err = ESP_ERR_NO_MEM;
+    } else if (s_slots[i].key == 0) {
+        s_slots[i].key = k;
+        s_slots[i].last_post_us = 0;
+        s_slots[i].last_sample_us = 0;
+        s_count++;
+    }
+    portEXIT_CRITICAL(&s_mux);
+    return err;
+}
+
+void presence_forget(const uint8_t mac[6])
+{
+    uint64_t k = tk_mac_key(mac);
+    portENTER_CRITICAL(&s_mux);
+    int i = find(k);
+    if (i >= 0 && s_slots[i].key == k) {
+        // Backward-shift delete keeps every remaining key reachable from its home slot
+        uint32_t hole = (uint32_t)i, j = hole;
+        for (;;) {
+            j = (j + 1) % SLOTS;
+            if (s_slots[j].key == 0) break;
+            uint32_t home = slot_of(s_slots[j].key);
+            // move j into the hole unless its home lies cyclically in (hole, j]
+            bool stays = (hole <= j) ? (home > hole && home <= j) : (home > hole || home <= j);
+            if (!stays) { s_slots[hole] = s_slots[j]; hole = j; }
+        }
+        s_slots[hole].key = 0;
+        s_slots[hole].last_post_us = 0;
+        s_slots[hole].last_sample_us = 0;
+        s_count--;
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+bool presence_is_enrolled(const uint8_t mac[6])
+{
+    uint64_t k = tk_mac_key(mac);
+    portENTER_CRITICAL(&s_mux);
+    int i = s_count ? find(k) : -1;
+    bool hit = (i >= 0 && s_slots[i].key == k);
+    portEXIT_CRITICAL(&s_mux);
+    return hit;
+}
+
+void presence_clear(void)
+{
+    portENTER_CRITICAL(&s_mux);
+    memset(s_slots, 0, sizeof(s_slots));
+    s_count = 0;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void presence_get_stats(presence_stats_t *out)
+{
+    portENTER_CRITICAL(&s_mux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_mux);
+}
@@ -0,0 +1,63 @@
+#pragma once
+// Presence detection without association: sniff management frames in promiscuous
+// mode (probe/auth/assoc requests) and report enrolled source MACs.
+// Only works when the phone transmits its enrolled MAC; phones that randomise
+// the MAC in undirected probes are seen on their directed probes/auth instead.
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+ESP_EVENT_DECLARE_BASE(PRESENCE_EVENT);
+
+enum {
+    PRESENCE_EVENT_SEEN,          // data: presence_event_t
+};
+
+typedef struct {
+    uint8_t mac[6];
+    int8_t  rssi;
+    uint8_t subtype;              // 802.11 management subtype (0x4 = probe request)
+} presence_event_t;
+
+// Per-frame signal sample for an enrolled MAC, ahead of the event debounce (e.g. rssi_feed).
+// Runs in the Wi-Fi task: must not block.
+typedef void (*presence_sample_cb_t)(const uint8_t mac[6], int8_t rssi);
+
+typedef struct {
+    uint32_t debounce_ms;         // min. spacing of events for one MAC
+    int8_t   rssi_min;            // ignore weaker frames (dBm), e.g. -80
+    presence_sample_cb_t on_sample;   // optional
+    uint32_t sample_ms;           // min. spacing of on_sample calls for one MAC
+} presence_config_t;
+
+typedef struct {
+    uint32_t mgmt_frames;         // frames delivered by the MGMT filter
+    uint32_t matched;             // frames from an enrolled MAC above rssi_min
+    uint32_t sampled;             // on_sample calls (before debounce)
+    uint32_t posted;              // events posted (after debounce)
+    uint32_t post_failed;         // event loop queue full
+} presence_stats_t;
+
+#define PRESENCE_MAX_MACS 64
+
+// Enable promiscuous RX (MGMT filter only) on the running Wi-Fi interface
+esp_err_t presence_start(const presence_config_t *cfg);
+esp_err_t presence_stop(void);
+
+// Enrolled set (O(1) lookup from the RX callback); ESP_ERR_NO_MEM when full
+esp_err_t presence_enroll(const uint8_t mac[6]);
+void      presence_forget(const uint8_t mac[6]);
+void      presence_clear(void);
+// Any task; takes the same spinlock as the RX callback
+bool      presence_is_enrolled(const uint8_t mac[6]);
+
+void presence_get_stats(presence_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,196 @@
+#include "rssi.h"
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_wifi.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "tk_mac.h"
+
+ESP_EVENT_DEFINE_BASE(RSSI_EVENT);
+
+#define RSSI_TASK_STACK 3072
+
+static const char *TAG = "rssi";
+
+typedef struct {
+    uint64_t  key;                // MAC as 48-bit integer, 0 = free
+    tk_rssi_t filt;
+    int8_t    last_dbm;
+    uint16_t  transitions;
+    int64_t   last_us;
+} sta_t;
+
+// The table is tiny, so a linear scan bounds the cost of a sample at RSSI_MAX_STA compares
+static sta_t         s_sta[RSSI_MAX_STA];
+static portMUX_TYPE  s_mux = portMUX_INITIALIZER_UNLOCKED;
+static rssi_config_t s_cfg;
+static rssi_stats_t  s_stats;
+static TaskHandle_t  s_task;
+
+// Entry for k, else a free one, else the one sampled longest ago (reset). Caller holds s_mux.
+static sta_t *slot(uint64_t k)
+{
+    sta_t *free_e = NULL, *oldest = &s_sta[0];
+    for (int i = 0; i < RSSI_MAX_STA; i++) {
+        sta_t *e = &s_sta[i];
+        if (e->key == k) return e;
+        if (e->key == 0) { if (!free_e) free_e = e; continue; }
+        if (e->last_us < oldest->last_us) oldest = e;
+    }
+    sta_t *e = free_e;
+    if (!e) {
+        e = oldest;
+        s_stats.evicted++;
+    }
+    memset(e, 0, sizeof(*e));
+    e->key = k;
+    tk_rssi_reset(&e->filt);
+    return e;
+}
+
+static void post(int32_t id, uint64_t k, int8_t dbm)
+{
+    rssi_event_t ev = { .dbm = dbm };
+    for (int b = 0; b < 6; b++) ev.mac[b] = (uint8_t)(k >> (40 - 8 * b));
+    if (esp_event_post(RSSI_EVENT, id, &ev, sizeof(ev), 0) != ESP_OK) {
+        portENTER_CRITICAL(&s_mux);
+        s_stats.post_failed++;
+        portEXIT_CRITICAL(&s_mux);
+    }
+}
+
+static void sample(const uint8_t mac[6], int8_t dbm, int64_t now_us)
+{
+    uint64_t k = tk_mac_key(mac);
+    if (k == 0) return;
+
+    portENTER_CRITICAL(&s_mux);
+    sta_t *e = slot(k);
+    int tr = tk_rssi_update(&e->filt, &s_cfg.filter, dbm, (uint32_t)(now_us / 1000));
+    e->last_dbm = dbm;
+    e->last_us  = now_us;
+    if (tr) {
+        e->transitions++;
+        if (tr == TK_RSSI_NEAR) s_stats.near++; else s_stats.far++;
+    }
+    int8_t smoothed = (int8_t)tk_rssi_dbm(&e->filt);
+    portEXIT_CRITICAL(&s_mux);
+    if (tr) post(tr == TK_RSSI_NEAR ? RSSI_EVENT_NEAR : RSSI_EVENT_FAR, k, smoothed);
+}
+
+// Drop stations not sampled within stale_ms (a returning phone starts a fresh series);
+// one that was near is reported far, so near always ends in a transition
+static void expire(int64_t now_us)
+{
+    uint32_t now_ms = (uint32_t)(now_us / 1000);
+    uint64_t gone[RSSI_MAX_STA];
+    int8_t   dbm[RSSI_MAX_STA];
+    int      n = 0;
+    portENTER_CRITICAL(&s_mux);
+    for (int i = 0; i < RSSI_MAX_STA; i++) {
+        sta_t *e = &s_sta[i];
+        if (!e->key) continue;
+        int8_t smoothed = (int8_t)tk_rssi_dbm(&e->filt);
+        int tr = tk_rssi_expire(&e->filt, now_ms, s_cfg.stale_ms);
+        if (!tr) continue;
+        if (tr == TK_RSSI_FAR) {
+            gone[n] = e->key;
+            dbm[n++] = smoothed;
+            s_stats.far++;
+        }
+        e->key = 0;
+        s_stats.evicted++;
+    }
+    portEXIT_CRITICAL(&s_mux);
+    for (int i = 0; i < n; i++) post(RSSI_EVENT_FAR, gone[i], dbm[i]);
+}
+
+static void sampler_task(void *arg)
+{
+    static wifi_sta_list_t list;                  // ~10 stations; keep it off the stack
+    TickType_t wake = xTaskGetTickCount();
+    for (;;) {
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(s_cfg.period_ms));
+        int64_t t0 = esp_timer_get_time();
+        if (esp_wifi_ap_get_sta_list(&list) == ESP_OK) {
+            for (int i = 0; i < list.num; i++) sample(list.sta[i].mac, list.sta[i].rssi, t0);
+        }
+        expire(t0);
+        int64_t dt = esp_timer_get_time() - t0;
+
+        portENTER_CRITICAL(&s_mux);
+        s_stats.periods++;
+        s_stats.listed += (uint32_t)list.num;
+        lat_hist_add(&s_stats.cost, dt);
+        portEXIT_CRITICAL(&s_mux);
+    }
+}
+
+esp_err_t rssi_start(const rssi_config_t *cfg)
+{
+    if (!cfg || !cfg->period_ms || cfg->filter.shift > 7 || cfg->filter.leave_dbm >= cfg->filter.enter_dbm) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task) return ESP_OK;
+    s_cfg = *cfg;
+    if (xTaskCreatePinnedToCore(sampler_task, "rssi", RSSI_TASK_STACK, NULL, cfg->task_prio, &s_task,
+                                cfg->core) != pdPASS) {
+        s_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "sampling every %" PRIu32 " ms: near >= %d dBm, far < %d dBm, alpha 1/%u",
+             cfg->period_ms, (int)cfg->filter.enter_dbm, (int)cfg->filter.leave_dbm, 1u << cfg->filter.shift);
+    return ESP_OK;
+}
+
+void rssi_feed(const uint8_t mac[6], int8_t dbm)
+{
+    if (!s_task) return;
+    sample(mac, dbm, esp_timer_get_time());
+    portENTER_CRITICAL(&s_mux);
+    s_stats.fed++;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+bool rssi_is_near(const uint8_t mac[6])
+{
+    uint64_t k = tk_mac_key(mac);
+    bool near = false;
+    portENTER_CRITICAL(&s_mux);
+    for (int i = 0; i < RSSI_MAX_STA; i++) {
+        if (s_sta[i].key == k) { near = s_sta[i].filt.near; break; }
+    }
+    portEXIT_CRITICAL(&s_mux);
+    return near;
+}
+
+uint32_t rssi_get_table(rssi_sta_t *out, uint32_t max)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t n = 0;
+    portENTER_CRITICAL(&s_mux);
+    for (int i = 0; i < RSSI_MAX_STA && n < max; i++) {
+        const sta_t *e = &s_sta[i];
+        if (!e->key) continue;
+        rssi_sta_t *o = &out[n++];
+        for (int b = 0; b < 6; b++) o->mac[b] = (uint8_t)(e->key >> (40 - 8 * b));
+        o->dbm         = (int8_t)tk_rssi_dbm(&e->filt);
+        o->last_dbm    = e->last_dbm;
+        o->near        = e->filt.near;
+        o->samples     = e->filt.samples;
+        o->transitions = e->transitions;
+        o->age_ms      = (uint32_t)((now - e->last_us) / 1000);
+    }
+    portEXIT_CRITICAL(&s_mux);
+    return n;
+}
+
+void rssi_get_stats(rssi_stats_t *out)
+{
+    if (!out) return;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_mux);
+}
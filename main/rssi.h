@@ -0,0 +1,80 @@
+#pragma once
+// Per-station RSSI sampler. A low-priority task reads the SoftAP station list every
+// period and runs each station's signal through tk_rssi (fixed-point EWMA with
+// hysteresis); sniffed frames can add samples via rssi_feed(). Near/far transitions
+// are posted as RSSI_EVENT on the default loop, so a check-in can wait until the
+// phone is in the office instead of passing by in the corridor. A near station that
+// stops producing samples is reported far when it goes stale.
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_event.h"
+#include "tk_rssi.h"
+#include "event_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+ESP_EVENT_DECLARE_BASE(RSSI_EVENT);
+
+enum {
+    RSSI_EVENT_NEAR,              // data: rssi_event_t
+    RSSI_EVENT_FAR,
+};
+
+typedef struct {
+    uint8_t mac[6];
+    int8_t  dbm;                  // smoothed at the transition
+} rssi_event_t;
+
+typedef struct {
+    tk_rssi_config_t filter;
+    uint32_t period_ms;           // station list poll interval
+    uint32_t stale_ms;            // forget a station with no sample for this long
+    uint8_t  task_prio;
+    uint8_t  core;
+} rssi_config_t;
+
+// Stations tracked at once; a full table evicts the one sampled longest ago
+#define RSSI_MAX_STA 16
+
+typedef struct {
+    uint8_t  mac[6];
+    int8_t   dbm;                 // smoothed
+    int8_t   last_dbm;            // newest raw sample
+    bool     near;
+    uint16_t samples;
+    uint16_t transitions;
+    uint32_t age_ms;              // since the newest sample
+} rssi_sta_t;
+
+typedef struct {
+    uint32_t   periods;           // sampler passes
+    uint32_t   listed;            // samples from the station list
+    uint32_t   fed;               // samples from rssi_feed()
+    uint32_t   near;              // transitions to near
+    uint32_t   far;               // transitions to far
+    uint32_t   evicted;           // stale, or displaced from a full table
+    uint32_t   post_failed;       // event loop queue full
+    lat_hist_t cost;              // one sampler pass (list read + filters)
+} rssi_stats_t;
+
+// Start the sampler task (Wi-Fi must be up)
+esp_err_t rssi_start(const rssi_config_t *cfg);
+
+// Add a sample from another source (task context, never blocks; e.g. presence's
+// on_sample hook, once per second per sniffed MAC)
+void rssi_feed(const uint8_t mac[6], int8_t dbm);
+
+// Current decision for mac (false if unknown or too few samples)
+bool rssi_is_near(const uint8_t mac[6]);
+
+// Copy of the tracked stations; returns how many were written
+uint32_t rssi_get_table(rssi_sta_t *out, uint32_t max);
+
+void rssi_get_stats(rssi_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,28 @@
+#include "snapshot.h"
+#include "tk_seqlock.h"
+
+#define READ_TRIES 8                  // a reader preempting the writer must not spin on it
+
+static _Atomic uint32_t s_words[TK_SEQLOCK_WORDS(sizeof(tk_snapshot_t))];
+static tk_seqlock_t     s_lock;
+
+void snapshot_init(void)
+{
+    tk_seqlock_init(&s_lock, s_words, sizeof(tk_snapshot_t));
+}
+
+void snapshot_publish(const tk_snapshot_t *s)
+{
+    tk_seqlock_write(&s_lock, s);
+}
+
+bool snapshot_read(tk_snapshot_t *out)
+{
+    if (tk_seqlock_version(&s_lock) == 0) return false;
+    return tk_seqlock_read(&s_lock, out, READ_TRIES);
+}
+
+uint32_t snapshot_version(void)
+{
+    return tk_seqlock_version(&s_lock);
+}
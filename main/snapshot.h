@@ -0,0 +1,36 @@
+#pragma once
+// Published timekeeper state. The owner task (sole writer of the countdown/user state)
+// publishes after every change; any task reads a consistent copy without a lock.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tk_users.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t   today;                 // yyyymmdd of the last tick
+    int64_t    epoch;                 // last tick (local epoch seconds)
+    int32_t    focus;                 // user on the display, -1 = none
+    uint32_t   n;                     // enrolled users
+    uint32_t   running;               // users in TK_RUN
+    tk_state_t user[TK_USERS_MAX];    // [0, n) valid
+} tk_snapshot_t;
+
+void snapshot_init(void);
+
+// Owner task only
+void snapshot_publish(const tk_snapshot_t *s);
+
+// Latest consistent copy; false if none published yet (or the writer kept winning),
+// in which case *out may be torn and must not be used
+bool snapshot_read(tk_snapshot_t *out);
+
+// Bumps on every publish (cheap change detection for caches)
+uint32_t snapshot_version(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,49 +1,167 @@
 #include "tm1637.h"
+#include <string.h>
+#include "sdkconfig.h"
 #include "driver/gpio.h"
 #include "esp_rom_sys.h"
+#include "esp_bit_defs.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "tm1637_wave.h"
+#include "tm1637_rmt.h"
 
 static gpio_num_t g_dio, g_clk;
 
+// Shadow of what the chip currently holds; lets show4() send only changed bytes
+static uint8_t        s_shadow[4];
+static bool           s_shadow_valid = false;
+static volatile bool  s_nack_seen;              // set by tm1637_report_done(), maybe from the RMT ISR
+static int            s_brightness   = -1;
+static tm1637_stats_t s_stats;
+
+static tm1637_done_cb_t s_done_cb;
+static void            *s_done_ctx;
+
+// Display task: depth-1 mailbox, newest frame wins
+#define DISP_DONE_BIT  BIT0
+
+typedef struct {
+    tm1637_frame_t frame;
+    uint32_t       seq;
+} disp_msg_t;
+
+static SemaphoreHandle_t   s_lock;              // shadow + bus, shared by task and direct callers
+static QueueHandle_t       s_mailbox;
+static EventGroupHandle_t  s_events;
+static volatile uint32_t   s_post_seq;
+static volatile uint32_t   s_done_seq;
+static portMUX_TYPE        s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static tm1637_task_stats_t s_task_stats;
+
+static inline void lock(void)   { if (s_lock) xSemaphoreTake(s_lock, portMAX_DELAY); }
+static inline void unlock(void) { if (s_lock) xSemaphoreGive(s_lock); }
+
+#if !CONFIG_TM1637_BACKEND_RMT
 static inline void dly_us(int us) { esp_rom_delay_us(us); }
 static inline void wr(gpio_num_t p, int v) { gpio_set_level(p, v); }
 static inline void as_out(gpio_num_t p) { gpio_set_direction(p, GPIO_MODE_OUTPUT); }
 static inline void as_in(gpio_num_t p)  { gpio_set_direction(p, GPIO_MODE_INPUT); gpio_set_pull_mode(p, GPIO_PULLUP_ONLY); }
 
-// TM1637 bus primitives
-static void start(void) { wr(g_dio,1); wr(g_clk,1); dly_us(5); wr(g_dio,0); dly_us(5); wr(g_clk,0); dly_us(5); }
-static void stop(void)  { wr(g_clk,0); dly_us(5); wr(g_dio,0); dly_us(5); wr(g_clk,1); dly_us(5); wr(g_dio,1); dly_us(5); }
+// TM1637 bus primitives (timing mirrored by tm1637_wave.c)
+static void start(void) {
+    wr(g_dio,1); wr(g_clk,1); dly_us(TM1637_T_START_US);
+    wr(g_dio,0); dly_us(TM1637_T_START_US);
+    wr(g_clk,0); dly_us(TM1637_T_START_US);
+}
+static void stop(void) {
+    wr(g_clk,0); dly_us(TM1637_T_START_US);
+    wr(g_dio,0); dly_us(TM1637_T_START_US);
+    wr(g_clk,1); dly_us(TM1637_T_START_US);
+    wr(g_dio,1); dly_us(TM1637_T_START_US);
+}
 
 static int write_byte(uint8_t b) {
     for (int i = 0; i < 8; i++) {
-        wr(g_clk, 0); dly_us(3);
-        wr(g_dio, (b & 0x01)); dly_us(3);
-        wr(g_clk, 1); dly_us(3);
+        wr(g_clk, 0); dly_us(TM1637_T_BIT_US);
+        wr(g_dio, (b & 0x01)); dly_us(TM1637_T_BIT_US);
+        wr(g_clk, 1); dly_us(TM1637_T_BIT_US);
         b >>= 1;
     }
-    wr(g_clk, 0); dly_us(2);
-    as_in(g_dio); dly_us(2);
-    wr(g_clk, 1); dly_us(3);
+    wr(g_clk, 0); dly_us(TM1637_T_ACK_US);
+    as_in(g_dio); dly_us(TM1637_T_ACK_US);
+    wr(g_clk, 1); dly_us(TM1637_T_BIT_US);
     int ack = gpio_get_level(g_dio);   // 0 = ACK
-    wr(g_clk, 0); dly_us(2);
+    wr(g_clk, 0); dly_us(TM1637_T_ACK_US);
     as_out(g_dio);
     return ack;
 }
 
+static void bus_send(const tm1637_bus_frame_t *f) {
+    uint32_t nack = 0;
+    int n = 0;
+    for (int x = 0; x < f->n_xfers; x++) {
+        start();
+        for (int i = 0; i < f->len[x]; i++, n++) {
+            if (write_byte(f->data[x][i])) nack |= (1u << n);
+        }
+        stop();
+    }
+    tm1637_report_done(nack);
+}
+#else
+static void bus_send(const tm1637_bus_frame_t *f) {
+    (void)tm1637_rmt_send(f);
+}
+#endif
+
+void tm1637_report_done(uint32_t nack_mask)
+{
+    if (nack_mask) {
+        s_stats.nack_frames++;
+        s_nack_seen = true;
+    }
+    if (s_done_cb) s_done_cb(nack_mask, s_done_ctx);
+}
+
+static void send_frame(const tm1637_bus_frame_t *f) {
+    for (int x = 0; x < f->n_xfers; x++) s_stats.bytes_sent += f->len[x];
+    bus_send(f);
+}
+
 static const uint8_t DIGIT[10] = {
     0x3F,0x06,0x5B,0x4F,0x66,0x6D,0x7D,0x07,0x7F,0x6F
 };
 
 static void show4(uint8_t s0, uint8_t s1, uint8_t s2, uint8_t s3) {
-    start(); write_byte(0x40); stop();          // data cmd: auto-increment
-    start(); write_byte(0xC0);                  // addr 0
-    write_byte(s0); write_byte(s1); write_byte(s2); write_byte(s3);
-    stop();
+    const uint8_t next[4] = { s0, s1, s2, s3 };
+
+    // A NACKed byte may not have landed: what the chip holds is unknown until a full write.
+    // The RMT back end reports a frame while the next one is queued, so this may come late.
+    if (s_nack_seen) {
+        s_nack_seen    = false;
+        s_shadow_valid = false;
+    }
+
+    uint8_t dirty = 0;
+    for (int i = 0; i < 4; i++) {
+        if (!s_shadow_valid || next[i] != s_shadow[i]) dirty |= (uint8_t)(1u << i);
+    }
+    if (!dirty) {
+        s_stats.frames_skipped++;
+        return;
+    }
+
+    tm1637_bus_frame_t f = { .n_xfers = 2 };
+    if ((dirty & (dirty - 1)) == 0) {
+        // single digit changed (typically just the colon): fixed-address write
+        int i = __builtin_ctz(dirty);
+        f.len[0] = 1; f.data[0][0] = 0x44;      // data cmd: fixed address
+        f.len[1] = 2; f.data[1][0] = 0xC0 | i; f.data[1][1] = next[i];
+    } else {
+        // several digits: auto-increment over the dirty span only
+        int first = __builtin_ctz(dirty);
+        int last  = 31 - __builtin_clz(dirty);
+        f.len[0] = 1; f.data[0][0] = 0x40;      // data cmd: auto-increment
+        f.len[1] = 1; f.data[1][0] = 0xC0 | first;
+        for (int i = first; i <= last; i++) f.data[1][f.len[1]++] = next[i];
+    }
+    send_frame(&f);
+
+    memcpy(s_shadow, next, sizeof(s_shadow));
+    s_shadow_valid = !s_nack_seen;              // bit-bang reports this frame's ACKs synchronously
+    s_stats.frames_sent++;
 }
 
 void tm1637_init(gpio_num_t dio, gpio_num_t clk, int brightness_0_to_7)
 {
     g_dio = dio; g_clk = clk;
 
+#if CONFIG_TM1637_BACKEND_RMT
+    if (tm1637_rmt_init(g_dio, g_clk) != ESP_OK) return;
+#else
     gpio_config_t io = {
         .pin_bit_mask = (1ULL << g_dio) | (1ULL << g_clk),
         .mode         = GPIO_MODE_OUTPUT,
@@ -55,20 +173,152 @@ void tm1637_init(gpio_num_t dio, gpio_num_t clk, int brightness_0_to_7)
 
     wr(g_dio, 1);
     wr(g_clk, 1);
+#endif
+
+    if (!s_lock) s_lock = xSemaphoreCreateMutex();
+
+    // chip state is unknown after power-up: force full writes
+    s_shadow_valid = false;
+    s_brightness   = -1;
 
     // display on + brightness (0..7)
-    start(); write_byte(0x88 | (brightness_0_to_7 & 0x07)); stop();
+    tm1637_set_brightness(brightness_0_to_7);
 
     // clear display
+    lock();
     show4(0x00,0x00,0x00,0x00);
+    unlock();
+}
+
+static void set_brightness(int brightness_0_to_7)
+{
+    int b = brightness_0_to_7 & 0x07;
+    if (b == s_brightness) return;
+    tm1637_bus_frame_t f = { .n_xfers = 1, .len = { 1 }, .data = { { 0x88 | b } } };
+    send_frame(&f);
+    s_brightness = s_nack_seen ? -1 : b;        // unACKed: resend on the next request
+}
+
+void tm1637_set_brightness(int brightness_0_to_7)
+{
+    lock();
+    set_brightness(brightness_0_to_7);
+    unlock();
+}
+
+void tm1637_frame_hhmm(tm1637_frame_t *f, uint8_t hh, uint8_t mm, bool colon)
+{
+    f->seg[0] = (hh >= 10) ? DIGIT[hh / 10] : 0x00;
+    f->seg[1] = DIGIT[hh % 10];
+    f->seg[2] = DIGIT[mm / 10];
+    f->seg[3] = DIGIT[mm % 10];
+    if (colon) f->seg[1] |= 0x80;          // colon bit on digit1
+    f->brightness = -1;
 }
 
 void tm1637_show_hhmm(uint8_t hh, uint8_t mm, bool colon)
 {
-    uint8_t s0 = (hh >= 10) ? DIGIT[hh / 10] : 0x00;
-    uint8_t s1 = DIGIT[hh % 10];
-    uint8_t s2 = DIGIT[mm / 10];
-    uint8_t s3 = DIGIT[mm % 10];
-    if (colon) s1 |= 0x80;                 // colon bit on digit1
-    show4(s0, s1, s2, s3);
+    tm1637_frame_t f;
+    tm1637_frame_hhmm(&f, hh, mm, colon);
+    lock();
+    show4(f.seg[0], f.seg[1], f.seg[2], f.seg[3]);
+    unlock();
+}
+
+// ================ Display task ================
+static void latency_add(tm1637_latency_t *l, int64_t us)
+{
+    portENTER_CRITICAL(&s_stats_mux);
+    l->count++;
+    l->total_us += (uint64_t)us;
+    if ((uint32_t)us > l->max_us) l->max_us = (uint32_t)us;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+static void disp_task(void *arg)
+{
+    uint32_t last_seq = 0;
+    disp_msg_t m;
+    for (;;) {
+        if (xQueueReceive(s_mailbox, &m, portMAX_DELAY) != pdTRUE) continue;
+
+        lock();
+        if (m.frame.brightness >= 0) set_brightness(m.frame.brightness);
+        show4(m.frame.seg[0], m.frame.seg[1], m.frame.seg[2], m.frame.seg[3]);
+        unlock();
+
+        portENTER_CRITICAL(&s_stats_mux);
+        s_task_stats.written++;
+        s_task_stats.coalesced += m.seq - last_seq - 1;
+        portEXIT_CRITICAL(&s_stats_mux);
+        last_seq   = m.seq;
+        s_done_seq = m.seq;
+        xEventGroupSetBits(s_events, DISP_DONE_BIT);
+    }
+}
+
+esp_err_t tm1637_start_task(void)
+{
+    if (s_mailbox) return ESP_OK;
+    s_mailbox = xQueueCreate(1, sizeof(disp_msg_t));
+    s_events  = xEventGroupCreate();
+    if (!s_mailbox || !s_events) return ESP_ERR_NO_MEM;
+
+    BaseType_t ok = xTaskCreatePinnedToCore(disp_task, "tm1637", 2048, NULL,
+                                            CONFIG_TM1637_TASK_PRIORITY, NULL,
+                                            CONFIG_TM1637_TASK_CORE);
+    return (ok == pdPASS) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t tm1637_post_frame(const tm1637_frame_t *f)
+{
+    if (!f) return ESP_ERR_INVALID_ARG;
+    if (!s_mailbox) return ESP_ERR_INVALID_STATE;
+
+    int64_t t0 = esp_timer_get_time();
+    disp_msg_t m = { .frame = *f };
+    portENTER_CRITICAL(&s_stats_mux);
+    m.seq = ++s_post_seq;
+    s_task_stats.posted++;
+    portEXIT_CRITICAL(&s_stats_mux);
+    xQueueOverwrite(s_mailbox, &m);
+    latency_add(&s_task_stats.post, esp_timer_get_time() - t0);
+    return ESP_OK;
+}
+
+esp_err_t tm1637_flush(TickType_t timeout)
+{
+    if (!s_mailbox) return ESP_ERR_INVALID_STATE;
+
+    int64_t    t0     = esp_timer_get_time();
+    uint32_t   target = s_post_seq;
+    TickType_t start  = xTaskGetTickCount();
+    esp_err_t  err    = ESP_OK;
+
+    while ((int32_t)(s_done_seq - target) < 0) {
+        TickType_t waited = xTaskGetTickCount() - start;
+        if (waited >= timeout) { err = ESP_ERR_TIMEOUT; break; }
+        xEventGroupWaitBits(s_events, DISP_DONE_BIT, pdTRUE, pdFALSE, timeout - waited);
+    }
+    latency_add(&s_task_stats.flush, esp_timer_get_time() - t0);
+    return err;
+}
+
+void tm1637_get_task_stats(tm1637_task_stats_t *out)
+{
+    if (!out) return;
+    portENTER_CRITICAL(&s_stats_mux);
+    *out = s_task_stats;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+void tm1637_set_done_cb(tm1637_done_cb_t cb, void *ctx)
+{
+    s_done_cb  = cb;
+    s_done_ctx = ctx;
+}
+
+void tm1637_get_stats(tm1637_stats_t *out)
+{
+    if (out) *out = s_stats;
 }
@@ -2,17 +2,73 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "driver/gpio.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef struct {
+    uint32_t frames_sent;      // show calls that put at least one byte on the wire
+    uint32_t frames_skipped;   // show calls identical to what the chip already holds
+    uint32_t bytes_sent;       // bytes clocked out, commands included
+    uint32_t nack_frames;      // frames where at least one byte was not ACKed
+} tm1637_stats_t;
+
+// Full display state for the async path
+typedef struct {
+    uint8_t seg[4];            // raw segments for digits 0..3 (bit 7 of seg[1] = colon)
+    int8_t  brightness;        // 0..7, or -1 to leave unchanged
+} tm1637_frame_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+} tm1637_latency_t;
+
+typedef struct {
+    uint32_t         posted;      // tm1637_post_frame() calls
+    uint32_t         written;     // frames the display task applied
+    uint32_t         coalesced;   // frames overwritten before the task got to them
+    tm1637_latency_t post;        // caller-side cost of tm1637_post_frame()
+    tm1637_latency_t flush;       // caller-side wait in tm1637_flush()
+} tm1637_task_stats_t;
+
+// Frame completion: bit i of nack_mask set = i-th byte of the frame was not ACKed.
+// Bit-bang back end: called from the caller's task. RMT back end: called from ISR context.
+typedef void (*tm1637_done_cb_t)(uint32_t nack_mask, void *ctx);
+
 // Initialize display on given pins; brightness 0..7 (also turns display ON)
 void tm1637_init(gpio_num_t dio, gpio_num_t clk, int brightness_0_to_7);
 
 // Show HH:MM with optional blinking colon
 void tm1637_show_hhmm(uint8_t hh, uint8_t mm, bool colon);
 
+// Fill a frame with HH:MM (same rendering as tm1637_show_hhmm)
+void tm1637_frame_hhmm(tm1637_frame_t *f, uint8_t hh, uint8_t mm, bool colon);
+
+// Start the display task (core/priority from Kconfig); call after tm1637_init
+esp_err_t tm1637_start_task(void);
+
+// Hand a frame to the display task and return at once; a newer post replaces an unsent one
+esp_err_t tm1637_post_frame(const tm1637_frame_t *f);
+
+// Wait until everything posted so far is on the display
+esp_err_t tm1637_flush(TickType_t timeout);
+
+void tm1637_get_task_stats(tm1637_task_stats_t *out);
+
+// Change brightness 0..7 (no bus traffic if unchanged)
+void tm1637_set_brightness(int brightness_0_to_7);
+
+// Register a frame completion callback (NULL to remove)
+void tm1637_set_done_cb(tm1637_done_cb_t cb, void *ctx);
+
+// Snapshot of the frame/byte counters
+void tm1637_get_stats(tm1637_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,148 @@
+#include "sdkconfig.h"
+
+#if CONFIG_TM1637_BACKEND_RMT
+
+#include "tm1637_rmt.h"
+#include <string.h>
+#include "driver/rmt_tx.h"
+#include "driver/rmt_rx.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+
+#define RMT_RES_HZ          1000000           // 1 tick = 1 µs, same unit as tm1637_wave
+#define RMT_MEM_SYMBOLS     64
+#define RMT_RX_SYMBOLS      64
+#define RMT_FRAME_WAIT_MS   10                // a full frame is ~0.7 ms on the wire
+
+static const char *TAG = "tm1637_rmt";
+
+static rmt_channel_handle_t      s_clk_chan, s_dio_chan, s_rx_chan;
+static rmt_encoder_handle_t      s_clk_enc, s_dio_enc;
+static rmt_sync_manager_handle_t s_sync;
+static SemaphoreHandle_t         s_idle;      // given when the previous frame's capture is done
+
+// Live until the RX-done ISR has run for the frame they describe
+static tm1637_wave_t     s_wave;
+static rmt_symbol_word_t s_clk_sym[TM1637_WAVE_MAX_RUNS / 2 + 1];
+static rmt_symbol_word_t s_dio_sym[TM1637_WAVE_MAX_RUNS / 2 + 1];
+static rmt_symbol_word_t s_rx_sym[RMT_RX_SYMBOLS];
+static tm1637_wave_run_t s_rx_runs[RMT_RX_SYMBOLS * 2];
+
+// Two runs per RMT symbol; an odd tail is split so no half carries a zero duration
+static size_t pack(const tm1637_wave_run_t *runs, size_t n, rmt_symbol_word_t *sym)
+{
+    size_t k = 0;
+    for (size_t i = 0; i < n; i += 2, k++) {
+        tm1637_wave_run_t a = runs[i], b;
+        if (i + 1 < n) {
+            b = runs[i + 1];
+        } else {
+            b.level  = a.level;
+            b.dur_us = a.dur_us / 2;
+            a.dur_us = a.dur_us - b.dur_us;
+        }
+        sym[k] = (rmt_symbol_word_t){ .level0 = a.level, .duration0 = a.dur_us,
+                                      .level1 = b.level, .duration1 = b.dur_us };
+    }
+    return k;
+}
+
+static bool rx_done_cb(rmt_channel_handle_t ch, const rmt_rx_done_event_data_t *ed, void *ctx)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < ed->num_symbols; i++) {
+        const rmt_symbol_word_t *s = &ed->received_symbols[i];
+        if (s->duration0) s_rx_runs[n++] = (tm1637_wave_run_t){ s->level0, s->duration0 };
+        if (s->duration1) s_rx_runs[n++] = (tm1637_wave_run_t){ s->level1, s->duration1 };
+    }
+    // capture is edge-triggered: it starts at the first DIO edge (start condition)
+    tm1637_report_done(tm1637_wave_nack_mask(&s_wave, s_rx_runs, n, s_wave.dio[0].dur_us));
+
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(s_idle, &woken);
+    return woken == pdTRUE;
+}
+
+esp_err_t tm1637_rmt_init(gpio_num_t dio, gpio_num_t clk)
+{
+    rmt_tx_channel_config_t tx = {
+        .gpio_num          = clk,
+        .clk_src           = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz     = RMT_RES_HZ,
+        .mem_block_symbols = RMT_MEM_SYMBOLS,
+        .trans_queue_depth = 1,
+    };
+    ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&tx, &s_clk_chan), TAG, "clk channel");
+
+    tx.gpio_num = dio;
+    tx.flags.io_od_mode   = 1;                // device pulls DIO low for ACK
+    tx.flags.io_loop_back = 1;                // ...and the RX channel watches it
+    ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&tx, &s_dio_chan), TAG, "dio channel");
+
+    rmt_rx_channel_config_t rx = {
+        .gpio_num          = dio,
+        .clk_src           = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz     = RMT_RES_HZ,
+        .mem_block_symbols = RMT_RX_SYMBOLS,
+    };
+    ESP_RETURN_ON_ERROR(rmt_new_rx_channel(&rx, &s_rx_chan), TAG, "rx channel");
+    gpio_pullup_en(dio);
+
+    rmt_rx_event_callbacks_t cbs = { .on_recv_done = rx_done_cb };
+    ESP_RETURN_ON_ERROR(rmt_rx_register_event_callbacks(s_rx_chan, &cbs, NULL), TAG, "rx cb");
+
+    rmt_copy_encoder_config_t enc = {};
+    ESP_RETURN_ON_ERROR(rmt_new_copy_encoder(&enc, &s_clk_enc), TAG, "clk encoder");
+    ESP_RETURN_ON_ERROR(rmt_new_copy_encoder(&enc, &s_dio_enc), TAG, "dio encoder");
+
+    ESP_RETURN_ON_ERROR(rmt_enable(s_clk_chan), TAG, "enable clk");
+    ESP_RETURN_ON_ERROR(rmt_enable(s_dio_chan), TAG, "enable dio");
+    ESP_RETURN_ON_ERROR(rmt_enable(s_rx_chan), TAG, "enable rx");
+
+    // CLK and DIO must start on the same tick
+    rmt_channel_handle_t chans[] = { s_clk_chan, s_dio_chan };
+    rmt_sync_manager_config_t sync = { .tx_channel_array = chans, .array_size = 2 };
+    ESP_RETURN_ON_ERROR(rmt_new_sync_manager(&sync, &s_sync), TAG, "sync manager");
+
+    s_idle = xSemaphoreCreateBinary();
+    if (!s_idle) return ESP_ERR_NO_MEM;
+    xSemaphoreGive(s_idle);
+
+    ESP_LOGI(TAG, "RMT back end ready (DIO=%d CLK=%d)", (int)dio, (int)clk);
+    return ESP_OK;
+}
+
+esp_err_t tm1637_rmt_send(const tm1637_bus_frame_t *f)
+{
+    if (!s_idle) return ESP_ERR_INVALID_STATE;
+    if (xSemaphoreTake(s_idle, pdMS_TO_TICKS(RMT_FRAME_WAIT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "previous frame still in flight");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    if (!tm1637_wave_encode(f, &s_wave)) {
+        xSemaphoreGive(s_idle);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    size_t n_clk = pack(s_wave.clk, s_wave.n_clk, s_clk_sym);
+    size_t n_dio = pack(s_wave.dio, s_wave.n_dio, s_dio_sym);
+
+    // arm capture before the bus moves; idle > any in-frame DIO level ends it
+    rmt_receive_config_t rc = { .signal_range_min_ns = 1000, .signal_range_max_ns = 1000000 };
+    esp_err_t err = rmt_receive(s_rx_chan, s_rx_sym, sizeof(s_rx_sym), &rc);
+    if (err == ESP_OK) err = rmt_sync_reset(s_sync);
+
+    rmt_transmit_config_t tc = { .loop_count = 0, .flags.eot_level = 1 };
+    if (err == ESP_OK) err = rmt_transmit(s_clk_chan, s_clk_enc, s_clk_sym, n_clk * sizeof(rmt_symbol_word_t), &tc);
+    if (err == ESP_OK) err = rmt_transmit(s_dio_chan, s_dio_enc, s_dio_sym, n_dio * sizeof(rmt_symbol_word_t), &tc);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "frame not sent: %s", esp_err_to_name(err));
+        xSemaphoreGive(s_idle);
+    }
+    return err;
+}
+
+#endif // CONFIG_TM1637_BACKEND_RMT
@@ -0,0 +1,25 @@
+#pragma once
+// Internal: RMT back end for tm1637.c (CONFIG_TM1637_BACKEND_RMT)
+
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "tm1637_wave.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// CLK/DIO on two synchronised TX channels; DIO is open-drain and looped back
+// into an RX channel so ACK slots can be checked after the fact.
+esp_err_t tm1637_rmt_init(gpio_num_t dio, gpio_num_t clk);
+
+// Queue one frame; returns once the hardware owns it (previous frame must be done)
+esp_err_t tm1637_rmt_send(const tm1637_bus_frame_t *f);
+
+// Implemented in tm1637.c; back ends call it once per frame with the NACK mask
+void tm1637_report_done(uint32_t nack_mask);
+
+#ifdef __cplusplus
+}
+#endif
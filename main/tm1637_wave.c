@@ -0,0 +1,100 @@
+#include "tm1637_wave.h"
+#include <string.h>
+
+// Encoder state: current line levels, appended as runs when time advances
+typedef struct {
+    tm1637_wave_t *w;
+    uint8_t clk, dio;
+    bool    overflow;
+} enc_t;
+
+static void push(tm1637_wave_run_t *runs, uint16_t *n, uint8_t level, uint16_t us, bool *overflow)
+{
+    if (*n > 0 && runs[*n - 1].level == level) {
+        runs[*n - 1].dur_us += us;
+        return;
+    }
+    if (*n >= TM1637_WAVE_MAX_RUNS) { *overflow = true; return; }
+    runs[*n].level  = level;
+    runs[*n].dur_us = us;
+    (*n)++;
+}
+
+static void hold(enc_t *e, uint16_t us)
+{
+    push(e->w->clk, &e->w->n_clk, e->clk, us, &e->overflow);
+    push(e->w->dio, &e->w->n_dio, e->dio, us, &e->overflow);
+    e->w->total_us += us;
+}
+
+// Same sequence as start()/stop()/write_byte() in tm1637.c
+static void enc_start(enc_t *e)
+{
+    e->dio = 1; e->clk = 1; hold(e, TM1637_T_START_US);
+    e->dio = 0;             hold(e, TM1637_T_START_US);
+    e->clk = 0;             hold(e, TM1637_T_START_US);
+}
+
+static void enc_stop(enc_t *e)
+{
+    e->clk = 0; hold(e, TM1637_T_START_US);
+    e->dio = 0; hold(e, TM1637_T_START_US);
+    e->clk = 1; hold(e, TM1637_T_START_US);
+    e->dio = 1; hold(e, TM1637_T_START_US);
+}
+
+static void enc_byte(enc_t *e, uint8_t b)
+{
+    uint8_t last = 0;
+    for (int i = 0; i < 8; i++) {
+        e->clk = 0;      hold(e, TM1637_T_BIT_US);
+        e->dio = last = (b & 0x01); hold(e, TM1637_T_BIT_US);
+        e->clk = 1;      hold(e, TM1637_T_BIT_US);
+        b >>= 1;
+    }
+    e->clk = 0; hold(e, TM1637_T_ACK_US);
+    e->dio = 1; hold(e, TM1637_T_ACK_US);            // release DIO for the ACK
+    e->clk = 1; hold(e, TM1637_T_BIT_US);
+    if (e->w->n_acks < TM1637_WAVE_MAX_ACKS) {
+        // 1 µs before CLK falls, where write_byte() samples
+        e->w->ack_at_us[e->w->n_acks++] = (uint16_t)(e->w->total_us - 1);
+    }
+    e->clk = 0; hold(e, TM1637_T_ACK_US);
+    e->dio = last;                                   // as_out() restores the last bit
+}
+
+bool tm1637_wave_encode(const tm1637_bus_frame_t *f, tm1637_wave_t *out)
+{
+    if (!f || !out || f->n_xfers == 0 || f->n_xfers > TM1637_WAVE_MAX_XFERS) return false;
+
+    memset(out, 0, sizeof(*out));
+    enc_t e = { .w = out, .clk = 1, .dio = 1, .overflow = false };
+
+    for (int x = 0; x < f->n_xfers; x++) {
+        if (f->len[x] == 0 || f->len[x] > TM1637_WAVE_MAX_BYTES) return false;
+        enc_start(&e);
+        for (int i = 0; i < f->len[x]; i++) enc_byte(&e, f->data[x][i]);
+        enc_stop(&e);
+    }
+    return !e.overflow;
+}
+
+uint32_t tm1637_wave_nack_mask(const tm1637_wave_t *w,
+                               const tm1637_wave_run_t *rx, size_t n_rx, uint32_t t0_us)
+{
+    uint32_t mask = 0;
+    size_t   r = 0;
+    uint32_t run_end = t0_us + (n_rx ? rx[0].dur_us : 0);
+
+    for (int a = 0; a < w->n_acks; a++) {
+        uint32_t t = w->ack_at_us[a];
+        while (r < n_rx && t >= run_end) {
+            r++;
+            if (r < n_rx) run_end += rx[r].dur_us;
+        }
+        // past the capture (or before it started) the line was idle-high: no ACK
+        bool low = (r < n_rx) && t >= t0_us && rx[r].level == 0;
+        if (!low) mask |= (1u << a);
+    }
+    return mask;
+}
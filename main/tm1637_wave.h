@@ -0,0 +1,58 @@
+#pragma once
+// TM1637 frame description + waveform encoder.
+// Plain C, no ESP-IDF dependencies: the RMT back end uses it on target and it
+// builds unchanged on the host.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bus timing (µs), shared with the bit-bang back end so both produce the same waveform
+#define TM1637_T_START_US   5     // each phase of start/stop
+#define TM1637_T_BIT_US     3     // each phase of a data bit
+#define TM1637_T_ACK_US     2     // CLK-low phases around the ACK slot
+
+#define TM1637_WAVE_MAX_XFERS   2     // data/display command + address/data
+#define TM1637_WAVE_MAX_BYTES   5     // address byte + 4 digits
+#define TM1637_WAVE_MAX_RUNS    160   // per line, enough for a full 2-xfer frame
+#define TM1637_WAVE_MAX_ACKS    (TM1637_WAVE_MAX_XFERS * TM1637_WAVE_MAX_BYTES)
+
+// One display update: each xfer is start + bytes (LSB first, ACK after each) + stop
+typedef struct {
+    uint8_t n_xfers;
+    uint8_t len[TM1637_WAVE_MAX_XFERS];
+    uint8_t data[TM1637_WAVE_MAX_XFERS][TM1637_WAVE_MAX_BYTES];
+} tm1637_bus_frame_t;
+
+// Constant level held for dur_us (DIO level 1 = released, open-drain)
+typedef struct {
+    uint8_t  level;
+    uint16_t dur_us;
+} tm1637_wave_run_t;
+
+typedef struct {
+    tm1637_wave_run_t clk[TM1637_WAVE_MAX_RUNS];
+    tm1637_wave_run_t dio[TM1637_WAVE_MAX_RUNS];
+    uint16_t n_clk;
+    uint16_t n_dio;
+    uint16_t ack_at_us[TM1637_WAVE_MAX_ACKS];  // DIO sample instants, µs from frame start
+    uint8_t  n_acks;
+    uint32_t total_us;
+} tm1637_wave_t;
+
+// Encode a frame into CLK/DIO run lists; false if the frame is malformed or too long
+bool tm1637_wave_encode(const tm1637_bus_frame_t *f, tm1637_wave_t *out);
+
+// Sample a captured DIO trace at the ACK instants of w.
+// rx[0] must start at frame time t0_us (e.g. the first DIO edge for an edge-triggered capture).
+// Returns a bitmask of bytes that were NOT acknowledged (bit i = i-th byte of the frame).
+uint32_t tm1637_wave_nack_mask(const tm1637_wave_t *w,
+                               const tm1637_wave_run_t *rx, size_t n_rx, uint32_t t0_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,61 @@
+#include "warm_state.h"
+#include <stddef.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_rom_crc.h"
+#include "esp_log.h"
+
+#define WARM_MAGIC  0x544B5733u             // "TKW3" (per-user array, on-site time)
+
+typedef struct {
+    uint32_t     magic;
+    uint32_t     n;
+    warm_state_t st[WARM_STATE_MAX_USERS];
+    uint32_t     crc;                        // over magic, n and st[0..n)
+} warm_block_t;
+
+static const char *TAG = "warm_state";
+
+static RTC_NOINIT_ATTR warm_block_t s_warm;
+
+static inline uint32_t block_crc(const warm_block_t *b)
+{
+    // only the used entries: the per-tick cost stays proportional to the user count
+    return esp_rom_crc32_le(0, (const uint8_t *)b, offsetof(warm_block_t, st) + b->n * sizeof(warm_state_t));
+}
+
+void warm_state_store(const warm_state_t *st, uint32_t n)
+{
+    if (n > WARM_STATE_MAX_USERS) n = WARM_STATE_MAX_USERS;
+    s_warm.magic = WARM_MAGIC;
+    s_warm.n     = n;
+    memcpy(s_warm.st, st, n * sizeof(*st));
+    s_warm.crc   = block_crc(&s_warm);
+}
+
+bool warm_state_load(warm_state_t *out, uint32_t max, uint32_t *n)
+{
+    esp_reset_reason_t why = esp_reset_reason();
+    switch (why) {
+    case ESP_RST_SW:
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+    case ESP_RST_BROWNOUT:
+    case ESP_RST_DEEPSLEEP:
+        break;
+    default:
+        // power-on / external reset: RTC memory content is undefined
+        return false;
+    }
+
+    if (s_warm.magic != WARM_MAGIC || s_warm.n > WARM_STATE_MAX_USERS || s_warm.crc != block_crc(&s_warm)) {
+        ESP_LOGW(TAG, "mirror invalid after reset reason %d", (int)why);
+        return false;
+    }
+    *n = s_warm.n < max ? s_warm.n : max;
+    memcpy(out, s_warm.st, *n * sizeof(*out));
+    return true;
+}
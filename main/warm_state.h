@@ -0,0 +1,33 @@
+#pragma once
+// Live countdown state (one entry per user) mirrored in RTC slow memory (RTC_NOINIT), CRC-protected.
+// Survives soft resets, panics, watchdogs and brownouts; updated every tick for free,
+// so flash only needs writing on state transitions and on a long interval.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t day_key;       // yyyymmdd
+    int32_t  remaining;     // seconds
+    int32_t  worked;        // seconds on site today
+    uint8_t  started;
+    uint8_t  have_mac;
+    uint8_t  mac[6];
+    uint8_t  paused;
+} warm_state_t;
+
+#define WARM_STATE_MAX_USERS 48
+
+// Overwrite the mirror with n users (no flash access); n is clamped to WARM_STATE_MAX_USERS
+void warm_state_store(const warm_state_t *st, uint32_t n);
+
+// True if the mirror is intact and the last reset kept RTC memory; out holds up to max users
+bool warm_state_load(warm_state_t *out, uint32_t max, uint32_t *n);
+
+#ifdef __cplusplus
+}
+#endif